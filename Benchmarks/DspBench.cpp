@@ -0,0 +1,2454 @@
+/*
+    dsp_bench - headless benchmark suite for the JUCE-free DSP/ headers.
+
+    Sweeps block sizes, channel counts and parameter regimes for each DSP
+    building block and reports ns/sample and samples/sec. Results are
+    printed as a table on stderr and as JSON on stdout (or --json <file>)
+    so runs can be diffed between releases.
+
+    The link mode section runs the engine on 1-16 channel buses in each
+    link mode, so the per-channel cost can be compared across bus widths.
+
+    The sub-block section runs the engine on 512-8192 sample host blocks
+    with each pipeline sub-block size (Compressor::setSubBlockSize) and
+    with whole blocks (unfused), and prints the speedup of each size.
+
+    The gain ramp section runs the engine with static input/output gains
+    and with both gains ramping in every block.
+
+    The parameter section times a full set of Compressor setter calls with
+    unchanged values (idle automation) and with every value moving, and
+    prints the coefficient recomputations per block for each.
+
+    The curve table section runs the block gain computer on the same levels
+    with the evaluated curve and with the lookup table
+    (CompressionCurve::setTableLookup), and prints the speedup and the
+    largest difference between the two.
+
+    The curve smoothing section automates the threshold with a new value
+    every block and reports, per smoothing mode, the cost of the gain
+    computer and the largest gain step between adjacent samples.
+
+    The parameter sweep section renders one signal with a group of
+    ParameterSweep::kLanesPerGroup settings, once through the engine per
+    setting and once with one setting per SIMD lane, and prints the speedup
+    (ns/sample counts every sample of every setting).
+
+    The gain envelope section analyzes one second of audio into a
+    GainEnvelope sidecar at several decimations, then times playback of the
+    sidecar against live processing by the engine, and prints the speedup,
+    the sidecar's size, the player's memory and the extra gain reduction
+    of playback (points hold the lowest gain of the intervals they join).
+
+    The peak lookahead section times PeakLookahead alone with windows of
+    0.25-30 ms at 192 kHz (up to 5760 samples), and the engine at 192 kHz
+    with 30 ms of plain and of peak lookahead, limiting short bursts. It
+    prints how far each lets the bursts overshoot the threshold.
+
+    The gain rate section runs the engine with the gain computer at every
+    sample and at control rate (every 8, 16 and 32 samples), and charts the
+    cost against the error of the gains relative to every-sample gains.
+
+    The detector section runs the engine with the level detector and with
+    the log gain detector (Compressor::setDetector), linked and
+    independent, and prints the speedup of the log gain detector. It then
+    compresses a tone burst with each and compares the envelope shapes:
+    attack and release times, ripple, and the largest difference between
+    the two gain curves.
+
+    The sidechain section runs the engine keyed from a separate sidechain
+    in each sidechain mode (Compressor::setSidechain), and prints the cost
+    relative to detecting the input itself.
+
+    The multiband section runs the engine split into 1-5 bands
+    (Compressor::setNumBands) against the same split made by stacking
+    broadband engines, each behind its own scalar band filter as a
+    crossover plugin would be, and summing their outputs. It prints each
+    one's cost relative to one band, and times the crossover alone.
+
+    The oversampling section runs the engine with the gain applied at 1, 2,
+    4 and 8 times the sample rate (Compressor::setOversampling), with and
+    without oversampled detection, and charts the cost against the aliasing
+    left on a steady 11 kHz tone limited with 0 ms attack. Every harmonic of
+    that tone is above Nyquist, so whatever else is in band is aliasing.
+
+    The silence section runs the engine on digital silence, on noise at
+    -110 dBFS and on active audio, with the silence fast path on and off,
+    and prints the speedup and the share of sub-blocks that were skipped.
+
+    The kernel section runs the full Compressor engine once per
+    specialization of its loops (knee x ratio x hold), specialized and with
+    the general loops, alternately five times, and reports the median
+    speedup and its range.
+
+    Usage:
+        dsp_bench [--json <file>] [--min-time-ms <ms>] [--filter <substring>] [--quick]
+
+    The accuracy section checks the vectorized block gain computer, evaluated
+    and table-driven, against the per-sample reference curve; the process exits non-zero if it is
+    outside CompressionCurve::kBlockGainToleranceDb. It also renders bursts
+    around a gap of silence (and of noise below the silence floor) with the
+    silence fast path on and off, and fails if the gains they apply, from
+    the resumed burst on included, differ by more than 0.01 dB.
+    Blocks with fewer and with more channels than prepared must match a
+    prepared-size render, and extra channels must come out cleared.
+*/
+
+#include "DSP/Utilities.h"
+#include "DSP/LevelEstimator.h"
+#include "DSP/CompressionCurve.h"
+#include "DSP/DelayLine.h"
+#include "DSP/Compressor.h"
+#include "DSP/CompressorSettings.h"
+#include "DSP/Crossover.h"
+#include "DSP/GainEnvelope.h"
+#include "DSP/ParameterSweep.h"
+#include "DSP/PeakLookahead.h"
+#include "DSP/SIMD.h"
+#include "DSP/SpscRing.h"
+#include "DSP/Telemetry.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//==============================================================================
+// Configuration
+
+constexpr float kSampleRate = 48000.0f;
+
+const size_t kBlockSizes[] = { 16, 64, 256, 1024, 4096 };
+const size_t kQuickBlockSizes[] = { 64, 1024 };
+const size_t kChannelCounts[] = { 1, 2, 4, 8, 16 };
+const size_t kQuickChannelCounts[] = { 2, 16 };
+const size_t kKernelChannels = 2;
+const size_t kKernelRepeats = 5;
+
+// Parameter sweep: signal length and envelope interval (10 ms)
+const size_t kSweepLength = 16384;
+const size_t kSweepEnvelopeInterval = 480;
+
+// Gain envelope: analyzed length, processing block and decimations
+const size_t kEnvelopeLength = 48000;
+const size_t kEnvelopeBlockSize = 1024;
+const size_t kEnvelopeDecimations[] = { 16, 32, 64 };
+
+// Detector envelopes: 1 kHz tone burst at 0 dBFS, then -40 dBFS
+const size_t kBurstLength = 9600;
+const size_t kBurstTailLength = 38400;
+
+// Gain rate: analyzed length and gain computer decimations (1 = every sample)
+const size_t kGainRateLength = 48000;
+const size_t kGainDecimations[] = { 1, 8, 16, 32 };
+
+// Peak lookahead: windows at 192 kHz (0.25, 2.5, 7.5 and 30 ms)
+constexpr float kPeakSampleRate = 192000.0f;
+const size_t kPeakWindows[] = { 48, 480, 1440, 5760 };
+constexpr float kPeakLookaheadMs = 30.0f;
+
+// Oversampling: gain rate factors (1 = off), and the aliasing probe, a
+// -6 dBFS tone analyzed over a second of whole cycles after a second to settle
+const size_t kOversamplingFactors[] = { 1, 2, 4, 8 };
+constexpr double kAliasingToneHz = 11000.0;
+const size_t kAliasingLength = 48000;
+
+// Fused pipeline: large host blocks, each split into sub-blocks (0 = unfused)
+const size_t kHostBlockSizes[] = { 512, 2048, 8192 };
+const size_t kSubBlockSizes[] = { 16, 32, 64, 128, 256, 0 };
+
+struct Regime
+{
+    const char* name;
+    float thresholdDb;
+    float ratio;
+    float kneeWidthDb;
+    float attackMs;
+    float releaseMs;
+    float holdMs;
+};
+
+const Regime kRegimes[] = {
+    { "hard_knee",      -20.0f, 4.0f,                               0.0f,  1.0f, 100.0f,   0.0f },
+    { "soft_knee",      -20.0f, 4.0f,                               12.0f, 1.0f, 100.0f,   0.0f },
+    { "infinite_ratio",  -6.0f, DSP::positiveInfinity<float>(),     0.0f,  0.0f,  50.0f,   0.0f },
+    { "long_hold",      -20.0f, 4.0f,                               6.0f,  1.0f, 100.0f, 500.0f },
+};
+
+const char* simdName()
+{
+#if DSP_SIMD_AVX2
+    return "avx2";
+#elif DSP_SIMD_SSE2
+    return "sse2";
+#elif DSP_SIMD_NEON
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+//==============================================================================
+// Test signal: amplitude-modulated noise that exercises attack, hold and release
+
+std::vector<float> makeSignal(size_t numSamples, uint32_t seed)
+{
+    std::vector<float> signal(numSamples);
+    uint32_t state = seed;
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        float noise = static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+        float envelope = 0.5f + 0.5f * std::sin(6.2831853f * 3.0f * static_cast<float>(i) / kSampleRate);
+        signal[i] = noise * envelope * envelope;
+    }
+
+    return signal;
+}
+
+//==============================================================================
+// Runner
+
+struct Result
+{
+    std::string name;
+    std::string regime;
+    size_t blockSize;
+    size_t channels;
+    double nsPerSample;
+    double samplesPerSec;
+};
+
+struct Options
+{
+    std::string jsonPath;
+    std::string filter;
+    double minTimeMs = 20.0;
+    bool quick = false;
+};
+
+class Runner
+{
+public:
+    explicit Runner(const Options& options) : options_(options) {}
+
+    /** Time `iteration` repeatedly until the minimum time has elapsed.
+        @param samplesPerIteration Samples (frames x channels) processed per call
+        @return The result, or nullptr if the benchmark was filtered out
+    */
+    const Result* run(const std::string& name, const std::string& regime, size_t blockSize, size_t channels,
+             size_t samplesPerIteration, const std::function<void()>& iteration)
+    {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+            return nullptr;
+
+        using Clock = std::chrono::steady_clock;
+
+        iteration();  // warm-up
+
+        size_t iterations = 0;
+        double elapsedNs = 0.0;
+        auto start = Clock::now();
+
+        do
+        {
+            for (int k = 0; k < 8; ++k)
+                iteration();
+
+            iterations += 8;
+            elapsedNs = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        } while (elapsedNs < options_.minTimeMs * 1.0e6);
+
+        double totalSamples = static_cast<double>(iterations * samplesPerIteration);
+        Result result{ name, regime, blockSize, channels,
+                       elapsedNs / totalSamples, totalSamples * 1.0e9 / elapsedNs };
+
+        std::fprintf(stderr, "%-28s %-16s block %5zu  ch %2zu  %8.3f ns/sample  %10.3g samples/s\n",
+                     name.c_str(), regime.c_str(), blockSize, channels,
+                     result.nsPerSample, result.samplesPerSec);
+
+        results_.push_back(result);
+        return &results_.back();
+    }
+
+    const std::vector<Result>& getResults() const { return results_; }
+
+private:
+    const Options& options_;
+    std::vector<Result> results_;
+};
+
+// Keeps the optimizer from discarding benchmark work
+volatile float gSink = 0.0f;
+
+//==============================================================================
+// Benchmarks
+
+void configure(const Regime& regime, DSP::LevelEstimator& estimator, DSP::CompressionCurve& curve)
+{
+    estimator.setSampleRate(kSampleRate);
+    estimator.setAttackTimeMs(regime.attackMs);
+    estimator.setReleaseTimeMs(regime.releaseMs);
+    estimator.setHoldTimeMs(regime.holdMs);
+
+    curve.setThresholdDb(regime.thresholdDb);
+    curve.setCompressionRatio(regime.ratio);
+    curve.setKneeWidthDb(regime.kneeWidthDb);
+}
+
+void benchmarkCase(Runner& runner, const Regime& regime, size_t blockSize, size_t numChannels)
+{
+    DSP::LevelEstimator estimator;
+    DSP::CompressionCurve curve;
+    configure(regime, estimator, curve);
+
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 12345u + static_cast<uint32_t>(ch));
+
+    std::vector<DSP::LevelEstimator::State> states(numChannels);
+    std::vector<float> level(blockSize), gain(blockSize), output(blockSize);
+    size_t samples = blockSize * numChannels;
+
+    // Prime the level buffer with a realistic envelope
+    estimator.estimateLevel(input[0].data(), level.data(), blockSize, states[0]);
+
+    std::vector<float> levelDb(blockSize);
+    for (size_t i = 0; i < blockSize; ++i)
+        levelDb[i] = DSP::mag2Db(level[i]);
+
+    runner.run("estimateLevel", regime.name, blockSize, numChannels, samples, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            estimator.estimateLevel(input[ch].data(), level.data(), blockSize, states[ch]);
+        gSink = gSink + level[blockSize - 1];
+    });
+
+    runner.run("estimateLevelLinked", regime.name, blockSize, numChannels, samples, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            estimator.estimateLevelLinked(input[ch].data(), level.data(), blockSize, states[ch], ch > 0);
+        gSink = gSink + level[blockSize - 1];
+    });
+
+    // All channels at once, one SIMD lane per channel
+    std::vector<std::vector<float>> levels(numChannels, std::vector<float>(blockSize));
+    std::vector<const float*> inputPointers(numChannels);
+    std::vector<float*> levelPointers(numChannels);
+    std::vector<DSP::LevelEstimator::State*> statePointers(numChannels);
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        inputPointers[ch] = input[ch].data();
+        levelPointers[ch] = levels[ch].data();
+        statePointers[ch] = &states[ch];
+    }
+
+    runner.run("estimateLevelMultichannel", regime.name, blockSize, numChannels, samples, [&] {
+        if (estimator.getHoldTimeSamples() > 0)
+            estimator.estimateLevelMultichannel<true>(inputPointers.data(), levelPointers.data(),
+                                                      statePointers.data(), numChannels, blockSize);
+        else
+            estimator.estimateLevelMultichannel<false>(inputPointers.data(), levelPointers.data(),
+                                                       statePointers.data(), numChannels, blockSize);
+        gSink = gSink + levels[numChannels - 1][blockSize - 1];
+    });
+
+    runner.run("calculateCompressionGainDb", regime.name, blockSize, numChannels, samples, [&] {
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t i = 0; i < blockSize; ++i)
+                sum += curve.calculateCompressionGainDb(levelDb[i]);
+        gSink = gSink + sum;
+    });
+
+    runner.run("computeGainReference", regime.name, blockSize, numChannels, samples, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            gSink = gSink + curve.computeGainReference(level.data(), gain.data(), blockSize);
+    });
+
+    runner.run("computeGain", regime.name, blockSize, numChannels, samples, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            gSink = gSink + curve.computeGain(level.data(), gain.data(), blockSize);
+    });
+
+    runner.run("applyCompression", regime.name, blockSize, numChannels, samples, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            curve.applyCompression(input[ch].data(), level.data(), output.data(), blockSize);
+        gSink = gSink + output[blockSize - 1];
+    });
+}
+
+void benchmarkDelayLine(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    // Full 30 ms lookahead at 192 kHz
+    constexpr size_t kMaxDelay = 5760;
+
+    std::vector<DSP::DelayLine> delays(numChannels);
+    for (auto& delay : delays)
+    {
+        delay.prepare(kMaxDelay, blockSize);
+        delay.setDelay(kMaxDelay);
+    }
+
+    std::vector<float> input = makeSignal(blockSize, 777u);
+    std::vector<float> output(blockSize);
+
+    runner.run("DelayLine::process", "lookahead_max", blockSize, numChannels, blockSize * numChannels, [&] {
+        for (auto& delay : delays)
+            delay.process(input.data(), output.data(), blockSize);
+        gSink = gSink + output[blockSize - 1];
+    });
+
+    runner.run("DelayLine::processSample", "lookahead_max", blockSize, numChannels, blockSize * numChannels, [&] {
+        for (auto& delay : delays)
+            for (size_t i = 0; i < blockSize; ++i)
+                output[i] = delay.processSample(input[i]);
+        gSink = gSink + output[blockSize - 1];
+    });
+
+    // Baseline: a plain copy of the same amount of data
+    runner.run("memcpy", "baseline", blockSize, numChannels, blockSize * numChannels, [&] {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            std::memcpy(output.data(), input.data(), blockSize * sizeof(float));
+        gSink = gSink + output[blockSize - 1];
+    });
+}
+
+//==============================================================================
+// Kernels: specialized vs. general Compressor loops per configuration
+
+struct KernelResult
+{
+    std::string config;
+    size_t blockSize;
+    size_t channels;
+    double generalNsPerSample;      // Median over the repeats
+    double specializedNsPerSample;  // Median over the repeats
+    double minSpeedup;
+    double medianSpeedup;
+    double maxSpeedup;
+};
+
+std::string kernelConfigName(unsigned flags)
+{
+    using C = DSP::Compressor;
+
+    std::string name = (flags & C::kSoftKnee) != 0 ? "soft_knee" : "hard_knee";
+    name += (flags & C::kInfiniteRatio) != 0 ? "/infinite_ratio" : "/finite_ratio";
+    name += (flags & C::kHold) != 0 ? "/hold" : "/no_hold";
+    return name;
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 != 0 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+}
+
+/** Each specialization of the loops against the general ones, linked and
+    without lookahead. The two are timed alternately kKernelRepeats times, so that
+    drift and noise show up as the spread of the speedup. */
+void benchmarkKernels(Runner& runner, size_t blockSize, size_t numChannels, std::vector<KernelResult>& kernels)
+{
+    using C = DSP::Compressor;
+
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 4242u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    for (unsigned flags = 0; flags <= C::kSpecializedFlags; ++flags)
+    {
+        std::string config = kernelConfigName(flags);
+        C compressors[2];
+
+        for (int specialized = 0; specialized < 2; ++specialized)
+        {
+            C& compressor = compressors[specialized];
+            compressor.setKernelSpecialization(specialized != 0);
+            compressor.prepare(kSampleRate, blockSize, numChannels, 30.0f);
+            compressor.setLinkMode(C::LinkMode::all);
+            compressor.setThresholdDb(-20.0f);
+            compressor.setRatio((flags & C::kInfiniteRatio) != 0 ? DSP::positiveInfinity<float>() : 4.0f);
+            compressor.setKneeWidthDb((flags & C::kSoftKnee) != 0 ? 6.0f : 0.0f);
+            compressor.setAttackTimeMs(1.0f);
+            compressor.setReleaseTimeMs(100.0f);
+            compressor.setHoldTimeMs((flags & C::kHold) != 0 ? 20.0f : 0.0f);
+            compressor.setLookaheadMs(0.0f);
+            compressor.reset();
+        }
+
+        std::vector<double> nsPerSample[2];
+        std::vector<double> speedups;
+
+        for (size_t repeat = 0; repeat < kKernelRepeats; ++repeat)
+        {
+            double ns[2] = { 0.0, 0.0 };
+
+            // Alternate which one goes first
+            for (int k = 0; k < 2; ++k)
+            {
+                int specialized = (k + static_cast<int>(repeat)) % 2;
+                C& compressor = compressors[specialized];
+                const char* name = specialized != 0 ? "Compressor::process" : "Compressor::process(general)";
+
+                const Result* result = runner.run(name, config, blockSize, numChannels, blockSize * numChannels, [&] {
+                    for (size_t ch = 0; ch < numChannels; ++ch)
+                        std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+                    compressor.process(channels.data(), numChannels, blockSize);
+                    gSink = gSink + buffer[0][blockSize - 1];
+                });
+
+                if (result != nullptr)
+                    ns[specialized] = result->nsPerSample;
+            }
+
+            if (ns[0] <= 0.0 || ns[1] <= 0.0)
+                break;
+
+            nsPerSample[0].push_back(ns[0]);
+            nsPerSample[1].push_back(ns[1]);
+            speedups.push_back(ns[0] / ns[1]);
+        }
+
+        if (speedups.empty())
+            continue;
+
+        kernels.push_back({ config, blockSize, numChannels, median(nsPerSample[0]), median(nsPerSample[1]),
+                            *std::min_element(speedups.begin(), speedups.end()), median(speedups),
+                            *std::max_element(speedups.begin(), speedups.end()) });
+    }
+}
+
+//==============================================================================
+// Link modes: full engine on multichannel buses
+
+void benchmarkLinkModes(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    using C = DSP::Compressor;
+
+    struct Mode
+    {
+        const char* name;
+        C::LinkMode mode;
+    };
+
+    const Mode modes[] = {
+        { "independent", C::LinkMode::independent },
+        { "all", C::LinkMode::all },
+        { "groups", C::LinkMode::groups },
+        { "w_channel", C::LinkMode::wChannel },
+    };
+
+    std::vector<std::vector<float>> input(numChannels);
+    std::vector<int> groups(numChannels);
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        input[ch] = makeSignal(blockSize, 999u + static_cast<uint32_t>(ch));
+
+        // Ambisonic orders: channel n is in order floor(sqrt(n))
+        groups[ch] = static_cast<int>(std::sqrt(static_cast<float>(ch)));
+    }
+
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    for (const auto& mode : modes)
+    {
+        C compressor;
+        compressor.prepare(kSampleRate, blockSize, numChannels, 30.0f);
+        compressor.setChannelGroups(groups);
+        compressor.setLinkMode(mode.mode);
+        compressor.setThresholdDb(-20.0f);
+        compressor.setRatio(4.0f);
+        compressor.setKneeWidthDb(6.0f);
+        compressor.setAttackTimeMs(1.0f);
+        compressor.setReleaseTimeMs(100.0f);
+        compressor.reset();
+
+        runner.run("Compressor::linkMode", mode.name, blockSize, numChannels, blockSize * numChannels, [&] {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+            compressor.process(channels.data(), numChannels, blockSize);
+            gSink = gSink + buffer[0][blockSize - 1];
+        });
+    }
+}
+
+//==============================================================================
+// Fused pipeline: full engine (with metering) on large host blocks, per
+// sub-block size
+
+void benchmarkSubBlocks(Runner& runner, size_t hostBlockSize, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(hostBlockSize, 777u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    double unfusedNs = 0.0;
+
+    // Unfused first, as the reference for the speedups
+    for (size_t k = std::size(kSubBlockSizes); k-- > 0;)
+    {
+        size_t subBlockSize = kSubBlockSizes[k];
+
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, hostBlockSize, numChannels, 30.0f);
+        compressor.setSubBlockSize(subBlockSize);
+        compressor.setThresholdDb(-20.0f);
+        compressor.setRatio(4.0f);
+        compressor.setKneeWidthDb(6.0f);
+        compressor.setLookaheadMs(5.0f);
+        compressor.reset();
+
+        DSP::TelemetryCollector telemetry;
+        DSP::SpscRing<DSP::TelemetryFrame> ring(1024);
+        telemetry.prepare(static_cast<size_t>(kSampleRate / 1000.0f), hostBlockSize);
+
+        std::string regime = subBlockSize > 0 ? "sub_block_" + std::to_string(subBlockSize) : "unfused";
+
+        const Result* result = runner.run("Compressor::subBlock", regime, hostBlockSize, numChannels,
+                                          hostBlockSize * numChannels, [&] {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), input[ch].data(), hostBlockSize * sizeof(float));
+
+            compressor.process(channels.data(), numChannels, hostBlockSize, &telemetry, &ring);
+
+            DSP::TelemetryFrame frame;
+            while (ring.pop(frame))
+                gSink = gSink + frame.outputPeak;
+        });
+
+        if (result == nullptr)
+            return;
+
+        if (subBlockSize == 0)
+            unfusedNs = result->nsPerSample;
+        else
+            std::fprintf(stderr, "  speedup over unfused: %.2fx\n", unfusedNs / result->nsPerSample);
+    }
+}
+
+//==============================================================================
+// Gain ramps: full engine with static input/output gains and with both
+// gains ramping in every block
+
+void benchmarkGainRamps(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 555u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    for (bool automated : { false, true })
+    {
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, blockSize, numChannels, 30.0f);
+        compressor.setThresholdDb(-20.0f);
+        compressor.setRatio(4.0f);
+        compressor.reset();
+
+        int step = 0;
+
+        runner.run("Compressor::gainRamp", automated ? "automated" : "static", blockSize, numChannels,
+                   blockSize * numChannels, [&] {
+                       // A new target every block keeps both 20 ms ramps moving
+                       if (automated)
+                       {
+                           float gainDb = static_cast<float>(step++ % 2);
+                           compressor.setInputGainDb(gainDb);
+                           compressor.setOutputGainDb(-gainDb);
+                       }
+
+                       for (size_t ch = 0; ch < numChannels; ++ch)
+                           std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+                       compressor.process(channels.data(), numChannels, blockSize);
+                       gSink = gSink + buffer[0][blockSize - 1];
+                   });
+    }
+}
+
+//==============================================================================
+// Silence: full engine on idle and active input, with the silence fast path
+// on and off
+
+void benchmarkSilence(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    struct Input
+    {
+        const char* name;
+        float gain;
+    };
+
+    const Input inputs[] = { { "silence", 0.0f }, { "noise_floor", DSP::db2Mag(-110.0f) }, { "active", 1.0f } };
+
+    std::vector<std::vector<float>> buffer(numChannels, std::vector<float>(blockSize));
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    for (const auto& input : inputs)
+    {
+        std::vector<std::vector<float>> signal(numChannels);
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            signal[ch] = makeSignal(blockSize, 666u + static_cast<uint32_t>(ch));
+
+            for (auto& x : signal[ch])
+                x *= input.gain;
+        }
+
+        double fullNs = 0.0;
+
+        for (bool skip : { false, true })
+        {
+            DSP::CompressorSettings settings;
+            settings.thresholdDb = -20.0f;
+            settings.ratio = 4.0f;
+            settings.lookaheadTimeMs = 5.0f;
+
+            DSP::Compressor compressor;
+            compressor.prepare(kSampleRate, blockSize, numChannels, 30.0f);
+            settings.applyTo(compressor);
+            compressor.setSilenceFloorDb(skip ? DSP::Compressor::kDefaultSilenceFloorDb
+                                              : DSP::negativeInfinity<float>());
+            compressor.reset();
+
+            size_t blocks = 0;
+            size_t skippedBefore = compressor.getNumSkippedBlocks();
+
+            const Result* result = runner.run("Compressor::silence", std::string(input.name) + (skip ? "_skip" : "_full"),
+                                              blockSize, numChannels, blockSize * numChannels, [&] {
+                for (size_t ch = 0; ch < numChannels; ++ch)
+                    std::memcpy(buffer[ch].data(), signal[ch].data(), blockSize * sizeof(float));
+
+                compressor.process(channels.data(), numChannels, blockSize);
+                gSink = gSink + buffer[0][blockSize - 1];
+                ++blocks;
+            });
+
+            if (result == nullptr)
+                continue;
+
+            if (!skip)
+            {
+                fullNs = result->nsPerSample;
+                continue;
+            }
+
+            size_t subBlocks = blocks * ((blockSize + compressor.getSubBlockSize() - 1) / compressor.getSubBlockSize());
+            size_t skipped = compressor.getNumSkippedBlocks() - skippedBefore;
+
+            std::fprintf(stderr, "  skipped %.1f%% of sub-blocks", 100.0 * static_cast<double>(skipped)
+                                                                       / static_cast<double>(std::max<size_t>(subBlocks, 1)));
+
+            if (fullNs > 0.0)
+                std::fprintf(stderr, ", speedup %.2fx", fullNs / result->nsPerSample);
+
+            std::fprintf(stderr, "\n");
+        }
+    }
+}
+
+//==============================================================================
+// Parameter updates: cost of a full set of setter calls per block, with
+// unchanged values (idle automation) and with every value moving
+
+void applySettings(DSP::Compressor& compressor, float offset)
+{
+    compressor.setAttackTimeMs(1.0f + offset);
+    compressor.setReleaseTimeMs(100.0f + offset);
+    compressor.setHoldTimeMs(offset);
+    compressor.setThresholdDb(-20.0f + offset);
+    compressor.setRatio(4.0f + offset);
+    compressor.setKneeWidthDb(6.0f + offset);
+    compressor.setFixedLatency(false);
+    compressor.setLookaheadMs(5.0f + offset);
+    compressor.setInputGainDb(offset);
+    compressor.setOutputGainDb(offset);
+}
+
+void benchmarkParameterUpdates(Runner& runner, size_t blockSize)
+{
+    DSP::Compressor compressor;
+    compressor.prepare(kSampleRate, blockSize, 2, 30.0f);
+    applySettings(compressor, 0.0f);
+
+    size_t updatesBefore = compressor.getNumCoefficientUpdates();
+    size_t calls = 0;
+
+    if (runner.run("Compressor::setParameters", "idle", blockSize, 1, blockSize, [&] {
+            applySettings(compressor, 0.0f);
+            ++calls;
+        }) != nullptr)
+    {
+        std::fprintf(stderr, "  coefficient updates per block (idle): %.3g\n",
+                     static_cast<double>(compressor.getNumCoefficientUpdates() - updatesBefore)
+                         / static_cast<double>(calls));
+    }
+
+    updatesBefore = compressor.getNumCoefficientUpdates();
+    calls = 0;
+    float offset = 0.0f;
+
+    if (runner.run("Compressor::setParameters", "automated", blockSize, 1, blockSize, [&] {
+            offset = offset < 1.0f ? offset + 0.001f : 0.0f;
+            applySettings(compressor, offset);
+            ++calls;
+        }) != nullptr)
+    {
+        std::fprintf(stderr, "  coefficient updates per block (automated): %.3g\n",
+                     static_cast<double>(compressor.getNumCoefficientUpdates() - updatesBefore)
+                         / static_cast<double>(calls));
+    }
+}
+
+//==============================================================================
+// Parameter sweep: one group of settings through the engine one at a time,
+// and in SIMD lanes
+
+void benchmarkParameterSweep(Runner& runner, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    std::vector<const float*> inputs(numChannels);
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        input[ch] = makeSignal(kSweepLength, 333u + static_cast<uint32_t>(ch));
+        inputs[ch] = input[ch].data();
+    }
+
+    // A spread of settings, as a preset grid would have
+    DSP::CompressorSettings base;
+    base.lookaheadTimeMs = 2.0f;
+
+    std::vector<DSP::CompressorSettings> settings(DSP::ParameterSweep::kLanesPerGroup, base);
+
+    for (size_t k = 0; k < settings.size(); ++k)
+    {
+        settings[k].thresholdDb = -40.0f + 2.0f * static_cast<float>(k);
+        settings[k].ratio = 2.0f + static_cast<float>(k % 4);
+        settings[k].kneeWidthDb = 6.0f * static_cast<float>(k % 2);
+        settings[k].attackTimeMs = static_cast<float>(k % 3);
+        settings[k].releaseTimeMs = 50.0f + 25.0f * static_cast<float>(k % 5);
+    }
+
+    size_t samplesPerIteration = kSweepLength * numChannels * settings.size();
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    DSP::Compressor compressor;
+    compressor.prepare(kSampleRate, kSweepLength, numChannels, 30.0f);
+
+    const Result* scalar = runner.run("ParameterSweep", "per_setting", kSweepLength, numChannels,
+                                      samplesPerIteration, [&] {
+        for (const auto& setting : settings)
+        {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), input[ch].data(), kSweepLength * sizeof(float));
+
+            setting.applyTo(compressor);
+            compressor.reset();
+            compressor.process(channels.data(), numChannels, kSweepLength);
+            gSink = gSink + buffer[0][kSweepLength - 1];
+        }
+    });
+
+    if (scalar == nullptr)
+        return;
+
+    base.applyTo(compressor);
+    compressor.reset();
+
+    DSP::ParameterSweep sweep;
+    sweep.prepare(compressor, kSampleRate, kSweepEnvelopeInterval);
+    std::vector<DSP::ParameterSweep::Summary> summaries(settings.size());
+
+    const Result* lanes = runner.run("ParameterSweep", "lanes", kSweepLength, numChannels, samplesPerIteration, [&] {
+        sweep.process(inputs.data(), kSweepLength, settings.data(), settings.size(), summaries.data());
+        gSink = gSink + summaries[0].outputPeak;
+    });
+
+    if (lanes != nullptr)
+        std::fprintf(stderr, "  %zu settings in lanes: %.2fx faster than one at a time\n", settings.size(),
+                     scalar->nsPerSample / lanes->nsPerSample);
+}
+
+//==============================================================================
+// Gain envelope: playback of a precomputed sidecar against live processing
+
+void benchmarkGainEnvelope(Runner& runner, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(kEnvelopeLength, 777u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer = input;
+    std::vector<float*> channels(numChannels);
+
+    DSP::CompressorSettings settings;
+    settings.thresholdDb = -24.0f;
+    settings.ratio = 4.0f;
+    settings.kneeWidthDb = 6.0f;
+    settings.attackTimeMs = 1.0f;
+    settings.outputGainDb = 6.0f;
+
+    auto configure = [&](DSP::Compressor& compressor) {
+        compressor.prepare(kSampleRate, kEnvelopeBlockSize, numChannels, 30.0f);
+        settings.applyTo(compressor);
+        compressor.reset();
+    };
+
+    auto processBlocks = [&](const std::function<void(float* const*, size_t, size_t)>& process) {
+        for (size_t offset = 0; offset < kEnvelopeLength; offset += kEnvelopeBlockSize)
+        {
+            size_t numSamples = std::min(kEnvelopeBlockSize, kEnvelopeLength - offset);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                std::memcpy(buffer[ch].data() + offset, input[ch].data() + offset, numSamples * sizeof(float));
+                channels[ch] = buffer[ch].data() + offset;
+            }
+
+            process(channels.data(), offset, numSamples);
+        }
+    };
+
+    DSP::Compressor compressor;
+    configure(compressor);
+
+    const Result* live = runner.run("GainEnvelope", "live", kEnvelopeBlockSize, numChannels,
+                                    kEnvelopeLength * numChannels, [&] {
+        processBlocks([&](float* const* data, size_t, size_t numSamples) {
+            compressor.process(data, numChannels, numSamples);
+        });
+        gSink = gSink + buffer[0][kEnvelopeLength - 1];
+    });
+
+    if (live == nullptr)
+        return;
+
+    // Analysis: the engine's gain of every group, from a reset engine (no lookahead, so no latency)
+    configure(compressor);
+
+    const auto& routing = compressor.getRouting();
+    size_t numTracks = routing.groups.size();
+    std::vector<uint16_t> channelTracks(numChannels, 0);
+
+    for (size_t g = 0; g < numTracks; ++g)
+        for (size_t m = 0; m < routing.groups[g].numMembers; ++m)
+            channelTracks[routing.members[routing.groups[g].firstMember + m]] = static_cast<uint16_t>(g);
+
+    std::vector<std::vector<float>> gains(numTracks, std::vector<float>(kEnvelopeLength));
+    std::vector<float*> gainOutputs(numTracks);
+    std::vector<const float*> trackGains(numTracks);
+
+    processBlocks([&](float* const* data, size_t offset, size_t numSamples) {
+        for (size_t t = 0; t < numTracks; ++t)
+            gainOutputs[t] = gains[t].data() + offset;
+
+        compressor.setGainOutputs(gainOutputs.data());
+        compressor.process(data, numChannels, numSamples);
+    });
+
+    const float fixedGain = compressor.getInputGain() * compressor.getOutputGain();
+
+    for (size_t t = 0; t < numTracks; ++t)
+        trackGains[t] = gains[t].data();
+
+    for (size_t decimation : kEnvelopeDecimations)
+    {
+        DSP::GainEnvelopeWriter writer;
+        writer.prepare(static_cast<uint32_t>(kSampleRate), channelTracks, numTracks, fixedGain, decimation);
+        writer.addGains(trackGains.data(), kEnvelopeLength);
+        auto file = writer.finish();
+
+        DSP::GainEnvelopePlayer player;
+        player.open(file.data(), file.size());
+
+        // Extra reduction of playback: dry samples against the live gain
+        float maxExtraDb = 0.0f;
+        double sumExtraDb = 0.0;
+        size_t numCompared = 0;
+
+        processBlocks([&](float* const* data, size_t, size_t numSamples) {
+            player.process(data, numChannels, numSamples);
+        });
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t i = 0; i < kEnvelopeLength; ++i)
+                if (std::fabs(input[ch][i]) > 1.0e-3f)
+                {
+                    float liveGain = gains[channelTracks[ch]][i] * fixedGain;
+                    float extraDb = DSP::mag2Db(liveGain * input[ch][i] / buffer[ch][i]);
+                    maxExtraDb = std::max(maxExtraDb, extraDb);
+                    sumExtraDb += extraDb;
+                    ++numCompared;
+                }
+
+        const Result* playback = runner.run("GainEnvelope", "playback_d" + std::to_string(decimation),
+                                            kEnvelopeBlockSize, numChannels, kEnvelopeLength * numChannels, [&] {
+            player.seek(0);
+            processBlocks([&](float* const* data, size_t, size_t numSamples) {
+                player.process(data, numChannels, numSamples);
+            });
+            gSink = gSink + buffer[0][kEnvelopeLength - 1];
+        });
+
+        if (playback != nullptr)
+            std::fprintf(stderr, "  %.2fx faster than live, %.0f bytes/s per track, player %zu bytes, "
+                                 "extra reduction %.2f dB max, %.3f dB mean\n",
+                         live->nsPerSample / playback->nsPerSample,
+                         static_cast<double>(file.size()) * kSampleRate / static_cast<double>(kEnvelopeLength * numTracks),
+                         player.getMemoryBytes(), maxExtraDb,
+                         numCompared > 0 ? sumExtraDb / static_cast<double>(numCompared) : 0.0);
+    }
+}
+
+//==============================================================================
+// Peak lookahead: cost of the window at each length, and the engine limiting
+// short bursts with plain and with peak lookahead
+
+void benchmarkPeakLookahead(Runner& runner, size_t blockSize)
+{
+    // Gains with a dip every few hundred samples
+    std::vector<float> input = makeSignal(blockSize, 888u);
+    for (auto& x : input)
+        x = 1.0f - 0.5f * x * x;
+
+    std::vector<float> buffer(blockSize);
+
+    for (size_t window : kPeakWindows)
+    {
+        DSP::PeakLookahead peakLookahead;
+        peakLookahead.prepare(window);
+        peakLookahead.setLookahead(window);
+
+        runner.run("PeakLookahead", "window_" + std::to_string(window), blockSize, 1, blockSize, [&] {
+            std::memcpy(buffer.data(), input.data(), blockSize * sizeof(float));
+            peakLookahead.process(buffer.data(), blockSize);
+            gSink = gSink + buffer[blockSize - 1];
+        });
+    }
+
+    // 1 ms full scale bursts every 50 ms, brick wall limited at -12 dB
+    constexpr size_t kNumChannels = 2;
+    const size_t burstLength = static_cast<size_t>(kPeakSampleRate / 1000.0f);
+    const size_t burstPeriod = 50 * burstLength;
+    const size_t signalLength = 8 * burstPeriod;
+
+    std::vector<float> bursts = makeSignal(signalLength, 999u);
+    for (size_t i = 0; i < signalLength; ++i)
+        bursts[i] = i % burstPeriod < burstLength ? (bursts[i] < 0.0f ? -1.0f : 1.0f) : 0.0f;
+
+    DSP::CompressorSettings settings;
+    settings.thresholdDb = -12.0f;
+    settings.ratio = DSP::positiveInfinity<float>();
+    settings.releaseTimeMs = 50.0f;
+    settings.lookaheadTimeMs = kPeakLookaheadMs;
+
+    std::vector<std::vector<float>> audio(kNumChannels, std::vector<float>(blockSize));
+    std::vector<float*> channels(kNumChannels);
+    for (size_t ch = 0; ch < kNumChannels; ++ch)
+        channels[ch] = audio[ch].data();
+
+    for (bool peak : { false, true })
+    {
+        settings.peakLookahead = peak;
+
+        DSP::Compressor compressor;
+        compressor.prepare(kPeakSampleRate, blockSize, kNumChannels, kPeakLookaheadMs);
+        settings.applyTo(compressor);
+        compressor.reset();
+
+        size_t position = 0;
+
+        const Result* result = runner.run("Compressor::peakLookahead", peak ? "peak" : "delay", blockSize,
+                                          kNumChannels, blockSize * kNumChannels, [&] {
+            for (size_t ch = 0; ch < kNumChannels; ++ch)
+                for (size_t i = 0; i < blockSize; ++i)
+                    audio[ch][i] = bursts[(position + i) % signalLength];
+
+            position = (position + blockSize) % signalLength;
+            compressor.process(channels.data(), kNumChannels, blockSize);
+            gSink = gSink + audio[0][blockSize - 1];
+        });
+
+        if (result == nullptr)
+            continue;
+
+        // The largest output over the whole signal, after the engine has settled
+        float outputPeak = 0.0f;
+
+        for (size_t start = 0; start < 2 * signalLength; start += blockSize)
+        {
+            for (size_t ch = 0; ch < kNumChannels; ++ch)
+                for (size_t i = 0; i < blockSize; ++i)
+                    audio[ch][i] = bursts[(start + i) % signalLength];
+
+            compressor.process(channels.data(), kNumChannels, blockSize);
+
+            for (size_t i = 0; i < blockSize; ++i)
+                outputPeak = std::max(outputPeak, std::fabs(audio[0][i]));
+        }
+
+        std::fprintf(stderr, "  %s lookahead: bursts %.2f dB over the threshold\n", peak ? "peak" : "plain",
+                     DSP::mag2Db(outputPeak) - settings.thresholdDb);
+    }
+}
+
+//==============================================================================
+// Detector: cost of the level and log gain detectors, and their envelope
+// shapes on a tone burst
+
+DSP::CompressorSettings makeDetectorSettings(int detector, bool linked)
+{
+    DSP::CompressorSettings settings;
+    settings.detector = detector;
+    settings.linked = linked;
+    settings.thresholdDb = -20.0f;
+    settings.ratio = 4.0f;
+    settings.kneeWidthDb = 6.0f;
+    settings.attackTimeMs = 5.0f;
+    settings.releaseTimeMs = 100.0f;
+    return settings;
+}
+
+/** @return True unless every run was filtered out */
+bool benchmarkDetector(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 3131u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer(input);
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    bool ran = false;
+
+    for (bool linked : { true, false })
+    {
+        double levelNs = 0.0;
+
+        for (int detector : { 0, 1 })
+        {
+            DSP::Compressor compressor;
+            compressor.prepare(kSampleRate, blockSize, numChannels, 0.0f);
+            makeDetectorSettings(detector, linked).applyTo(compressor);
+            compressor.reset();
+
+            std::string regime = std::string(detector == 0 ? "level" : "log_gain") + (linked ? "_linked" : "");
+
+            const Result* result = runner.run("Compressor::detector", regime, blockSize, numChannels,
+                                              blockSize * numChannels, [&] {
+                for (size_t ch = 0; ch < numChannels; ++ch)
+                    std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+                compressor.process(channels.data(), numChannels, blockSize);
+                gSink = gSink + buffer[0][0];
+            });
+
+            if (result == nullptr)
+                continue;
+
+            ran = true;
+
+            if (detector == 0)
+                levelNs = result->nsPerSample;
+            else if (levelNs > 0.0)
+                std::fprintf(stderr, "  log gain speedup %.2fx\n", levelNs / result->nsPerSample);
+        }
+    }
+
+    return ran;
+}
+
+//==============================================================================
+// Sidechain: cost of keying the detectors from separate sidechain buffers
+
+void benchmarkSidechain(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels), key(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        input[ch] = makeSignal(blockSize, 4242u + static_cast<uint32_t>(ch));
+        key[ch] = makeSignal(blockSize, 5353u + static_cast<uint32_t>(ch));
+    }
+
+    std::vector<std::vector<float>> buffer(input);
+    std::vector<float*> channels(numChannels);
+    std::vector<const float*> keys(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        channels[ch] = buffer[ch].data();
+        keys[ch] = key[ch].data();
+    }
+
+    static const char* const regimes[] = { "off", "mono", "per_channel", "linked_sum" };
+    double offNs = 0.0;
+
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        DSP::CompressorSettings settings = makeDetectorSettings(0, true);
+        settings.sidechain = mode;
+
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, blockSize, numChannels, 0.0f);
+        settings.applyTo(compressor);
+        compressor.setSidechainInputs(keys.data(), numChannels);
+        compressor.reset();
+
+        const Result* result = runner.run("Compressor::sidechain", regimes[mode], blockSize, numChannels,
+                                          blockSize * numChannels, [&] {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+            compressor.process(channels.data(), numChannels, blockSize);
+            gSink = gSink + buffer[0][0];
+        });
+
+        if (result == nullptr)
+            continue;
+
+        if (mode == 0)
+            offNs = result->nsPerSample;
+        else if (offNs > 0.0)
+            std::fprintf(stderr, "  relative to off %.2fx\n", result->nsPerSample / offNs);
+    }
+}
+
+enum class BandResponse
+{
+    lowPass,
+    highPass,
+    allPass
+};
+
+/** Butterworth biquad { b0, b1, b2, a1, a2 }, designed as in DSP::Crossover. */
+std::array<float, 5> makeButterworth(double frequencyHz, BandResponse response)
+{
+    const double k = std::tan(3.14159265358979323846 * frequencyHz / kSampleRate);
+    const double norm = 1.0 / (1.0 + std::sqrt(2.0) * k + k * k);
+    const double a1 = 2.0 * (k * k - 1.0) * norm;
+    const double a2 = (1.0 - std::sqrt(2.0) * k + k * k) * norm;
+
+    double b0 = a2, b1 = a1, b2 = 1.0;
+
+    if (response == BandResponse::lowPass)
+    {
+        b0 = k * k * norm;
+        b1 = 2.0 * b0;
+        b2 = b0;
+    }
+    else if (response == BandResponse::highPass)
+    {
+        b0 = norm;
+        b1 = -2.0 * norm;
+        b2 = norm;
+    }
+
+    return { { static_cast<float>(b0), static_cast<float>(b1), static_cast<float>(b2), static_cast<float>(a1),
+               static_cast<float>(a2) } };
+}
+
+/** One instance of a stacked multiband setup: the band's filter (low, high
+    and all passes, one channel at a time) in front of a broadband engine. */
+struct ChainedBand
+{
+    std::vector<std::array<float, 5>> stages;
+    std::vector<float> states;  // Two per stage and channel
+    DSP::Compressor compressor;
+    std::vector<std::vector<float>> buffer;
+    std::vector<float*> channels;
+
+    void prepare(size_t band, size_t numBands, size_t blockSize, size_t numChannels,
+                 const DSP::CompressorSettings& settings)
+    {
+        const double crossovers[] = { 150.0, 800.0, 3000.0, 8000.0 };
+
+        for (size_t j = 0; j + 1 < numBands; ++j)
+        {
+            if (j > band)
+            {
+                stages.push_back(makeButterworth(crossovers[j], BandResponse::allPass));
+            }
+            else
+            {
+                stages.push_back(makeButterworth(crossovers[j], j == band ? BandResponse::lowPass : BandResponse::highPass));
+                stages.push_back(stages.back());
+            }
+        }
+
+        states.assign(2 * stages.size() * numChannels, 0.0f);
+        buffer.assign(numChannels, std::vector<float>(blockSize, 0.0f));
+        channels.resize(numChannels);
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            channels[ch] = buffer[ch].data();
+
+        compressor.prepare(kSampleRate, blockSize, numChannels, 0.0f);
+        settings.applyTo(compressor);
+        compressor.reset();
+    }
+
+    void process(const std::vector<std::vector<float>>& input, size_t numSamples)
+    {
+        for (size_t ch = 0; ch < channels.size(); ++ch)
+        {
+            float* data = channels[ch];
+            std::memcpy(data, input[ch].data(), numSamples * sizeof(float));
+
+            for (size_t k = 0; k < stages.size(); ++k)
+            {
+                const auto& c = stages[k];
+                float* s = states.data() + 2 * (ch * stages.size() + k);
+                float s1 = s[0], s2 = s[1];
+
+                for (size_t i = 0; i < numSamples; ++i)
+                {
+                    float x = data[i];
+                    float y = c[0] * x + s1;
+                    s1 = c[1] * x - c[3] * y + s2;
+                    s2 = c[2] * x - c[4] * y;
+                    data[i] = y;
+                }
+
+                s[0] = s1;
+                s[1] = s2;
+            }
+        }
+
+        compressor.process(channels.data(), channels.size(), numSamples);
+    }
+};
+
+void benchmarkMultiband(Runner& runner, size_t blockSize, size_t numChannels)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 6464u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer(input);
+    std::vector<float*> channels(numChannels);
+    std::vector<const float*> inputs(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        channels[ch] = buffer[ch].data();
+        inputs[ch] = input[ch].data();
+    }
+
+    double engineNs = 0.0, chainedNs = 0.0;
+
+    for (size_t numBands = 1; numBands <= DSP::Crossover::kMaxBands; ++numBands)
+    {
+        DSP::CompressorSettings settings = makeDetectorSettings(0, true);
+        settings.bands = static_cast<int>(numBands) - 1;
+        std::string suffix = std::to_string(numBands);
+
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, blockSize, numChannels, 0.0f);
+        settings.applyTo(compressor);
+        compressor.reset();
+
+        const Result* engine = runner.run("Compressor::multiband", "bands_" + suffix, blockSize, numChannels,
+                                          blockSize * numChannels, [&] {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+            compressor.process(channels.data(), numChannels, blockSize);
+            gSink = gSink + buffer[0][0];
+        });
+
+        // Stacked instances, each settings.bands = 0
+        DSP::CompressorSettings broadband = makeDetectorSettings(0, true);
+        std::vector<ChainedBand> chain(numBands);
+        for (size_t band = 0; band < numBands; ++band)
+            chain[band].prepare(band, numBands, blockSize, numChannels, broadband);
+
+        const Result* chained = runner.run("Compressor::multiband", "chained_" + suffix, blockSize, numChannels,
+                                           blockSize * numChannels, [&] {
+            for (auto& band : chain)
+                band.process(input, blockSize);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                std::memcpy(buffer[ch].data(), chain[0].channels[ch], blockSize * sizeof(float));
+
+                for (size_t band = 1; band < numBands; ++band)
+                    for (size_t i = 0; i < blockSize; ++i)
+                        buffer[ch][i] += chain[band].channels[ch][i];
+            }
+
+            gSink = gSink + buffer[0][0];
+        });
+
+        if (numBands > 1)
+        {
+            DSP::Crossover crossover;
+            crossover.prepare(kSampleRate, numChannels);
+            crossover.setNumBands(numBands);
+
+            std::vector<float> bandBuffer(numBands * numChannels * blockSize);
+            std::vector<float*> bands(numBands * numChannels);
+            for (size_t k = 0; k < bands.size(); ++k)
+                bands[k] = bandBuffer.data() + k * blockSize;
+
+            runner.run("Crossover::process", "bands_" + suffix, blockSize, numChannels, blockSize * numChannels, [&] {
+                crossover.process(inputs.data(), 0, bands.data(), blockSize);
+                gSink = gSink + bands[0][0];
+            });
+        }
+
+        if (engine == nullptr || chained == nullptr)
+            continue;
+
+        if (numBands == 1)
+        {
+            engineNs = engine->nsPerSample;
+            chainedNs = chained->nsPerSample;
+        }
+        else if (engineNs > 0.0 && chainedNs > 0.0)
+        {
+            std::fprintf(stderr, "  %zu bands relative to 1: engine %.2fx, chained %.2fx (chained / engine %.2fx)\n",
+                         numBands, engine->nsPerSample / engineNs, chained->nsPerSample / chainedNs,
+                         chained->nsPerSample / engine->nsPerSample);
+        }
+    }
+}
+
+//==============================================================================
+// Oversampling: cost of the engine with the gain applied at 2, 4 and 8 times
+// the sample rate, against the aliasing it leaves on a limited tone
+
+struct OversamplingResult
+{
+    size_t factor;
+    bool detection;
+    size_t blockSize;
+    size_t channels;
+    double nsPerSample;
+    double relativeCost;
+    float aliasingDbc;
+    size_t latencySamples;
+};
+
+/** 0 ms attack and a high ratio, so the gain follows the tone's peaks. */
+DSP::CompressorSettings makeOversamplingSettings(size_t factor, bool detection)
+{
+    DSP::CompressorSettings settings;
+    settings.thresholdDb = -20.0f;
+    settings.ratio = 20.0f;
+    settings.attackTimeMs = 0.0f;
+    settings.releaseTimeMs = 5.0f;
+    settings.oversampling = static_cast<int>(std::log2(static_cast<double>(factor)));
+    settings.oversampledDetection = detection;
+    return settings;
+}
+
+/** Power of everything but the tone in the engine's output, relative to the tone. */
+float measureAliasingDbc(size_t factor, bool detection)
+{
+    const size_t blockSize = 256;
+    const size_t length = 2 * kAliasingLength;
+    const double phaseStep = 2.0 * 3.14159265358979323846 * kAliasingToneHz / kSampleRate;
+
+    DSP::Compressor compressor;
+    compressor.prepare(kSampleRate, blockSize, 1, 0.0f);
+    makeOversamplingSettings(factor, detection).applyTo(compressor);
+    compressor.reset();
+
+    std::vector<float> signal(length);
+    for (size_t i = 0; i < length; ++i)
+        signal[i] = 0.5f * static_cast<float>(std::sin(phaseStep * static_cast<double>(i)));
+
+    for (size_t start = 0; start < length; start += blockSize)
+    {
+        float* channel = signal.data() + start;
+        compressor.process(&channel, 1, std::min(blockSize, length - start));
+    }
+
+    // The tone (and DC) fitted over whole cycles of the second half
+    double sine = 0.0, cosine = 0.0, mean = 0.0;
+
+    for (size_t i = kAliasingLength; i < length; ++i)
+    {
+        double phase = phaseStep * static_cast<double>(i);
+        sine += signal[i] * std::sin(phase);
+        cosine += signal[i] * std::cos(phase);
+        mean += signal[i];
+    }
+
+    sine *= 2.0 / kAliasingLength;
+    cosine *= 2.0 / kAliasingLength;
+    mean /= kAliasingLength;
+
+    double residual = 0.0;
+
+    for (size_t i = kAliasingLength; i < length; ++i)
+    {
+        double phase = phaseStep * static_cast<double>(i);
+        double error = signal[i] - sine * std::sin(phase) - cosine * std::cos(phase) - mean;
+        residual += error * error;
+    }
+
+    double tonePower = 0.5 * (sine * sine + cosine * cosine);
+    return static_cast<float>(10.0 * std::log10(residual / kAliasingLength / tonePower));
+}
+
+void benchmarkOversampling(Runner& runner, size_t blockSize, size_t numChannels,
+                           std::vector<OversamplingResult>& oversampling)
+{
+    std::vector<std::vector<float>> input(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        input[ch] = makeSignal(blockSize, 2828u + static_cast<uint32_t>(ch));
+
+    std::vector<std::vector<float>> buffer(input);
+    std::vector<float*> channels(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        channels[ch] = buffer[ch].data();
+
+    double offNs = 0.0;
+
+    for (size_t factor : kOversamplingFactors)
+    {
+        for (bool detection : { false, true })
+        {
+            if (factor == 1 && detection)
+                continue;
+
+            DSP::Compressor compressor;
+            compressor.prepare(kSampleRate, blockSize, numChannels, 0.0f);
+            makeOversamplingSettings(factor, detection).applyTo(compressor);
+            compressor.reset();
+
+            std::string regime = factor == 1 ? "off" : std::to_string(factor) + "x" + (detection ? "_detection" : "");
+
+            const Result* result = runner.run("Compressor::oversampling", regime, blockSize, numChannels,
+                                              blockSize * numChannels, [&] {
+                for (size_t ch = 0; ch < numChannels; ++ch)
+                    std::memcpy(buffer[ch].data(), input[ch].data(), blockSize * sizeof(float));
+
+                compressor.process(channels.data(), numChannels, blockSize);
+                gSink = gSink + buffer[0][0];
+            });
+
+            if (result == nullptr)
+                continue;
+
+            if (factor == 1)
+                offNs = result->nsPerSample;
+
+            double relativeCost = offNs > 0.0 ? result->nsPerSample / offNs : 1.0;
+            float aliasingDbc = measureAliasingDbc(factor, detection);
+
+            oversampling.push_back({ factor, detection, blockSize, numChannels, result->nsPerSample, relativeCost,
+                                     aliasingDbc, compressor.getReportedLatencySamples() });
+            std::fprintf(stderr, "  %.2fx the cost of off, aliasing %.1f dBc, latency %zu samples\n", relativeCost,
+                         static_cast<double>(aliasingDbc), compressor.getReportedLatencySamples());
+        }
+    }
+}
+
+struct DetectorEnvelope
+{
+    std::string detector;
+    float steadyGainReductionDb;  // Mean over the last 20 ms of the burst
+    float rippleDb;               // Peak to peak over the last 20 ms of the burst
+    float attackMs;               // Burst start to 90% of the steady reduction
+    float releaseMs;              // Burst end to 10% of the steady reduction
+    float maxDifferenceDb;        // Largest difference from the level detector
+};
+
+std::vector<DetectorEnvelope> compareDetectorEnvelopes()
+{
+    const size_t length = kBurstLength + kBurstTailLength;
+    const size_t window = static_cast<size_t>(0.02f * kSampleRate);
+
+    std::vector<float> burst(length);
+    for (size_t i = 0; i < length; ++i)
+        burst[i] = (i < kBurstLength ? 1.0f : 0.01f)
+                   * std::sin(6.2831853f * 1000.0f * static_cast<float>(i) / kSampleRate);
+
+    std::vector<DetectorEnvelope> envelopes;
+    std::vector<float> levelGainsDb;
+
+    for (int detector : { 0, 1 })
+    {
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, length, 1, 0.0f);
+        makeDetectorSettings(detector, true).applyTo(compressor);
+        compressor.reset();
+
+        std::vector<float> audio(burst), gains(length);
+        float* channel = audio.data();
+        float* gainOutput = gains.data();
+
+        compressor.setGainOutputs(&gainOutput);
+        compressor.process(&channel, 1, length);
+
+        std::vector<float> gainsDb(length);
+        for (size_t i = 0; i < length; ++i)
+            gainsDb[i] = -DSP::mag2Db(gains[i]);
+
+        DetectorEnvelope envelope{ detector == 0 ? "level" : "log_gain", 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+        float lowest = DSP::positiveInfinity<float>();
+        float highest = 0.0f;
+        double sum = 0.0;
+
+        for (size_t i = kBurstLength - window; i < kBurstLength; ++i)
+        {
+            lowest = std::min(lowest, gainsDb[i]);
+            highest = std::max(highest, gainsDb[i]);
+            sum += gainsDb[i];
+        }
+
+        envelope.steadyGainReductionDb = static_cast<float>(sum / static_cast<double>(window));
+        envelope.rippleDb = highest - lowest;
+
+        size_t attack = 0;
+        while (attack < kBurstLength && gainsDb[attack] < 0.9f * envelope.steadyGainReductionDb)
+            ++attack;
+
+        size_t release = kBurstLength;
+        for (size_t i = kBurstLength; i < length; ++i)
+            if (gainsDb[i] > 0.1f * envelope.steadyGainReductionDb)
+                release = i + 1;
+
+        envelope.attackMs = 1000.0f * static_cast<float>(attack) / kSampleRate;
+        envelope.releaseMs = 1000.0f * static_cast<float>(release - kBurstLength) / kSampleRate;
+
+        if (detector == 0)
+            levelGainsDb = gainsDb;
+
+        for (size_t i = 0; i < length; ++i)
+            envelope.maxDifferenceDb = std::max(envelope.maxDifferenceDb, std::fabs(gainsDb[i] - levelGainsDb[i]));
+
+        std::fprintf(stderr, "detector %-9s steady %.2f dB, ripple %.2f dB, attack %.2f ms, release %.1f ms, "
+                             "largest difference from level %.2f dB\n",
+                     envelope.detector.c_str(), static_cast<double>(envelope.steadyGainReductionDb),
+                     static_cast<double>(envelope.rippleDb), static_cast<double>(envelope.attackMs),
+                     static_cast<double>(envelope.releaseMs), static_cast<double>(envelope.maxDifferenceDb));
+
+        envelopes.push_back(envelope);
+    }
+
+    return envelopes;
+}
+
+//==============================================================================
+// Gain rate: cost of the engine with the gain computer at control rate, and
+// the error of its gains against every-sample gains
+
+struct GainRateResult
+{
+    size_t decimation;
+    size_t blockSize;
+    size_t channels;
+    double nsPerSample;
+    double speedup;
+    float maxErrorDb;
+    float rmsErrorDb;
+};
+
+void benchmarkGainRate(Runner& runner, size_t blockSize, size_t numChannels, std::vector<GainRateResult>& rates)
+{
+    std::vector<std::vector<float>> signal(numChannels);
+    for (size_t ch = 0; ch < numChannels; ++ch)
+        signal[ch] = makeSignal(kGainRateLength, 1212u + static_cast<uint32_t>(ch));
+
+    // Independent channels, so every channel runs the gain computer
+    DSP::CompressorSettings settings;
+    settings.linked = false;
+    settings.thresholdDb = -20.0f;
+    settings.ratio = 4.0f;
+    settings.kneeWidthDb = 6.0f;
+    settings.attackTimeMs = 1.0f;
+
+    std::vector<std::vector<float>> buffer(numChannels, std::vector<float>(blockSize));
+    std::vector<std::vector<float>> gains(numChannels, std::vector<float>(kGainRateLength));
+    std::vector<float*> channels(numChannels);
+    std::vector<float*> gainOutputs(numChannels);
+    std::vector<float> reference;
+
+    double fullNs = 0.0;
+
+    for (size_t decimation : kGainDecimations)
+    {
+        DSP::Compressor compressor;
+        compressor.prepare(kSampleRate, blockSize, numChannels, 30.0f);
+        settings.applyTo(compressor);
+        compressor.setGainDecimation(decimation);
+        compressor.reset();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            channels[ch] = buffer[ch].data();
+
+        size_t position = 0;
+
+        const Result* result = runner.run("Compressor::gainRate", "every_" + std::to_string(decimation), blockSize,
+                                          numChannels, blockSize * numChannels, [&] {
+            size_t length = std::min(blockSize, kGainRateLength - position);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                std::memcpy(buffer[ch].data(), signal[ch].data() + position, length * sizeof(float));
+
+            compressor.process(channels.data(), numChannels, length);
+            position = position + length < kGainRateLength ? position + length : 0;
+            gSink = gSink + buffer[0][0];
+        });
+
+        if (result == nullptr)
+            continue;
+
+        // The gains of the whole signal from a fresh engine (untimed)
+        compressor.reset();
+
+        for (size_t start = 0; start < kGainRateLength; start += blockSize)
+        {
+            size_t length = std::min(blockSize, kGainRateLength - start);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                std::memcpy(buffer[ch].data(), signal[ch].data() + start, length * sizeof(float));
+                gainOutputs[ch] = gains[ch].data() + start;
+            }
+
+            compressor.setGainOutputs(gainOutputs.data());
+            compressor.process(channels.data(), numChannels, length);
+        }
+
+        compressor.setGainOutputs(nullptr);
+
+        std::vector<float> gainsDb;
+        for (const auto& channelGains : gains)
+            for (float gain : channelGains)
+                gainsDb.push_back(DSP::mag2Db(gain));
+
+        if (decimation == 1)
+        {
+            fullNs = result->nsPerSample;
+            reference = gainsDb;
+        }
+
+        float maxErrorDb = 0.0f;
+        double sumOfSquares = 0.0;
+
+        for (size_t i = 0; i < gainsDb.size() && i < reference.size(); ++i)
+        {
+            float errorDb = std::fabs(gainsDb[i] - reference[i]);
+            maxErrorDb = std::max(maxErrorDb, errorDb);
+            sumOfSquares += static_cast<double>(errorDb) * errorDb;
+        }
+
+        auto rmsErrorDb = static_cast<float>(std::sqrt(sumOfSquares / static_cast<double>(gainsDb.size())));
+        double speedup = fullNs > 0.0 ? fullNs / result->nsPerSample : 1.0;
+
+        rates.push_back({ decimation, blockSize, numChannels, result->nsPerSample, speedup, maxErrorDb, rmsErrorDb });
+        std::fprintf(stderr, "  speedup %.2fx, gain error %.4f dB max, %.4f dB rms\n", speedup,
+                     static_cast<double>(maxErrorDb), static_cast<double>(rmsErrorDb));
+    }
+}
+
+//==============================================================================
+// Curve table: evaluated curve vs. lookup table on the same levels
+
+void benchmarkCurveTable(Runner& runner, const Regime& regime, size_t blockSize)
+{
+    // Levels spread over -70..+10 dBFS in no particular order, so every
+    // region of the curve is hit
+    std::vector<float> level(blockSize);
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+        double position = std::fmod(0.6180339887 * static_cast<double>(i), 1.0);
+        level[i] = DSP::db2Mag(-70.0f + 80.0f * static_cast<float>(position));
+    }
+
+    std::vector<float> evaluated(blockSize), table(blockSize);
+
+    DSP::LevelEstimator estimator;
+    DSP::CompressionCurve curve;
+    configure(regime, estimator, curve);
+
+    // The kernel the engine would pick for this curve
+    auto computeEvaluated = [&] {
+        if (curve.hasSoftKnee())
+            curve.computeGainKernel<true, false>(level.data(), evaluated.data(), blockSize);
+        else if (curve.isInfiniteRatio())
+            curve.computeGainKernel<false, true>(level.data(), evaluated.data(), blockSize);
+        else
+            curve.computeGainKernel<false, false>(level.data(), evaluated.data(), blockSize);
+    };
+
+    const std::string name = regime.name;
+
+    const Result* evaluatedResult = runner.run("CompressionCurve::table", name + "_evaluated", blockSize, 1,
+                                               blockSize, [&] {
+        computeEvaluated();
+        gSink = gSink + evaluated[0];
+    });
+
+    curve.setTableLookup(true);
+
+    const Result* tableResult = runner.run("CompressionCurve::table", name + "_table", blockSize, 1, blockSize, [&] {
+        curve.computeGain(level.data(), table.data(), blockSize);
+        gSink = gSink + table[0];
+    });
+
+    if (evaluatedResult == nullptr || tableResult == nullptr)
+        return;
+
+    curve.setTableLookup(false);
+    computeEvaluated();
+    curve.setTableLookup(true);
+    curve.computeGain(level.data(), table.data(), blockSize);
+
+    float maxDifferenceDb = 0.0f;
+    for (size_t i = 0; i < blockSize; ++i)
+        maxDifferenceDb = std::max(maxDifferenceDb, std::fabs(DSP::mag2Db(table[i]) - DSP::mag2Db(evaluated[i])));
+
+    std::fprintf(stderr, "  table speedup %.2fx, largest difference %.3g dB\n",
+                 evaluatedResult->nsPerSample / tableResult->nsPerSample, static_cast<double>(maxDifferenceDb));
+}
+
+//==============================================================================
+// Curve smoothing: cost and largest gain step per smoothing mode while the
+// threshold is automated with a new value every block
+
+struct SmoothingResult
+{
+    std::string mode;
+    size_t blockSize;
+    double nsPerSample;
+    float maxStepDb;
+};
+
+void benchmarkCurveSmoothing(Runner& runner, size_t blockSize, std::vector<SmoothingResult>& smoothing)
+{
+    using Smoothing = DSP::CompressionCurve::Smoothing;
+
+    struct Mode
+    {
+        const char* name;
+        Smoothing smoothing;
+    };
+
+    const Mode modes[] = {
+        { "block", Smoothing::block },
+        { "sub_block_32", Smoothing::subBlock32 },
+        { "sub_block_16", Smoothing::subBlock16 },
+        { "per_sample", Smoothing::perSample },
+    };
+
+    // Steady -6 dBFS level, so every gain change comes from the automation
+    std::vector<float> level(blockSize, 0.5f);
+    std::vector<float> gain(blockSize);
+
+    for (const auto& mode : modes)
+    {
+        DSP::CompressionCurve curve;
+        curve.setSmoothing(mode.smoothing);
+        curve.setSmoothingTime(kSampleRate, DSP::Compressor::kCurveSmoothingSec);
+        curve.setCompressionRatio(4.0f);
+        curve.setKneeWidthDb(6.0f);
+
+        // Threshold sweeps -40..-10 dB and back in 1 dB steps, one per block
+        int step = 0;
+
+        auto iteration = [&] {
+            int phase = step++ % 60;
+            curve.setThresholdDb(-40.0f + static_cast<float>(phase < 30 ? phase : 60 - phase));
+            curve.computeGainKernel<true, false>(level.data(), gain.data(), blockSize);
+            curve.advanceSmoothing(blockSize);
+            gSink = gSink + gain[blockSize - 1];
+        };
+
+        const Result* result = runner.run("CompressionCurve::smoothing", mode.name, blockSize, 1, blockSize,
+                                          iteration);
+
+        if (result == nullptr)
+            continue;
+
+        // Largest step over one full sweep (untimed)
+        float previousGainDb = DSP::mag2Db(gain[blockSize - 1]);
+        float maxStepDb = 0.0f;
+
+        for (int k = 0; k < 60; ++k)
+        {
+            iteration();
+
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+                float gainDb = DSP::mag2Db(gain[i]);
+                maxStepDb = std::max(maxStepDb, std::fabs(gainDb - previousGainDb));
+                previousGainDb = gainDb;
+            }
+        }
+
+        smoothing.push_back({ mode.name, blockSize, result->nsPerSample, maxStepDb });
+        std::fprintf(stderr, "  largest gain step: %.4f dB\n", static_cast<double>(maxStepDb));
+    }
+}
+
+//==============================================================================
+// Accuracy: block gain computer vs. per-sample reference
+
+struct AccuracyResult
+{
+    std::string regime;
+    float maxErrorDb;
+    float toleranceDb;
+    bool pass;
+};
+
+std::vector<AccuracyResult> checkAccuracy()
+{
+    std::vector<AccuracyResult> results;
+
+    // Dense level sweep from silence to +20 dBFS
+    constexpr size_t kNumLevels = 20011;
+    std::vector<float> level(kNumLevels), gain(kNumLevels), reference(kNumLevels);
+
+    for (size_t i = 0; i < kNumLevels; ++i)
+        level[i] = DSP::db2Mag(-160.0f + 180.0f * static_cast<float>(i) / kNumLevels);
+
+    level[0] = 0.0f;
+
+    for (const auto& regime : kRegimes)
+    {
+        DSP::LevelEstimator estimator;
+        DSP::CompressionCurve curve;
+        configure(regime, estimator, curve);
+
+        curve.computeGainReference(level.data(), reference.data(), kNumLevels);
+
+        // Evaluated, then read from the lookup table
+        for (bool table : { false, true })
+        {
+            curve.setTableLookup(table);
+            curve.computeGain(level.data(), gain.data(), kNumLevels);
+
+            float maxErrorDb = 0.0f;
+
+            for (size_t i = 0; i < kNumLevels; ++i)
+                maxErrorDb = std::max(maxErrorDb, std::fabs(DSP::mag2Db(gain[i]) - DSP::mag2Db(reference[i])));
+
+            float toleranceDb = table ? curve.getTableToleranceDb() : DSP::CompressionCurve::kBlockGainToleranceDb;
+            std::string name = std::string(regime.name) + (table ? "_table" : "");
+            results.push_back({ name, maxErrorDb, toleranceDb, maxErrorDb <= toleranceDb });
+
+            std::fprintf(stderr, "accuracy %-22s max |computeGain - reference| = %.3g dB (tolerance %.3g)  %s\n",
+                         name.c_str(), static_cast<double>(maxErrorDb), static_cast<double>(toleranceDb),
+                         results.back().pass ? "ok" : "FAIL");
+        }
+    }
+
+    return results;
+}
+
+/** Render a burst, a gap and a second burst starting mid-block through the
+    engine with the silence fast path on and off, and compare the gains they
+    applied: over the whole render, and from the first sample above the
+    floor on, where the skipped envelope takes over again. The gap is
+    digital silence, or noise below the floor that the full engine follows
+    while the fast path releases to zero.
+*/
+void checkSilenceSkip(std::vector<AccuracyResult>& results)
+{
+    constexpr size_t kNumChannels = 2;
+    constexpr size_t kBlockSize = 512;
+    constexpr size_t kBurstLength = static_cast<size_t>(kSampleRate / 2);
+    constexpr size_t kGapLength = static_cast<size_t>(2 * kSampleRate) + 333;
+    constexpr size_t kLength = 2 * kBurstLength + kGapLength;
+    constexpr float kToleranceDb = 0.01f;
+
+    struct Gap
+    {
+        const char* name;
+        float gain;
+    };
+
+    const Gap gaps[] = { { "silence_skip", 0.0f }, { "silence_skip_noise_floor", DSP::db2Mag(-110.0f) } };
+
+    for (const auto& gap : gaps)
+    {
+        std::vector<std::vector<float>> input(kNumChannels);
+        for (size_t ch = 0; ch < kNumChannels; ++ch)
+        {
+            input[ch] = makeSignal(kLength, 4242u + static_cast<uint32_t>(ch));
+
+            for (size_t i = kBurstLength; i < kBurstLength + kGapLength; ++i)
+                input[ch][i] *= gap.gain;
+        }
+
+        std::vector<std::vector<float>> outputs[2];
+        size_t skipped = 0;
+
+        for (bool skip : { false, true })
+        {
+            DSP::CompressorSettings settings;
+            settings.thresholdDb = -20.0f;
+            settings.ratio = 4.0f;
+            settings.lookaheadTimeMs = 5.0f;
+
+            DSP::Compressor compressor;
+            compressor.prepare(kSampleRate, kBlockSize, kNumChannels, 30.0f);
+            settings.applyTo(compressor);
+            compressor.setSilenceFloorDb(skip ? DSP::Compressor::kDefaultSilenceFloorDb
+                                              : DSP::negativeInfinity<float>());
+            compressor.reset();
+
+            auto& output = outputs[skip ? 1 : 0];
+            output = input;
+
+            std::vector<float*> channels(kNumChannels);
+            for (size_t offset = 0; offset < kLength; offset += kBlockSize)
+            {
+                for (size_t ch = 0; ch < kNumChannels; ++ch)
+                    channels[ch] = output[ch].data() + offset;
+
+                compressor.process(channels.data(), kNumChannels, std::min(kBlockSize, kLength - offset));
+            }
+
+            if (skip)
+                skipped = compressor.getNumSkippedBlocks();
+        }
+
+        // Gains are compared where the output is well above the rounding of either render
+        size_t resume = kBurstLength + kGapLength;
+        float maxErrorDb = 0.0f;
+        float maxResumeErrorDb = 0.0f;
+
+        for (size_t ch = 0; ch < kNumChannels; ++ch)
+        {
+            for (size_t i = 0; i < kLength; ++i)
+            {
+                float full = outputs[0][ch][i];
+                float skippedOutput = outputs[1][ch][i];
+
+                if (std::fabs(full) < 1.0e-3f)
+                    continue;
+
+                float errorDb = std::fabs(DSP::mag2Db(std::fabs(skippedOutput)) - DSP::mag2Db(std::fabs(full)));
+                maxErrorDb = std::max(maxErrorDb, errorDb);
+
+                if (i >= resume)
+                    maxResumeErrorDb = std::max(maxResumeErrorDb, errorDb);
+            }
+        }
+
+        // A render that never skipped checks nothing
+        bool exercised = skipped > 0;
+        std::string name = gap.name;
+
+        results.push_back({ name, maxErrorDb, kToleranceDb, exercised && maxErrorDb <= kToleranceDb });
+        results.push_back({ name + "_resume", maxResumeErrorDb, kToleranceDb,
+                            exercised && maxResumeErrorDb <= kToleranceDb });
+
+        std::fprintf(stderr, "accuracy %-30s max |skipped - full| = %.3g dB, from resume %.3g dB (tolerance %.3g, "
+                             "%zu sub-blocks skipped)  %s\n",
+                     gap.name, static_cast<double>(maxErrorDb), static_cast<double>(maxResumeErrorDb),
+                     static_cast<double>(kToleranceDb), skipped,
+                     results[results.size() - 2].pass && results.back().pass ? "ok" : "FAIL");
+    }
+}
+
+/** Render blocks with fewer and with more channels than the engine was
+    prepared for, broadband and with bands, and compare them with a
+    prepared-size render: the channels present must match a render whose
+    missing channels are silent, and extra channels must come out cleared.
+*/
+void checkChannelCount(std::vector<AccuracyResult>& results)
+{
+    constexpr size_t kPreparedChannels = 4;
+    constexpr size_t kBlockSize = 512;
+    constexpr size_t kLength = 48000;
+
+    struct Case
+    {
+        const char* name;
+        size_t numChannels;
+        size_t numBands;
+    };
+
+    const Case cases[] = { { "channel_count_fewer", 2, 1 }, { "channel_count_more", 6, 1 },
+                           { "channel_count_fewer_bands", 2, 3 }, { "channel_count_more_bands", 6, 3 } };
+
+    for (const auto& test : cases)
+    {
+        size_t numInputs = std::max(test.numChannels, kPreparedChannels);
+        std::vector<std::vector<float>> input(numInputs);
+        for (size_t ch = 0; ch < numInputs; ++ch)
+            input[ch] = makeSignal(kLength, 777u + static_cast<uint32_t>(ch));
+
+        // The reference sees the prepared channels, silent where the block has none
+        std::vector<std::vector<float>> reference(input.begin(), input.begin() + kPreparedChannels);
+        for (size_t ch = test.numChannels; ch < kPreparedChannels; ++ch)
+            std::fill(reference[ch].begin(), reference[ch].end(), 0.0f);
+
+        std::vector<std::vector<float>> output = input;
+        output.resize(test.numChannels);
+
+        auto render = [&](std::vector<std::vector<float>>& buffers) {
+            DSP::CompressorSettings settings;
+            settings.thresholdDb = -20.0f;
+            settings.ratio = 4.0f;
+            settings.lookaheadTimeMs = 5.0f;
+
+            DSP::Compressor compressor;
+            compressor.prepare(kSampleRate, kBlockSize, kPreparedChannels, 30.0f);
+            settings.applyTo(compressor);
+            compressor.setNumBands(test.numBands);
+            compressor.reset();
+
+            std::vector<float*> channels(buffers.size());
+            for (size_t offset = 0; offset < kLength; offset += kBlockSize)
+            {
+                for (size_t ch = 0; ch < buffers.size(); ++ch)
+                    channels[ch] = buffers[ch].data() + offset;
+
+                compressor.process(channels.data(), channels.size(), std::min(kBlockSize, kLength - offset));
+            }
+        };
+
+        render(reference);
+        render(output);
+
+        // Both renders should be bit-identical where the block has channels
+        float maxErrorDb = 0.0f;
+        bool identical = true;
+        bool extrasCleared = true;
+
+        for (size_t ch = 0; ch < test.numChannels; ++ch)
+        {
+            for (size_t i = 0; i < kLength; ++i)
+            {
+                if (ch >= kPreparedChannels)
+                {
+                    extrasCleared &= output[ch][i] == 0.0f;
+                    continue;
+                }
+
+                float expected = reference[ch][i];
+
+                if (output[ch][i] == expected)
+                    continue;
+
+                identical = false;
+                float errorDb = std::fabs(DSP::mag2Db(std::fabs(output[ch][i])) - DSP::mag2Db(std::fabs(expected)));
+                maxErrorDb = std::max(maxErrorDb, errorDb);
+            }
+        }
+
+        results.push_back({ test.name, maxErrorDb, 0.0f, identical && extrasCleared });
+
+        std::fprintf(stderr, "accuracy %-30s %zu of %zu channels, max |block - prepared| = %.3g dB%s%s  %s\n",
+                     test.name, test.numChannels, kPreparedChannels, static_cast<double>(maxErrorDb),
+                     identical ? "" : ", not bit-identical", extrasCleared ? "" : ", extra channels not cleared",
+                     results.back().pass ? "ok" : "FAIL");
+    }
+}
+
+//==============================================================================
+// Output
+
+void writeJson(FILE* out, const std::vector<Result>& results, const std::vector<KernelResult>& kernels,
+               const std::vector<SmoothingResult>& smoothing, const std::vector<GainRateResult>& rates,
+               const std::vector<OversamplingResult>& oversampling, const std::vector<DetectorEnvelope>& envelopes,
+               const std::vector<AccuracyResult>& accuracy)
+{
+    std::fprintf(out, "{\n  \"benchmark\": \"dsp_bench\",\n  \"simd\": \"%s\",\n  \"sampleRate\": %g,\n",
+                 simdName(), static_cast<double>(kSampleRate));
+
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        std::fprintf(out, "    { \"name\": \"%s\", \"regime\": \"%s\", \"blockSize\": %zu, \"channels\": %zu, "
+                          "\"nsPerSample\": %.4f, \"samplesPerSec\": %.1f }%s\n",
+                     r.name.c_str(), r.regime.c_str(), r.blockSize, r.channels,
+                     r.nsPerSample, r.samplesPerSec, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"kernels\": [\n");
+    for (size_t i = 0; i < kernels.size(); ++i)
+    {
+        const auto& k = kernels[i];
+        std::fprintf(out, "    { \"config\": \"%s\", \"blockSize\": %zu, \"channels\": %zu, "
+                          "\"generalNsPerSample\": %.4f, \"specializedNsPerSample\": %.4f, \"speedup\": %.3f, "
+                          "\"minSpeedup\": %.3f, \"maxSpeedup\": %.3f }%s\n",
+                     k.config.c_str(), k.blockSize, k.channels, k.generalNsPerSample, k.specializedNsPerSample,
+                     k.medianSpeedup, k.minSpeedup, k.maxSpeedup, i + 1 < kernels.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"curveSmoothing\": [\n");
+    for (size_t i = 0; i < smoothing.size(); ++i)
+    {
+        const auto& c = smoothing[i];
+        std::fprintf(out, "    { \"mode\": \"%s\", \"blockSize\": %zu, \"nsPerSample\": %.4f, \"maxStepDb\": %.6g }%s\n",
+                     c.mode.c_str(), c.blockSize, c.nsPerSample, static_cast<double>(c.maxStepDb),
+                     i + 1 < smoothing.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"gainRate\": [\n");
+    for (size_t i = 0; i < rates.size(); ++i)
+    {
+        const auto& r = rates[i];
+        std::fprintf(out, "    { \"decimation\": %zu, \"blockSize\": %zu, \"channels\": %zu, \"nsPerSample\": %.4f, "
+                          "\"speedup\": %.3f, \"maxErrorDb\": %.6g, \"rmsErrorDb\": %.6g }%s\n",
+                     r.decimation, r.blockSize, r.channels, r.nsPerSample, r.speedup,
+                     static_cast<double>(r.maxErrorDb), static_cast<double>(r.rmsErrorDb),
+                     i + 1 < rates.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"oversampling\": [\n");
+    for (size_t i = 0; i < oversampling.size(); ++i)
+    {
+        const auto& o = oversampling[i];
+        std::fprintf(out, "    { \"factor\": %zu, \"detection\": %s, \"blockSize\": %zu, \"channels\": %zu, "
+                          "\"nsPerSample\": %.4f, \"relativeCost\": %.3f, \"aliasingDbc\": %.2f, "
+                          "\"latencySamples\": %zu }%s\n",
+                     o.factor, o.detection ? "true" : "false", o.blockSize, o.channels, o.nsPerSample,
+                     o.relativeCost, static_cast<double>(o.aliasingDbc), o.latencySamples,
+                     i + 1 < oversampling.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"detectorEnvelopes\": [\n");
+    for (size_t i = 0; i < envelopes.size(); ++i)
+    {
+        const auto& e = envelopes[i];
+        std::fprintf(out, "    { \"detector\": \"%s\", \"steadyGainReductionDb\": %.4f, \"rippleDb\": %.4f, "
+                          "\"attackMs\": %.3f, \"releaseMs\": %.3f, \"maxDifferenceDb\": %.4f }%s\n",
+                     e.detector.c_str(), static_cast<double>(e.steadyGainReductionDb),
+                     static_cast<double>(e.rippleDb), static_cast<double>(e.attackMs),
+                     static_cast<double>(e.releaseMs), static_cast<double>(e.maxDifferenceDb),
+                     i + 1 < envelopes.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"accuracy\": [\n");
+    for (size_t i = 0; i < accuracy.size(); ++i)
+    {
+        const auto& a = accuracy[i];
+        std::fprintf(out, "    { \"regime\": \"%s\", \"maxErrorDb\": %.6g, \"toleranceDb\": %g, \"pass\": %s }%s\n",
+                     a.regime.c_str(), static_cast<double>(a.maxErrorDb), static_cast<double>(a.toleranceDb),
+                     a.pass ? "true" : "false", i + 1 < accuracy.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--json" && i + 1 < argc)
+            options.jsonPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (arg == "--min-time-ms" && i + 1 < argc)
+            options.minTimeMs = std::atof(argv[++i]);
+        else if (arg == "--quick")
+            options.quick = true;
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--json <file>] [--min-time-ms <ms>] [--filter <substring>] [--quick]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 2;
+
+    Runner runner(options);
+
+    std::vector<size_t> blockSizes(std::begin(kBlockSizes), std::end(kBlockSizes));
+    std::vector<size_t> channelCounts(std::begin(kChannelCounts), std::end(kChannelCounts));
+
+    if (options.quick)
+    {
+        blockSizes.assign(std::begin(kQuickBlockSizes), std::end(kQuickBlockSizes));
+        channelCounts.assign(std::begin(kQuickChannelCounts), std::end(kQuickChannelCounts));
+    }
+
+    std::vector<AccuracyResult> accuracy = checkAccuracy();
+    checkSilenceSkip(accuracy);
+    checkChannelCount(accuracy);
+
+    for (const auto& regime : kRegimes)
+        for (size_t blockSize : blockSizes)
+            for (size_t numChannels : channelCounts)
+                benchmarkCase(runner, regime, blockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkDelayLine(runner, blockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkLinkModes(runner, blockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkGainRamps(runner, blockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkSilence(runner, blockSize, numChannels);
+
+    for (size_t hostBlockSize : kHostBlockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkSubBlocks(runner, hostBlockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        benchmarkParameterUpdates(runner, blockSize);
+
+    for (size_t numChannels : channelCounts)
+        benchmarkParameterSweep(runner, numChannels);
+
+    for (size_t numChannels : channelCounts)
+        benchmarkGainEnvelope(runner, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        benchmarkPeakLookahead(runner, blockSize);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkSidechain(runner, blockSize, numChannels);
+
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkMultiband(runner, blockSize, numChannels);
+
+    std::vector<OversamplingResult> oversampling;
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkOversampling(runner, blockSize, numChannels, oversampling);
+
+    bool detectorsRan = false;
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            detectorsRan |= benchmarkDetector(runner, blockSize, numChannels);
+
+    std::vector<DetectorEnvelope> envelopes;
+    if (detectorsRan)
+        envelopes = compareDetectorEnvelopes();
+
+    std::vector<GainRateResult> rates;
+    for (size_t blockSize : blockSizes)
+        for (size_t numChannels : channelCounts)
+            benchmarkGainRate(runner, blockSize, numChannels, rates);
+
+    for (const auto& regime : kRegimes)
+        for (size_t blockSize : blockSizes)
+            benchmarkCurveTable(runner, regime, blockSize);
+
+    std::vector<SmoothingResult> smoothing;
+    for (size_t blockSize : blockSizes)
+        benchmarkCurveSmoothing(runner, blockSize, smoothing);
+
+    std::vector<KernelResult> kernels;
+    for (size_t blockSize : blockSizes)
+        benchmarkKernels(runner, blockSize, kKernelChannels, kernels);
+
+    if (!kernels.empty())
+    {
+        std::fprintf(stderr, "\nKernel speedup (general / specialized, median and range of %zu repeats):\n",
+                     kKernelRepeats);
+        for (const auto& k : kernels)
+            std::fprintf(stderr, "  %-36s block %5zu  ch %2zu  %5.2fx  (%.2f-%.2fx)\n", k.config.c_str(), k.blockSize,
+                         k.channels, k.medianSpeedup, k.minSpeedup, k.maxSpeedup);
+    }
+
+    if (!oversampling.empty())
+    {
+        std::fprintf(stderr, "\nOversampling (CPU against aliasing of an 11 kHz tone, relative to off):\n");
+        for (const auto& o : oversampling)
+            std::fprintf(stderr, "  %zux %-9s  block %5zu  ch %2zu  %7.3f ns/sample  %5.2fx  aliasing %6.1f dBc  "
+                                 "latency %2zu\n",
+                         o.factor, o.detection ? "detection" : "", o.blockSize, o.channels, o.nsPerSample,
+                         o.relativeCost, static_cast<double>(o.aliasingDbc), o.latencySamples);
+    }
+
+    if (!rates.empty())
+    {
+        std::fprintf(stderr, "\nGain rate (CPU against gain error, relative to every sample):\n");
+        for (const auto& r : rates)
+            std::fprintf(stderr, "  every %2zu  block %5zu  ch %2zu  %7.3f ns/sample  %5.2fx  max %.4f dB  rms %.4f dB\n",
+                         r.decimation, r.blockSize, r.channels, r.nsPerSample, r.speedup,
+                         static_cast<double>(r.maxErrorDb), static_cast<double>(r.rmsErrorDb));
+    }
+
+    FILE* out = stdout;
+    if (!options.jsonPath.empty())
+    {
+        out = std::fopen(options.jsonPath.c_str(), "w");
+        if (out == nullptr)
+        {
+            std::fprintf(stderr, "Could not open %s for writing\n", options.jsonPath.c_str());
+            return 2;
+        }
+    }
+
+    writeJson(out, runner.getResults(), kernels, smoothing, rates, oversampling, envelopes, accuracy);
+
+    if (out != stdout)
+        std::fclose(out);
+
+    for (const auto& a : accuracy)
+        if (!a.pass)
+            return 1;
+
+    return 0;
+}
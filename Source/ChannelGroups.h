@@ -0,0 +1,86 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+    Channel groups for DSP::Compressor::setChannelGroups(), derived from a
+    JUCE channel layout. Shared by the plugin and the offline renderer so
+    that per-group linking splits a layout the same way in both.
+*/
+namespace ChannelGroups
+{
+
+/** Speaker group of a discrete channel, for per-group linking. */
+inline int getSpeakerGroup(juce::AudioChannelSet::ChannelType type)
+{
+    using Set = juce::AudioChannelSet;
+
+    switch (type)
+    {
+        case Set::LFE:
+        case Set::LFE2:
+            return 3;
+
+        case Set::leftSurround:
+        case Set::rightSurround:
+        case Set::centreSurround:
+        case Set::leftSurroundSide:
+        case Set::rightSurroundSide:
+        case Set::leftSurroundRear:
+        case Set::rightSurroundRear:
+            return 1;
+
+        case Set::topMiddle:
+        case Set::topFrontLeft:
+        case Set::topFrontCentre:
+        case Set::topFrontRight:
+        case Set::topRearLeft:
+        case Set::topRearCentre:
+        case Set::topRearRight:
+        case Set::topSideLeft:
+        case Set::topSideRight:
+        case Set::bottomFrontLeft:
+        case Set::bottomFrontCentre:
+        case Set::bottomFrontRight:
+        case Set::bottomSideLeft:
+        case Set::bottomSideRight:
+        case Set::bottomRearLeft:
+        case Set::bottomRearCentre:
+        case Set::bottomRearRight:
+            return 2;
+
+        default:
+            // Front bed and unnamed discrete channels
+            return 0;
+    }
+}
+
+/** Group id per channel: the order of each ACN channel for ambisonics,
+    otherwise bed / surround / height / LFE. */
+inline std::vector<int> getChannelGroups(const juce::AudioChannelSet& layout)
+{
+    std::vector<int> groups(static_cast<size_t>(layout.size()));
+    bool ambisonic = layout.getAmbisonicOrder() >= 0;
+
+    for (int ch = 0; ch < layout.size(); ++ch)
+    {
+        if (ambisonic)
+        {
+            // ACN channel n belongs to order floor(sqrt(n))
+            int order = 0;
+            while ((order + 1) * (order + 1) <= ch)
+                ++order;
+
+            groups[static_cast<size_t>(ch)] = order;
+        }
+        else
+        {
+            groups[static_cast<size_t>(ch)] = getSpeakerGroup(layout.getTypeOfChannel(ch));
+        }
+    }
+
+    return groups;
+}
+
+} // namespace ChannelGroups
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "Utilities.h"
+#include "FastMath.h"
+#include "SIMD.h"
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 namespace DSP
 {
@@ -15,10 +20,33 @@ namespace DSP
     - Below knee: no compression (unity gain)
     - In knee: quadratic interpolation for smooth transition
     - Above knee: constant ratio compression
+
+    Besides the per-sample reference (calculateCompressionGainDb), a block
+    gain computer (computeGain) evaluates the same curve on a whole buffer of
+    level estimates using SIMD and the fastLog2/fastExp2 approximations from
+    FastMath.h. It stays within kBlockGainToleranceDb of the reference.
+    Optionally it reads the curve from a table instead (see
+    setTableLookup), which is rebuilt whenever the settings change.
+
+    Threshold, ratio and knee changes can be ramped inside the block gain
+    computer instead of taking effect at a block boundary (see Smoothing),
+    so automation doesn't produce steps whose size depends on the block
+    size. The curve only reads the ramp; the owner advances it once per
+    block with advanceSmoothing(), so several gain computations in one
+    block (e.g. one per channel group) see the same ramp.
 */
 class CompressionCurve
 {
 public:
+    /** How threshold, ratio and knee changes reach the block gain computer. */
+    enum class Smoothing
+    {
+        block,      // Jump to the new curve at the next block
+        subBlock32, // Ramp, updating the curve every 32 samples
+        subBlock16, // Ramp, updating the curve every 16 samples
+        perSample   // Ramp, interpolating the curve for every sample
+    };
+
     CompressionCurve() = default;
 
     //==============================================================================
@@ -45,6 +73,7 @@ public:
     void setThresholdDb(float thresholdDb)
     {
         thresholdDb_ = thresholdDb;
+        updateBlockCoefficients();
     }
 
     float getThresholdDb() const
@@ -59,6 +88,8 @@ public:
     {
         if (kneeWidthDb >= 0.0f)
             kneeWidthDb_ = kneeWidthDb;
+
+        updateBlockCoefficients();
     }
 
     float getKneeWidthDb() const
@@ -73,6 +104,8 @@ public:
     {
         if (ratio >= 1.0f)
             compressionRatio_ = ratio;
+
+        updateBlockCoefficients();
     }
 
     float getCompressionRatio() const
@@ -80,6 +113,95 @@ public:
         return compressionRatio_;
     }
 
+    //==============================================================================
+    // Smoothing
+
+    /** Select how parameter changes are applied. Switching to Smoothing::block
+        ends any ramp in progress.
+    */
+    void setSmoothing(Smoothing smoothing)
+    {
+        smoothing_ = smoothing;
+
+        if (smoothing_ == Smoothing::block)
+            resetSmoothing();
+    }
+
+    Smoothing getSmoothing() const { return smoothing_; }
+
+    /** Set the length of the ramp started by each parameter change.
+        @param sampleRateHz  The sample rate in Hz
+        @param rampLengthSec Time to reach new settings, in seconds
+    */
+    void setSmoothingTime(double sampleRateHz, double rampLengthSec)
+    {
+        rampLength_ = static_cast<size_t>(std::max(0.0, std::floor(rampLengthSec * sampleRateHz)));
+        resetSmoothing();
+    }
+
+    /** Jump to the current settings, ending any ramp. */
+    void resetSmoothing() { rampRemaining_ = 0; }
+
+    /** True while a ramp towards new settings is in progress. */
+    bool isSmoothing() const { return rampRemaining_ > 0; }
+
+    /** Move the ramp on after a block.
+        @param numSamples Number of samples just processed
+        @return True if the ramp finished during this block
+    */
+    bool advanceSmoothing(size_t numSamples)
+    {
+        if (rampRemaining_ == 0)
+            return false;
+
+        rampRemaining_ -= std::min(numSamples, rampRemaining_);
+        return rampRemaining_ == 0;
+    }
+
+    //==============================================================================
+    // Lookup Table
+
+    /** Cells of the lookup table across the knee (or across 1 log2 unit for a hard knee). */
+    static constexpr size_t kTableKneeCells = 256;
+
+    /** Read the block gain computer's curve from a table of gains, indexed by
+        the log2 level and interpolated linearly, instead of evaluating it.
+
+        The table starts at the bottom of the knee, where the curve leaves
+        unity, and has kTableKneeCells cells across the knee plus one above
+        it. Levels below it get unity gain, and levels above it extrapolate
+        the last cell, which lies on the straight part of the curve. The knee
+        end points fall on table entries, so the only interpolation error is
+        inside the knee, where the curve is a parabola (see getTableToleranceDb).
+
+        The table is rebuilt by the setters, not while processing. While a
+        threshold, ratio or knee change ramps, the curve is evaluated as usual.
+    */
+    void setTableLookup(bool shouldUseTable)
+    {
+        tableLookup_ = shouldUseTable;
+
+        if (tableLookup_)
+            updateTable();
+    }
+
+    bool isTableLookup() const { return tableLookup_; }
+
+    /** Maximum deviation of the table-driven computeGain from
+        calculateCompressionGainDb, in dB, for the current settings.
+
+        Linear interpolation of a parabola with second derivative
+        slope / knee over cells of knee / kTableKneeCells is off by at most
+        knee * |slope| / (8 * kTableKneeCells^2), so the bound is
+        kBlockGainToleranceDb plus kneeWidthDb / 524288 at most (under
+        5e-5 dB for a 24 dB knee).
+    */
+    float getTableToleranceDb() const
+    {
+        constexpr auto cells = static_cast<float>(kTableKneeCells);
+        return kBlockGainToleranceDb + kneeWidthDb_ * std::fabs(target_.slope) / (8.0f * cells * cells);
+    }
+
     //==============================================================================
     // Gain Calculation
 
@@ -145,11 +267,96 @@ public:
         return inLevelDb + calculateCompressionGainDb(inLevelDb);
     }
 
+    //==============================================================================
+    // Block Gain Computer
+
+    /** Maximum deviation of computeGain from calculateCompressionGainDb, in dB.
+
+        Dominated by the fastLog2 error (< 9e-5 dB) since the curve slope
+        never exceeds 1; the remainder covers float rounding of the level.
+    */
+    static constexpr float kBlockGainToleranceDb = 2.0e-4f;
+
+    /** Compute linear compression gains for a block of level estimates.
+
+        The curve is evaluated branchlessly in the log2 domain:
+            x    = log2(level) - threshold
+            knee = clamp(x + knee/2, 0, knee)
+            gain = slope * (knee^2 / (2 * knee) + max(x - knee/2, 0))
+        which reproduces all three regions of calculateCompressionGainDb.
+
+        @param levelEstimate Pointer to level estimates (linear magnitude, NOT in dB)
+        @param gainOutput    Pointer to output linear gains (may alias levelEstimate)
+        @param numSamples    Number of samples to process
+        @return The largest gain reduction in the block, in dB (zero or negative)
+    */
+    float computeGain(const float* levelEstimate, float* gainOutput, size_t numSamples) const
+    {
+        if (tableLookup_ && !isSmoothing())
+            return computeGainTable(levelEstimate, gainOutput, numSamples);
+
+        return computeGainSmoothed<false, true, false>(levelEstimate, gainOutput, nullptr, numSamples);
+    }
+
+    /** computeGain specialized for the current curve shape.
+
+        The caller must pick the specialization matching hasSoftKnee() and
+        isInfiniteRatio(); the result is then identical to computeGain, with
+        the knee term or the slope multiply compiled out.
+    */
+    template <bool SoftKnee, bool InfiniteRatio>
+    float computeGainKernel(const float* levelEstimate, float* gainOutput, size_t numSamples) const
+    {
+        if (tableLookup_ && !isSmoothing())
+            return computeGainTable(levelEstimate, gainOutput, numSamples);
+
+        return computeGainSmoothed<false, SoftKnee, InfiniteRatio>(levelEstimate, gainOutput, nullptr, numSamples);
+    }
+
+    /** computeGainKernel without the final exp: the gains are written in
+        log2 units (zero or negative), as the curve computed them.
+    */
+    template <bool SoftKnee, bool InfiniteRatio>
+    float computeGainLog2Kernel(const float* levelEstimate, float* gainLog2Output, size_t numSamples) const
+    {
+        if (tableLookup_ && !isSmoothing())
+            return computeGainTable<true>(levelEstimate, gainLog2Output, numSamples);
+
+        return computeGainSmoothed<false, SoftKnee, InfiniteRatio, true>(levelEstimate, gainLog2Output, nullptr,
+                                                                          numSamples);
+    }
+
+    /** True if the knee width is non-zero, or is ramping. */
+    bool hasSoftKnee() const { return kneeWidthDb_ > 0.0f || (isSmoothing() && kneeStep_ != 0.0f); }
+
+    /** True for brick wall limiting (and not ramping towards or away from it). */
+    bool isInfiniteRatio() const
+    {
+        return compressionRatio_ == positiveInfinity<float>() && !(isSmoothing() && slopeStep_ != 0.0f);
+    }
+
+    /** Scalar reference version of computeGain, built on calculateCompressionGainDb
+        with exact mag2Db/db2Mag conversions. Useful for verifying the vector path.
+    */
+    float computeGainReference(const float* levelEstimate, float* gainOutput, size_t numSamples) const
+    {
+        float minGainDb = 0.0f;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            float gainDb = calculateCompressionGainDb(mag2Db(levelEstimate[i]));
+            gainOutput[i] = db2Mag(gainDb);
+            minGainDb = std::min(minGainDb, gainDb);
+        }
+
+        return minGainDb;
+    }
+
     /** Apply compression to a buffer of audio samples.
 
         @param input         Pointer to input samples
         @param levelEstimate Pointer to level estimates (linear magnitude, NOT in dB)
-        @param output        Pointer to output samples
+        @param output        Pointer to output samples (may alias input)
         @param numSamples    Number of samples to process
         @param gainReduction Optional pointer to store gain reduction values (in dB, for metering)
     */
@@ -159,23 +366,21 @@ public:
                           size_t numSamples,
                           float* gainReduction = nullptr) const
     {
-        for (size_t i = 0; i < numSamples; ++i)
-        {
-            // Convert level estimate to dB
-            float levelDb = mag2Db(levelEstimate[i]);
+        float gain[kApplyChunkSize];
 
-            // Calculate gain reduction in dB
-            float gainDb = calculateCompressionGainDb(levelDb);
+        for (size_t offset = 0; offset < numSamples; offset += kApplyChunkSize)
+        {
+            size_t chunk = std::min(kApplyChunkSize, numSamples - offset);
+            float* gainDb = gainReduction != nullptr ? gainReduction + offset : nullptr;
 
-            // Convert to linear gain
-            float gain = db2Mag(gainDb);
+            if (gainDb != nullptr)
+                computeGainBlock<true, true, false>(levelEstimate + offset, gain, gainDb, chunk, target_);
+            else
+                computeGainBlock<false, true, false>(levelEstimate + offset, gain, nullptr, chunk, target_);
 
             // Apply compression and makeup gain
-            output[i] = input[i] * gain * makeupGain_;
-
-            // Store gain reduction for metering
-            if (gainReduction != nullptr)
-                gainReduction[i] = gainDb;
+            for (size_t i = 0; i < chunk; ++i)
+                output[offset + i] = input[offset + i] * gain[i] * makeupGain_;
         }
     }
 
@@ -190,11 +395,404 @@ public:
         return calculateCompressionGainDb(levelDb);
     }
 
+    //==============================================================================
+    // Lane-wise evaluation
+
+    /** Block gain computer coefficients (log2 domain). */
+    struct Coefficients
+    {
+        float thresholdLog2 = 0.0f;
+        float kneeLog2 = 0.0f;
+        float halfKneeLog2 = 0.0f;
+        float invTwoKneeLog2 = 0.0f;
+        float slope = 0.0f;
+    };
+
+    /** Coefficients broadcast to every lane, interpolated per lane, or one curve per lane. */
+    struct VectorCoefficients
+    {
+        SIMD::Float thresholdLog2;
+        SIMD::Float kneeLog2;
+        SIMD::Float halfKneeLog2;
+        SIMD::Float invTwoKneeLog2;
+        SIMD::Float slope;
+    };
+
+    /** Block gain computer coefficients of the current settings, ignoring any ramp. */
+    const Coefficients& getTargetCoefficients() const { return target_; }
+
+    /** Branchless curve evaluation for one sample, in log2 units.
+        With a zero knee the knee term is exactly zero, and with an infinite
+        ratio the slope is exactly -1, so the specializations only drop work.
+    */
+    template <bool SoftKnee, bool InfiniteRatio>
+    static float gainLog2(float levelLog2, const Coefficients& c)
+    {
+        float x = levelLog2 - c.thresholdLog2;
+        float curve;
+
+        if (SoftKnee)
+        {
+            float knee = std::min(std::max(x + c.halfKneeLog2, 0.0f), c.kneeLog2);
+            float above = std::max(x - c.halfKneeLog2, 0.0f);
+            curve = knee * knee * c.invTwoKneeLog2 + above;
+        }
+        else
+        {
+            curve = std::max(x, 0.0f);
+        }
+
+        return InfiniteRatio ? -curve : c.slope * curve;
+    }
+
+    template <bool SoftKnee, bool InfiniteRatio>
+    static SIMD::Float gainLog2(SIMD::Float levelLog2, const VectorCoefficients& c)
+    {
+        SIMD::Float x = SIMD::sub(levelLog2, c.thresholdLog2);
+        SIMD::Float curve;
+
+        if (SoftKnee)
+        {
+            SIMD::Float knee = SIMD::min(SIMD::max(SIMD::add(x, c.halfKneeLog2), SIMD::broadcast(0.0f)),
+                                         c.kneeLog2);
+            SIMD::Float above = SIMD::max(SIMD::sub(x, c.halfKneeLog2), SIMD::broadcast(0.0f));
+            curve = SIMD::add(SIMD::mul(SIMD::mul(knee, knee), c.invTwoKneeLog2), above);
+        }
+        else
+        {
+            curve = SIMD::max(x, SIMD::broadcast(0.0f));
+        }
+
+        return InfiniteRatio ? SIMD::sub(SIMD::broadcast(0.0f), curve)
+                             : SIMD::mul(c.slope, curve);
+    }
+
 private:
+    //==============================================================================
+    static constexpr size_t kApplyChunkSize = 256;
+
+    /** Smallest knee used for the reciprocal while a knee ramps through zero. */
+    static constexpr float kMinRampKneeLog2 = 1.0e-20f;
+
+    static VectorCoefficients broadcast(const Coefficients& c)
+    {
+        return { SIMD::broadcast(c.thresholdLog2), SIMD::broadcast(c.kneeLog2), SIMD::broadcast(c.halfKneeLog2),
+                 SIMD::broadcast(c.invTwoKneeLog2), SIMD::broadcast(c.slope) };
+    }
+
+    void updateBlockCoefficients()
+    {
+        using FastMath::kLog2PerDb;
+
+        // Start any ramp from where the current one has got to
+        Coefficients previous = getCoefficients(static_cast<float>(rampRemaining_));
+
+        target_.thresholdLog2 = thresholdDb_ * kLog2PerDb;
+        target_.kneeLog2 = kneeWidthDb_ * kLog2PerDb;
+        target_.halfKneeLog2 = 0.5f * target_.kneeLog2;
+        target_.invTwoKneeLog2 = target_.kneeLog2 > 0.0f ? 1.0f / (2.0f * target_.kneeLog2) : 0.0f;
+
+        // Curve slope above the knee (-1 for brick wall limiting)
+        target_.slope = compressionRatio_ == positiveInfinity<float>() ? -1.0f
+                                                                       : 1.0f / compressionRatio_ - 1.0f;
+
+        if (tableLookup_)
+            updateTable();
+
+        bool changed = previous.thresholdLog2 != target_.thresholdLog2 || previous.kneeLog2 != target_.kneeLog2
+                       || previous.slope != target_.slope;
+
+        if (smoothing_ == Smoothing::block || rampLength_ == 0 || !changed)
+        {
+            rampRemaining_ = 0;
+            return;
+        }
+
+        // A coefficient at `remaining` samples from the end is target - remaining * step
+        auto length = static_cast<float>(rampLength_);
+        thresholdStep_ = (target_.thresholdLog2 - previous.thresholdLog2) / length;
+        kneeStep_ = (target_.kneeLog2 - previous.kneeLog2) / length;
+        slopeStep_ = (target_.slope - previous.slope) / length;
+        rampRemaining_ = rampLength_;
+    }
+
+    /** Fill the lookup table from the target coefficients. Entries are
+        computed in double from their offset into the knee, so the knee end
+        lands exactly on the last entry.
+    */
+    void updateTable()
+    {
+        const double knee = target_.kneeLog2;
+        const double span = knee > 0.0 ? knee : 1.0;
+        const double invTwoKnee = knee > 0.0 ? 1.0 / (2.0 * knee) : 0.0;
+        const double slope = target_.slope;
+
+        auto gainAt = [&](size_t cell) {
+            double u = span * static_cast<double>(cell) / static_cast<double>(kTableKneeCells);
+            double inKnee = std::min(u, knee);
+            return slope * (inKnee * inKnee * invTwoKnee + std::max(u - knee, 0.0));
+        };
+
+        double previous = gainAt(0);
+
+        for (size_t k = 0; k <= kTableKneeCells; ++k)
+        {
+            double next = gainAt(k + 1);
+            tableGains_[k] = static_cast<float>(previous);
+            tableSteps_[k] = static_cast<float>(next - previous);
+            previous = next;
+        }
+
+        tableOriginLog2_ = target_.thresholdLog2 - target_.halfKneeLog2;
+        tableScale_ = static_cast<float>(static_cast<double>(kTableKneeCells) / span);
+    }
+
+    /** Block gain computer reading the lookup table: position in the table,
+        clamped below at its start and in index at its last cell, then a
+        linear interpolation between entries.
+    */
+    template <bool Log2Output = false>
+    float computeGainTable(const float* levelEstimate, float* gainOutput, size_t numSamples) const
+    {
+        using FastMath::kDbPerLog2;
+
+        constexpr auto lastCell = static_cast<float>(kTableKneeCells);
+        size_t i = 0;
+        float minGainLog2 = 0.0f;
+
+        if (numSamples >= SIMD::kWidth)
+        {
+            SIMD::Float origin = SIMD::broadcast(tableOriginLog2_);
+            SIMD::Float scale = SIMD::broadcast(tableScale_);
+            SIMD::Float zero = SIMD::broadcast(0.0f);
+            SIMD::Float last = SIMD::broadcast(lastCell);
+            SIMD::Float minVec = zero;
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            {
+                SIMD::Float position = SIMD::mul(SIMD::sub(fastLog2(SIMD::load(levelEstimate + i)), origin), scale);
+                position = SIMD::max(position, zero);
+
+                SIMD::Int cell = SIMD::truncateToInt(SIMD::min(position, last));
+                SIMD::Float fraction = SIMD::sub(position, SIMD::toFloat(cell));
+                SIMD::Float g = SIMD::add(SIMD::gather(tableGains_.data(), cell),
+                                          SIMD::mul(fraction, SIMD::gather(tableSteps_.data(), cell)));
+
+                minVec = SIMD::min(minVec, g);
+                SIMD::store(gainOutput + i, Log2Output ? g : fastExp2(g));
+            }
+
+            minGainLog2 = SIMD::reduceMin(minVec);
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            float position = std::max(0.0f, (fastLog2(levelEstimate[i]) - tableOriginLog2_) * tableScale_);
+            auto cell = static_cast<size_t>(std::min(position, lastCell));
+            float g = tableGains_[cell] + (position - static_cast<float>(cell)) * tableSteps_[cell];
+
+            minGainLog2 = std::min(minGainLog2, g);
+            gainOutput[i] = Log2Output ? g : fastExp2(g);
+        }
+
+        return minGainLog2 * kDbPerLog2;
+    }
+
+    /** Coefficients `remaining` samples before the end of the ramp. */
+    Coefficients getCoefficients(float remaining) const
+    {
+        if (remaining <= 0.0f)
+            return target_;
+
+        Coefficients c;
+        c.thresholdLog2 = target_.thresholdLog2 - remaining * thresholdStep_;
+        c.kneeLog2 = std::max(target_.kneeLog2 - remaining * kneeStep_, 0.0f);
+        c.halfKneeLog2 = 0.5f * c.kneeLog2;
+        c.invTwoKneeLog2 = c.kneeLog2 > 0.0f ? 1.0f / (2.0f * c.kneeLog2) : 0.0f;
+        c.slope = target_.slope - remaining * slopeStep_;
+        return c;
+    }
+
+    /** Block gain computer for fixed coefficients. */
+    template <bool WriteGainDb, bool SoftKnee, bool InfiniteRatio, bool Log2Output = false>
+    static float computeGainBlock(const float* levelEstimate, float* gainOutput, float* gainDbOutput,
+                                  size_t numSamples, const Coefficients& coefficients)
+    {
+        using FastMath::kDbPerLog2;
+
+        size_t i = 0;
+        float minGainLog2 = 0.0f;
+
+        if (numSamples >= SIMD::kWidth)
+        {
+            VectorCoefficients c = broadcast(coefficients);
+            SIMD::Float minVec = SIMD::broadcast(0.0f);
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            {
+                SIMD::Float g = gainLog2<SoftKnee, InfiniteRatio>(fastLog2(SIMD::load(levelEstimate + i)), c);
+                minVec = SIMD::min(minVec, g);
+
+                if (WriteGainDb)
+                    SIMD::store(gainDbOutput + i, SIMD::mul(g, SIMD::broadcast(kDbPerLog2)));
+
+                SIMD::store(gainOutput + i, Log2Output ? g : fastExp2(g));
+            }
+
+            minGainLog2 = SIMD::reduceMin(minVec);
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            float g = gainLog2<SoftKnee, InfiniteRatio>(fastLog2(levelEstimate[i]), coefficients);
+            minGainLog2 = std::min(minGainLog2, g);
+
+            if (WriteGainDb)
+                gainDbOutput[i] = g * kDbPerLog2;
+
+            gainOutput[i] = Log2Output ? g : fastExp2(g);
+        }
+
+        return minGainLog2 * kDbPerLog2;
+    }
+
+    /** Block gain computer following the ramp, with coefficients
+        interpolated for every sample. The knee reciprocal is only
+        recomputed per lane while the knee itself moves.
+    */
+    template <bool WriteGainDb, bool SoftKnee, bool InfiniteRatio, bool KneeRamp, bool Log2Output = false>
+    float computeGainRamp(const float* levelEstimate, float* gainOutput, float* gainDbOutput,
+                          size_t numSamples) const
+    {
+        using FastMath::kDbPerLog2;
+
+        // Sample i is (rampRemaining_ - 1 - i) samples before the end of the ramp
+        auto remainingAt = [this](size_t i) { return static_cast<float>(rampRemaining_) - 1.0f - static_cast<float>(i); };
+
+        size_t i = 0;
+        float minGainLog2 = 0.0f;
+
+        if (numSamples >= SIMD::kWidth)
+        {
+            VectorCoefficients c = broadcast(target_);
+            SIMD::Float minVec = SIMD::broadcast(0.0f);
+            SIMD::Float zero = SIMD::broadcast(0.0f);
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            {
+                SIMD::Float remaining = SIMD::max(SIMD::ramp(remainingAt(i), -1.0f), zero);
+
+                c.thresholdLog2 = SIMD::sub(SIMD::broadcast(target_.thresholdLog2),
+                                            SIMD::mul(remaining, SIMD::broadcast(thresholdStep_)));
+
+                if (KneeRamp)
+                {
+                    c.kneeLog2 = SIMD::max(SIMD::sub(SIMD::broadcast(target_.kneeLog2),
+                                                     SIMD::mul(remaining, SIMD::broadcast(kneeStep_))),
+                                           zero);
+                    c.halfKneeLog2 = SIMD::mul(c.kneeLog2, SIMD::broadcast(0.5f));
+                    c.invTwoKneeLog2 = SIMD::div(SIMD::broadcast(1.0f),
+                                                 SIMD::max(SIMD::add(c.kneeLog2, c.kneeLog2),
+                                                           SIMD::broadcast(kMinRampKneeLog2)));
+                }
+
+                if (!InfiniteRatio)
+                    c.slope = SIMD::sub(SIMD::broadcast(target_.slope),
+                                        SIMD::mul(remaining, SIMD::broadcast(slopeStep_)));
+
+                SIMD::Float g = gainLog2<SoftKnee, InfiniteRatio>(fastLog2(SIMD::load(levelEstimate + i)), c);
+                minVec = SIMD::min(minVec, g);
+
+                if (WriteGainDb)
+                    SIMD::store(gainDbOutput + i, SIMD::mul(g, SIMD::broadcast(kDbPerLog2)));
+
+                SIMD::store(gainOutput + i, Log2Output ? g : fastExp2(g));
+            }
+
+            minGainLog2 = SIMD::reduceMin(minVec);
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            float g = gainLog2<SoftKnee, InfiniteRatio>(fastLog2(levelEstimate[i]), getCoefficients(remainingAt(i)));
+            minGainLog2 = std::min(minGainLog2, g);
+
+            if (WriteGainDb)
+                gainDbOutput[i] = g * kDbPerLog2;
+
+            gainOutput[i] = Log2Output ? g : fastExp2(g);
+        }
+
+        return minGainLog2 * kDbPerLog2;
+    }
+
+    /** Block gain computer honouring the smoothing mode. Without a ramp in
+        progress this is exactly computeGainBlock with the target coefficients.
+    */
+    template <bool WriteGainDb, bool SoftKnee, bool InfiniteRatio, bool Log2Output = false>
+    float computeGainSmoothed(const float* levelEstimate, float* gainOutput, float* gainDbOutput,
+                              size_t numSamples) const
+    {
+        if (!isSmoothing())
+            return computeGainBlock<WriteGainDb, SoftKnee, InfiniteRatio, Log2Output>(
+                levelEstimate, gainOutput, gainDbOutput, numSamples, target_);
+
+        if (smoothing_ == Smoothing::perSample)
+        {
+            if (SoftKnee && kneeStep_ != 0.0f)
+                return computeGainRamp<WriteGainDb, SoftKnee, InfiniteRatio, true, Log2Output>(
+                    levelEstimate, gainOutput, gainDbOutput, numSamples);
+
+            return computeGainRamp<WriteGainDb, SoftKnee, InfiniteRatio, false, Log2Output>(
+                levelEstimate, gainOutput, gainDbOutput, numSamples);
+        }
+
+        // Sub-blocks use the curve reached at their last sample. They are
+        // counted from the start of the ramp, so the steps don't depend on
+        // how the caller splits its blocks.
+        size_t subBlockSize = smoothing_ == Smoothing::subBlock16 ? 16 : 32;
+        size_t elapsed = rampLength_ - rampRemaining_;
+        float minGainDb = 0.0f;
+
+        for (size_t offset = 0, chunk = 0; offset < numSamples; offset += chunk)
+        {
+            size_t subBlockEnd = offset + subBlockSize - (elapsed + offset) % subBlockSize;
+            chunk = std::min(subBlockEnd, numSamples) - offset;
+            float remaining = static_cast<float>(rampRemaining_) - static_cast<float>(subBlockEnd);
+
+            minGainDb = std::min(minGainDb, computeGainBlock<WriteGainDb, SoftKnee, InfiniteRatio, Log2Output>(
+                                                levelEstimate + offset, gainOutput + offset,
+                                                WriteGainDb ? gainDbOutput + offset : nullptr, chunk,
+                                                getCoefficients(remaining)));
+        }
+
+        return minGainDb;
+    }
+
+    //==============================================================================
     float makeupGain_ = 1.0f;       // Linear makeup gain
     float thresholdDb_ = 0.0f;      // Threshold in dB
     float kneeWidthDb_ = 0.0f;      // Knee width in dB
     float compressionRatio_ = 1.0f; // Compression ratio (1:1 = no compression)
+
+    // Block gain computer coefficients for the current settings
+    Coefficients target_;
+
+    // Lookup table of target_ (see setTableLookup): gain at each entry, in
+    // log2 units, and the step to the next entry
+    bool tableLookup_ = false;
+    float tableOriginLog2_ = 0.0f;
+    float tableScale_ = 1.0f;
+    std::array<float, kTableKneeCells + 1> tableGains_{};
+    std::array<float, kTableKneeCells + 1> tableSteps_{};
+
+    // Ramp towards target_ (see getCoefficients)
+    Smoothing smoothing_ = Smoothing::perSample;
+    size_t rampLength_ = 0;
+    size_t rampRemaining_ = 0;
+    float thresholdStep_ = 0.0f;
+    float kneeStep_ = 0.0f;
+    float slopeStep_ = 0.0f;
 };
 
 } // namespace DSP
@@ -0,0 +1,1843 @@
+#pragma once
+
+#include "LevelEstimator.h"
+#include "CompressionCurve.h"
+#include "Crossover.h"
+#include "DelayLine.h"
+#include "LookaheadController.h"
+#include "LinearSmoother.h"
+#include "Oversampler.h"
+#include "PeakLookahead.h"
+#include "SpscRing.h"
+#include "Telemetry.h"
+#include "Utilities.h"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    The complete broadband compressor signal path, independent of JUCE.
+
+    Per block: input gain -> level detection -> gain computer (every
+    sample, or at control rate, see setGainDecimation) -> peak lookahead
+    (optional) -> lookahead alignment -> compression and output gain. With
+    the log gain detector (see setDetector) the gain computer runs on the
+    rectified input and the smoothing follows it. The plugin and offline tools
+    drive the same engine so their output is identical.
+
+    Blocks are processed in sub-blocks of kDefaultSubBlockSize samples (see
+    setSubBlockSize), with every stage run on a sub-block before moving on
+    to the next. The audio, levels and gains of a sub-block then stay in
+    cache between stages, however large the host block is. Shorter
+    sub-blocks pay a fixed cost per pass that outweighs the cache savings
+    at typical channel counts (see the Compressor::subBlock benchmark).
+
+    Any number of channels is supported. The link mode decides which
+    channels feed each detector and which channels share its gain:
+    independent channels, all channels, per channel group (e.g. the bed,
+    surround, height and LFE groups of a 7.1.4 layout, or the orders of an
+    ambisonic stream), or channel 0 only (the W channel of ACN-ordered
+    ambisonics) driving every channel. Levels of all detector channels are
+    estimated together, one SIMD lane per channel.
+
+    The engine can also split the input into 2 to kMaxBands bands (see
+    setNumBands). Each band of each channel then runs as a channel of its
+    own: the bands share the settings, while each keeps its own envelope and
+    gain, with the link mode applied within every band. All bands' detectors
+    are estimated together in SIMD lanes, and the bands are summed again at
+    the end of each pass.
+
+    The detectors can listen to an external sidechain instead of the input
+    (see setSidechain). They read the host's sidechain buffers in place,
+    while the input still runs through the lookahead delay, so the key
+    signal leads the audio by the lookahead just like the input would.
+
+    With attack near zero the gain can change fast enough to alias, so the
+    gain can be applied at 2, 4 or 8 times the sample rate (see
+    setOversampling): the gain and the delayed audio are upsampled, multiplied
+    and brought back down, and the filters' latency is added to the reported
+    latency. Optionally the detectors see the inter-sample peaks of the input
+    as well.
+
+    The gain computer and detector loops are compiled once per knee shape,
+    ratio type and hold setting, so they carry no work for a disabled
+    feature; the kernel picks the matching loops once per block. The
+    settings behind that choice (see KernelFlags) are only re-evaluated
+    when one of them has changed.
+
+    Silent input skips the detector and gain computer (see
+    setSilenceFloorDb): once the input has stayed below the silence floor
+    long enough for every gain on its way to the output to be exactly
+    unity, a pass only applies the input and output gains and advances the
+    delay lines. Full processing resumes on the first sample above the
+    floor.
+
+    Setters remember the last value they applied and return early when it
+    is passed again, so coefficients (exp/pow) are only recomputed for the
+    settings that actually moved. getNumCoefficientUpdates() counts the
+    recomputations.
+*/
+class Compressor
+{
+public:
+    /** Settings the kernel branches on. The low bits choose specialized
+        gain computer and detector loops. */
+    enum KernelFlags : unsigned
+    {
+        kSoftKnee = 1u << 0,      // Non-zero knee width
+        kInfiniteRatio = 1u << 1, // Brick wall limiting
+        kHold = 1u << 2,          // Non-zero hold time
+        kLinked = 1u << 3,        // Channels share gains (any mode but independent)
+        kLookahead = 1u << 4,     // Audio delay active (or fading)
+        kSpecializedFlags = kSoftKnee | kInfiniteRatio | kHold
+    };
+
+    /** Which channels are detected together and share a gain. */
+    enum class LinkMode
+    {
+        independent, // Every channel has its own detector and gain
+        all,         // One detector (max of all channels) drives every channel
+        groups,      // One detector per channel group, see setChannelGroups()
+        wChannel     // Channel 0 alone drives every channel (ambisonic W)
+    };
+
+    /** Where the attack, hold and release act (see setDetector). */
+    enum class Detector
+    {
+        level,  // Smooth the input level, then compute its gain
+        logGain // Compute the gain of the input level, then smooth it in log2 units
+    };
+
+    /** What the detectors listen to (see setSidechain). */
+    enum class Sidechain
+    {
+        off,        // The input, after the input gain
+        mono,       // Sidechain channel 0 drives every channel
+        perChannel, // Sidechain channel k keys channel k, linked as set by setLinkMode
+        linkedSum   // The mean of all sidechain channels drives every channel
+    };
+
+    /** Crossfade applied when the lookahead delay tap moves. */
+    static constexpr float kLookaheadCrossfadeMs = 10.0f;
+
+    /** Ramp time of the input and output gains. */
+    static constexpr double kGainSmoothingSec = 0.02;
+
+    /** Samples run through the whole pipeline at a time (see setSubBlockSize). */
+    static constexpr size_t kDefaultSubBlockSize = 256;
+
+    /** Ramp time of threshold, ratio and knee changes (see setCurveSmoothing). */
+    static constexpr double kCurveSmoothingSec = 0.02;
+
+    /** Level below which input counts as silence (see setSilenceFloorDb). */
+    static constexpr float kDefaultSilenceFloorDb = -100.0f;
+
+    /** Most bands of the multiband mode (see setNumBands). */
+    static constexpr size_t kMaxBands = Crossover::kMaxBands;
+
+    /** Highest oversampling factor (see setOversampling). */
+    static constexpr size_t kMaxOversampling = Oversampler::kMaxFactor;
+
+    Compressor() = default;
+
+    /** Prepare for processing. Allocates all storage used by process().
+        @param sampleRateHz   The sample rate in Hz
+        @param maxBlockSize   Largest block processed in one pass (larger blocks are split)
+        @param numChannels    Number of audio channels
+        @param maxLookaheadMs Largest lookahead, which is also the fixed-mode latency
+    */
+    void prepare(double sampleRateHz, size_t maxBlockSize, size_t numChannels, float maxLookaheadMs)
+    {
+        maxBlockSize_ = std::max<size_t>(maxBlockSize, 1);
+
+        levelEstimator_.setSampleRate(static_cast<float>(sampleRateHz));
+
+        // Sample-based settings depend on the rate, so apply everything again
+        invalidateSettings();
+
+        auto maxLookaheadSamples = static_cast<size_t>(std::max(0.0, maxLookaheadMs * sampleRateHz / 1000.0));
+        lookahead_.prepare(static_cast<float>(sampleRateHz), maxLookaheadSamples);
+
+        // Every band of every channel is a channel of the pipeline
+        numChannels_ = numChannels;
+        size_t numBandChannels = numChannels * kMaxBands;
+
+        delayLines_.resize(numBandChannels);
+        gainDelayLines_.resize(numBandChannels);
+        peakLookaheads_.resize(numBandChannels);
+        levelStates_.resize(numBandChannels);
+        reductionStates_.resize(numBandChannels);
+        channelGroups_.resize(numChannels, 0);
+
+        auto crossfadeSamples = static_cast<size_t>(kLookaheadCrossfadeMs * sampleRateHz / 1000.0);
+
+        // The audio also waits for an oversampled detector
+        size_t maxAudioDelay = maxLookaheadSamples + Oversampler::getMaxUpsamplingLatencySamples();
+
+        for (size_t ch = 0; ch < numBandChannels; ++ch)
+        {
+            delayLines_[ch].prepare(maxAudioDelay, maxBlockSize_);
+            delayLines_[ch].setCrossfadeLength(crossfadeSamples);
+            gainDelayLines_[ch].prepare(maxLookaheadSamples, maxBlockSize_);
+            gainDelayLines_[ch].setCrossfadeLength(crossfadeSamples);
+            peakLookaheads_[ch].prepare(maxLookaheadSamples);
+        }
+
+        levelBuffer_.assign(numBandChannels * maxBlockSize_, 0.0f);
+        gainBuffer_.assign(maxBlockSize_, 0.0f);
+        controlPoints_.assign(maxBlockSize_, 0.0f);
+        controlGains_.assign(numBandChannels, 1.0f);
+        sidechainMix_.assign(maxBlockSize_, 0.0f);
+        inputGainRamp_.assign(maxBlockSize_, 0.0f);
+        outputGainRamp_.assign(maxBlockSize_, 0.0f);
+        detectorInputs_.resize(numBandChannels);
+        detectorOutputs_.resize(numBandChannels);
+        detectorStates_.resize(numBandChannels);
+
+        for (size_t ch = 0; ch < numBandChannels; ++ch)
+            detectorOutputs_[ch] = levelBuffer_.data() + ch * maxBlockSize_;
+
+        crossover_.prepare(sampleRateHz, numChannels);
+        bandBuffer_.assign(numBandChannels * maxBlockSize_, 0.0f);
+        bandChannels_.resize(numBandChannels);
+
+        for (size_t ch = 0; ch < numBandChannels; ++ch)
+            bandChannels_[ch] = bandBuffer_.data() + ch * maxBlockSize_;
+
+        // One stream per pipeline channel, group or detector slot
+        audioOversampler_.prepare(numBandChannels, maxBlockSize_);
+        gainOversampler_.prepare(numBandChannels, maxBlockSize_);
+        detectorOversampler_.prepare(numBandChannels, maxBlockSize_);
+        oversampledAudio_.assign(maxBlockSize_ * kMaxOversampling, 0.0f);
+        oversampledGain_.assign(maxBlockSize_ * kMaxOversampling, 0.0f);
+        peakBuffer_.assign(numBandChannels * maxBlockSize_, 0.0f);
+        paddingBuffer_.assign(numChannels * maxBlockSize_, 0.0f);
+        paddedChannels_.resize(numChannels);
+
+        updateRoutings();
+
+        inputGain_.reset(sampleRateHz, kGainSmoothingSec);
+        outputGain_.reset(sampleRateHz, kGainSmoothingSec);
+        compressionCurve_.setSmoothingTime(sampleRateHz, kCurveSmoothingSec);
+
+        reset();
+    }
+
+    /** Clear all signal state and jump the delays, gains and curve to the current settings. */
+    void reset()
+    {
+        lookahead_.reset();
+
+        // Otherwise the first gains after prepare() would fade in from silence
+        inputGain_.setCurrentAndTargetValue(inputGain_.getTargetValue());
+        outputGain_.setCurrentAndTargetValue(outputGain_.getTargetValue());
+
+        clearSignalState();
+        compressionCurve_.resetSmoothing();
+
+        delaysDirty_ = false;
+        kernelDirty_ = true;
+    }
+
+    /** Channels of the input (see setNumBands for the channels of the pipeline). */
+    size_t getNumChannels() const { return numChannels_; }
+    size_t getMaxBlockSize() const { return maxBlockSize_; }
+
+    /** Set how many samples run through all stages at a time. Output doesn't
+        depend on it (only the metering sums are accumulated in a different
+        order), so it is purely a performance tunable.
+        @param numSamples Sub-block length, or 0 to run whole blocks (up to the prepared maximum)
+    */
+    void setSubBlockSize(size_t numSamples) { subBlockSize_ = numSamples; }
+
+    size_t getSubBlockSize() const { return subBlockSize_; }
+
+    //==============================================================================
+    // Settings (call from the processing thread, between blocks)
+
+    void setLinkMode(LinkMode mode)
+    {
+        kernelDirty_ |= linkMode_ != mode;
+        linkMode_ = mode;
+    }
+
+    LinkMode getLinkMode() const { return linkMode_; }
+
+    /** Assign channels to groups for LinkMode::groups. Allocates; call after
+        prepare() and outside the audio callback.
+        @param groupOfChannel Arbitrary group id per channel (missing channels join group 0)
+    */
+    void setChannelGroups(const std::vector<int>& groupOfChannel)
+    {
+        for (size_t ch = 0; ch < channelGroups_.size(); ++ch)
+            channelGroups_[ch] = ch < groupOfChannel.size() ? groupOfChannel[ch] : 0;
+
+        updateRoutings();
+    }
+
+    /** One detector: its detector channels are at [firstDetector, +numDetectors)
+        and the channels sharing its gain at [firstMember, +numMembers) of the
+        routing's lists. */
+    struct Group
+    {
+        size_t firstDetector = 0;
+        size_t numDetectors = 0;
+        size_t firstMember = 0;
+        size_t numMembers = 0;
+    };
+
+    /** The detector channels and gained channels of every group in one link mode. */
+    struct Routing
+    {
+        std::vector<size_t> detectors; // Channels feeding a detector, grouped
+        std::vector<size_t> members;   // Channels receiving a gain, grouped
+        std::vector<Group> groups;
+    };
+
+    /** Routing of the current link mode (or of the sidechain, see setSidechain).
+        With several bands, channels are numbered band by band (see setNumBands). */
+    const Routing& getRouting() const { return getRouting(getDetectorLinkMode()); }
+
+    /** Number of detectors (and gain signals) used in the given mode. */
+    size_t getNumGroups(LinkMode mode) const { return getRouting(mode).groups.size(); }
+
+    void setInputGainDb(float gainDb)
+    {
+        if (!applied_.inputGainDb.update(gainDb))
+            return;
+
+        inputGain_.setTargetValue(db2Mag(gainDb));
+        ++coefficientUpdates_;
+    }
+
+    void setOutputGainDb(float gainDb)
+    {
+        if (!applied_.outputGainDb.update(gainDb))
+            return;
+
+        outputGain_.setTargetValue(db2Mag(gainDb));
+        compressionCurve_.setMakeupGainDb(gainDb);
+        ++coefficientUpdates_;
+    }
+
+    /** Linear input and output gains, once their ramps have finished. */
+    float getInputGain() const { return inputGain_.getTargetValue(); }
+    float getOutputGain() const { return outputGain_.getTargetValue(); }
+
+    /** Choose how threshold, ratio and knee changes are ramped. Per-sample
+        ramps cost the most but don't step at all; sub-block ramps step in
+        small increments; block mode jumps at the next block.
+    */
+    void setCurveSmoothing(CompressionCurve::Smoothing smoothing)
+    {
+        compressionCurve_.setSmoothing(smoothing);
+        kernelDirty_ |= selectedFlags_ != computeKernelFlags();
+    }
+
+    CompressionCurve::Smoothing getCurveSmoothing() const { return compressionCurve_.getSmoothing(); }
+
+    /** Read the gain computer's curve from a lookup table rebuilt on every
+        threshold, ratio and knee change (see CompressionCurve::setTableLookup).
+        Within CompressionCurve::getTableToleranceDb of the evaluated curve.
+    */
+    void setCurveLookupTable(bool shouldUseTable) { compressionCurve_.setTableLookup(shouldUseTable); }
+
+    bool isCurveLookupTable() const { return compressionCurve_.isTableLookup(); }
+
+    void setThresholdDb(float thresholdDb)
+    {
+        if (!applied_.thresholdDb.update(thresholdDb))
+            return;
+
+        compressionCurve_.setThresholdDb(thresholdDb);
+        ++coefficientUpdates_;
+    }
+
+    void setRatio(float ratio)
+    {
+        if (!applied_.ratio.update(ratio))
+            return;
+
+        compressionCurve_.setCompressionRatio(ratio);
+        kernelDirty_ |= selectedFlags_ != computeKernelFlags();
+        ++coefficientUpdates_;
+    }
+
+    void setKneeWidthDb(float kneeWidthDb)
+    {
+        if (!applied_.kneeWidthDb.update(kneeWidthDb))
+            return;
+
+        compressionCurve_.setKneeWidthDb(kneeWidthDb);
+        kernelDirty_ |= selectedFlags_ != computeKernelFlags();
+        ++coefficientUpdates_;
+    }
+
+    void setAttackTimeMs(float attackTimeMs)
+    {
+        if (!applied_.attackTimeMs.update(attackTimeMs))
+            return;
+
+        levelEstimator_.setAttackTimeMs(attackTimeMs);
+        ++coefficientUpdates_;
+    }
+
+    void setReleaseTimeMs(float releaseTimeMs)
+    {
+        if (!applied_.releaseTimeMs.update(releaseTimeMs))
+            return;
+
+        levelEstimator_.setReleaseTimeMs(releaseTimeMs);
+        ++coefficientUpdates_;
+    }
+
+    void setHoldTimeMs(float holdTimeMs)
+    {
+        if (!applied_.holdTimeMs.update(holdTimeMs))
+            return;
+
+        levelEstimator_.setHoldTimeMs(holdTimeMs);
+        kernelDirty_ |= selectedFlags_ != computeKernelFlags();
+        ++coefficientUpdates_;
+    }
+
+    /** Set the lookahead. Tap changes are crossfaded, starting with the next block. */
+    void setLookaheadMs(float lookaheadMs)
+    {
+        if (!applied_.lookaheadMs.update(lookaheadMs))
+            return;
+
+        lookahead_.setLookaheadMs(lookaheadMs);
+        delaysDirty_ = true;
+        ++coefficientUpdates_;
+    }
+
+    /** Hold the lowest gain of the lookahead window and ramp into it across
+        the window, so transients arrive fully reduced (see PeakLookahead).
+        Has no effect without lookahead.
+    */
+    void setPeakLookahead(bool shouldHoldPeaks)
+    {
+        if (!applied_.peakLookahead.update(shouldHoldPeaks ? 1.0f : 0.0f))
+            return;
+
+        // Starts from the current gain rather than a stale window
+        if (shouldHoldPeaks && !peakLookahead_)
+            for (auto& window : peakLookaheads_)
+                window.reset();
+
+        peakLookahead_ = shouldHoldPeaks;
+        ++coefficientUpdates_;
+    }
+
+    bool isPeakLookahead() const { return peakLookahead_; }
+
+    /** Choose the detector topology.
+
+        Detector::level follows the rectified input with the attack, hold
+        and release, and the curve turns that envelope into a gain.
+        Detector::logGain is the log-domain, smooth-decoupled detector: the
+        curve runs on the rectified input of each sample, and the attack,
+        hold and release smooth the resulting gain reduction in log2 units.
+        Its release is exponential in dB and takes as long from any depth,
+        and it eases into unity gain instead of stopping where the level
+        envelope crosses the knee. The gain computer then runs every sample,
+        whatever setGainDecimation says.
+
+        Switching starts the log gain detector from each group's current
+        gain, and the level detector from silence.
+    */
+    void setDetector(Detector detector)
+    {
+        if (detector == detector_)
+            return;
+
+        if (detector == Detector::logGain)
+        {
+            for (size_t g = 0; g < reductionStates_.size(); ++g)
+            {
+                reductionStates_[g].reset();
+                reductionStates_[g].levelEstimate = -fastLog2(controlGains_[g]);
+            }
+        }
+        else
+        {
+            for (auto& state : levelStates_)
+                state.reset();
+        }
+
+        detector_ = detector;
+    }
+
+    Detector getDetector() const { return detector_; }
+
+    /** Choose what the detectors listen to. With Sidechain::mono and
+        Sidechain::linkedSum one detector drives every channel, whatever the
+        link mode; Sidechain::perChannel keys each channel from the sidechain
+        channel of the same index (wrapping around a narrower sidechain) and
+        links them as usual. The input gain only applies to the input, not
+        to the sidechain. Until setSidechainInputs() provides channels, the
+        detectors listen to the input.
+    */
+    void setSidechain(Sidechain sidechain)
+    {
+        LinkMode previous = getDetectorLinkMode();
+        sidechain_ = sidechain;
+        kernelDirty_ |= getDetectorLinkMode() != previous;
+    }
+
+    Sidechain getSidechain() const { return sidechain_; }
+
+    /** Point the detectors at the host's sidechain buffers for the following
+        process() calls, which read them at the same offsets as the channels
+        and never copy them. Call before every block, since host buffers
+        move.
+        @param sidechain   One pointer per sidechain channel, or nullptr when no sidechain is connected
+        @param numChannels Number of sidechain channels
+    */
+    void setSidechainInputs(const float* const* sidechain, size_t numChannels)
+    {
+        LinkMode previous = getDetectorLinkMode();
+        sidechainInputs_ = sidechain;
+        numSidechainInputs_ = sidechain != nullptr ? numChannels : 0;
+        kernelDirty_ |= getDetectorLinkMode() != previous;
+    }
+
+    /** Whether the detectors currently listen to a sidechain (never with several bands). */
+    bool isSidechainActive() const
+    {
+        return sidechain_ != Sidechain::off && numSidechainInputs_ > 0 && numBands_ == 1;
+    }
+
+    /** Split the input into bands, each compressed on its own, and sum them
+        again at the output (see Crossover). Band b of channel ch runs as
+        channel b * getNumChannels() + ch of the pipeline, so getRouting() and
+        setGainOutputs() have a group for every band. The sidechain and the
+        silence fast path are only used with one band. A change clears the
+        envelopes, delays and filters, as reset() does.
+        @param numBands 1 (broadband) to kMaxBands
+    */
+    void setNumBands(size_t numBands)
+    {
+        numBands = std::max<size_t>(1, std::min(numBands, kMaxBands));
+
+        if (numBands == numBands_)
+            return;
+
+        numBands_ = numBands;
+        crossover_.setNumBands(numBands);
+        clearSignalState();
+        kernelDirty_ = true;
+    }
+
+    size_t getNumBands() const { return numBands_; }
+
+    /** Set the crossover between bands index and index + 1 (see Crossover::setFrequency). */
+    void setCrossoverHz(size_t index, float frequencyHz)
+    {
+        if (index >= applied_.crossoverHz.size() || !applied_.crossoverHz[index].update(frequencyHz))
+            return;
+
+        crossover_.setFrequency(index, frequencyHz);
+        ++coefficientUpdates_;
+    }
+
+    /** Apply the gain at factor times the sample rate (see Oversampler). The
+        gain of each group and the delayed audio of its channels are upsampled,
+        multiplied and downsampled again, so fast gain changes don't alias.
+        The round trip's latency (31 samples at 2x, up to 39 at 8x) is added
+        to the reported latency. A change clears the filters, so like the
+        lookahead it is best not automated.
+        @param factor 1 (off), 2, 4 or 8
+    */
+    void setOversampling(size_t factor)
+    {
+        factor = factor >= 8 ? 8 : factor >= 4 ? 4 : factor >= 2 ? 2 : 1;
+
+        if (!applied_.oversampling.update(static_cast<float>(factor)))
+            return;
+
+        audioOversampler_.setFactor(factor);
+        gainOversampler_.setFactor(factor);
+        detectorOversampler_.setFactor(factor);
+        updateOversamplingLatency();
+        ++coefficientUpdates_;
+    }
+
+    size_t getOversampling() const { return audioOversampler_.getFactor(); }
+
+    /** While oversampling, let the detectors see the peaks of the upsampled
+        input (or sidechain) rather than its samples, so inter-sample peaks
+        are caught. The envelopes and the gain computer still run at the base
+        rate. The audio is delayed by the upsampling latency as well, so the
+        gain keeps its lead on it.
+    */
+    void setOversampledDetection(bool shouldOversample)
+    {
+        if (!applied_.oversampledDetection.update(shouldOversample ? 1.0f : 0.0f))
+            return;
+
+        oversampledDetection_ = shouldOversample;
+        detectorOversampler_.reset();
+        updateOversamplingLatency();
+        ++coefficientUpdates_;
+    }
+
+    bool isOversampledDetection() const { return oversampledDetection_; }
+
+    /** Run the gain computer once every factor samples instead of every sample.
+        The levels are reduced to their maximum over each interval, the curve
+        is evaluated once per interval, and the linear gain ramps from the
+        previous interval's gain to the new one across the interval.
+        Intervals start with every pass (see setSubBlockSize), so the output
+        doesn't depend on the host's block size as long as the factor divides
+        it. While a threshold, ratio or knee change ramps (see
+        setCurveSmoothing), gains are computed every sample.
+        @param factor Samples per gain update (1 = every sample)
+    */
+    void setGainDecimation(size_t factor)
+    {
+        factor = std::max<size_t>(factor, 1);
+
+        if (!applied_.gainDecimation.update(static_cast<float>(factor)))
+            return;
+
+        gainDecimation_ = factor;
+        ++coefficientUpdates_;
+    }
+
+    size_t getGainDecimation() const { return gainDecimation_; }
+
+    /** Keep the reported latency constant while the lookahead changes. */
+    void setFixedLatency(bool shouldUseFixedLatency)
+    {
+        if (!applied_.fixedLatency.update(shouldUseFixedLatency ? 1.0f : 0.0f))
+            return;
+
+        lookahead_.setFixedLatency(shouldUseFixedLatency);
+        delaysDirty_ = true;
+        ++coefficientUpdates_;
+    }
+
+    /** Number of times a setter recomputed coefficients because its value changed. */
+    size_t getNumCoefficientUpdates() const { return coefficientUpdates_; }
+
+    /** Set the silence floor of the fast path. Input below it, after the input
+        gain, counts as silence, and so do envelopes below it or at least 6 dB
+        below the knee, whichever is lower. While skipping, the envelopes
+        release as they would on digital silence (in one step, see
+        LevelEstimator::skipSilence), so the output can only differ from full
+        processing by how an envelope below the floor carries into the next
+        attack.
+        @param floorDb Level in dBFS, or -inf to always run the detector
+    */
+    void setSilenceFloorDb(float floorDb)
+    {
+        silenceFloor_ = db2Mag(floorDb);
+        quietSamples_ = 0;
+    }
+
+    /** Passes (sub-blocks) that skipped the detector and gain computer entirely. */
+    size_t getNumSkippedBlocks() const { return skippedBlocks_; }
+
+    void setLatencySettleTimeMs(float settleTimeMs) { lookahead_.setSettleTimeMs(settleTimeMs); }
+
+    /** Use the general loops for every setting (for benchmarking and verification). */
+    void setKernelSpecialization(bool shouldSpecialize)
+    {
+        specialize_ = shouldSpecialize;
+        kernelDirty_ = true;
+    }
+
+    //==============================================================================
+    // Processing
+
+    /** Process a block in place.
+
+        The block should have the prepared number of channels. If it has
+        fewer, the missing channels are processed as silence, so the ones
+        present are compressed and delayed exactly as in a full block
+        (silent channels never raise a linked detector). If it has more,
+        the prepared channels are processed and the extra ones are cleared,
+        as the engine has no delay to keep them aligned with the rest.
+
+        @param channels      One pointer per channel
+        @param numChannels   Number of channels
+        @param numSamples    Number of samples per channel
+        @param telemetry     Optional metering collector, fed and flushed per pass
+        @param telemetryRing Destination for completed metering frames (required with telemetry)
+    */
+    void process(float* const* channels, size_t numChannels, size_t numSamples,
+                 TelemetryCollector* telemetry = nullptr,
+                 SpscRing<TelemetryFrame>* telemetryRing = nullptr)
+    {
+        if (numChannels == 0 || numChannels_ == 0)
+            return;
+
+        for (size_t ch = numChannels_; ch < numChannels; ++ch)
+            std::fill(channels[ch], channels[ch] + numSamples, 0.0f);
+
+        // The routing addresses every prepared channel, so a short block
+        // runs its passes on silent stand-ins for the missing ones
+        const bool padded = numChannels < numChannels_;
+        size_t passLength = subBlockSize_ > 0 ? std::min(subBlockSize_, maxBlockSize_) : maxBlockSize_;
+
+        for (size_t offset = 0; offset < numSamples; offset += passLength)
+        {
+            size_t passSamples = std::min(passLength, numSamples - offset);
+            float* const* passChannels = channels;
+            size_t passOffset = offset;
+
+            if (padded)
+            {
+                for (size_t ch = 0; ch < numChannels_; ++ch)
+                {
+                    if (ch < numChannels)
+                    {
+                        paddedChannels_[ch] = channels[ch] + offset;
+                    }
+                    else
+                    {
+                        paddedChannels_[ch] = paddingBuffer_.data() + (ch - numChannels) * maxBlockSize_;
+                        std::fill(paddedChannels_[ch], paddedChannels_[ch] + passSamples, 0.0f);
+                    }
+                }
+
+                passChannels = paddedChannels_.data();
+                passOffset = 0;
+            }
+
+            // Both lookahead settings are applied together so that changing
+            // them in the same block doesn't fade through an intermediate tap
+            if (delaysDirty_)
+                updateDelays();
+
+            // Moving audio taps are only handled by kernels with lookahead
+            if (kernelDirty_ || delayLines_[0].isCrossfading())
+                selectKernel();
+
+            // Silence at the start of the pass skips the detector, and the
+            // kernel takes over from the first sample above the floor
+            size_t silentSamples = processSilence(passChannels, numChannels_, passOffset, passSamples, telemetry,
+                                                  telemetryRing);
+
+            if (numBands_ > 1)
+            {
+                gainOutputOffset_ = offset;
+                processBands(passChannels, numChannels_, passOffset, passSamples, telemetry, telemetryRing);
+            }
+            else if (silentSamples < passSamples)
+            {
+                size_t length = passSamples - silentSamples;
+
+                if (telemetry != nullptr)
+                    telemetry->beginBlock(length);
+
+                gainOutputOffset_ = offset + silentSamples;
+                processKernel(passChannels, numChannels_, passOffset + silentSamples, length, telemetry);
+
+                if (telemetry != nullptr)
+                    telemetry->endBlock(*telemetryRing);
+            }
+
+            // A finished curve ramp may allow a cheaper kernel
+            if (compressionCurve_.advanceSmoothing(passSamples))
+                kernelDirty_ = true;
+        }
+    }
+
+    /** Advance latency reporting after a block.
+        @return True if getReportedLatencySamples() changed
+    */
+    bool advanceLatency(size_t numSamples) { return lookahead_.advance(numSamples); }
+
+    size_t getReportedLatencySamples() const { return lookahead_.getReportedLatencySamples(); }
+
+    /** Samples a freshly reset engine must run before its output matches an
+        engine that has been running all along (envelopes within residual of
+        their difference at the start, delay lines filled with real audio).
+        Offline renders split into sections use this as their pre-roll.
+        @param residual Remaining fraction of the initial envelope difference
+    */
+    size_t getSettleSamples(float residual) const
+    {
+        // The peak window depends on the gains of two windows back
+        size_t windowSamples = peakLookahead_ ? 2 * lookahead_.getLookaheadSamples() : 0;
+
+        // At control rate each interval ramps from the previous one's gain
+        return levelEstimator_.getSettleSamples(residual) + lookahead_.getAudioDelaySamples() + windowSamples
+               + (isControlRate() ? gainDecimation_ : 0) + crossover_.getSettleSamples(residual)
+               + lookahead_.getOutputLatency();
+    }
+
+    /** Copy the gain of every group (see getRouting) out of process().
+        Each call then writes its numSamples compression gains from the start
+        of gains[g], aligned with the output (ahead of it by the round trip
+        while oversampling). The input and output gains are not included.
+        @param gains One destination per group, or nullptr to stop copying
+    */
+    void setGainOutputs(float* const* gains) { gainOutputs_ = gains; }
+
+    /** Kernel flags selected for the most recent pass. */
+    unsigned getKernelFlags() const { return selectedFlags_; }
+
+    const CompressionCurve& getCompressionCurve() const { return compressionCurve_; }
+    const LookaheadController& getLookahead() const { return lookahead_; }
+
+private:
+    /** Last value passed to a setter. */
+    struct AppliedValue
+    {
+        float value = 0.0f;
+        bool valid = false;
+
+        /** @return True if the value differs from the last one (or none was applied yet) */
+        bool update(float newValue)
+        {
+            if (valid && value == newValue)
+                return false;
+
+            value = newValue;
+            valid = true;
+            return true;
+        }
+    };
+
+    struct AppliedSettings
+    {
+        AppliedValue inputGainDb;
+        AppliedValue outputGainDb;
+        AppliedValue thresholdDb;
+        AppliedValue ratio;
+        AppliedValue kneeWidthDb;
+        AppliedValue attackTimeMs;
+        AppliedValue releaseTimeMs;
+        AppliedValue holdTimeMs;
+        AppliedValue lookaheadMs;
+        AppliedValue fixedLatency;
+        AppliedValue peakLookahead;
+        AppliedValue gainDecimation;
+        AppliedValue oversampling;
+        AppliedValue oversampledDetection;
+        std::array<AppliedValue, kMaxBands - 1> crossoverHz;
+    };
+
+    void invalidateSettings() { applied_ = AppliedSettings(); }
+
+    //==============================================================================
+    /** Clear the delays, envelopes, gains in flight and crossover filters. */
+    void clearSignalState()
+    {
+        for (auto& delay : delayLines_)
+        {
+            delay.setDelay(lookahead_.getAudioDelaySamples());
+            delay.reset();
+        }
+
+        for (auto& delay : gainDelayLines_)
+        {
+            delay.setDelay(lookahead_.getGainDelaySamples());
+            delay.reset();
+        }
+
+        for (auto& window : peakLookaheads_)
+        {
+            window.setLookahead(lookahead_.getLookaheadSamples());
+            window.reset();
+        }
+
+        for (auto& state : levelStates_)
+            state.reset();
+
+        for (auto& state : reductionStates_)
+            state.reset();
+
+        std::fill(controlGains_.begin(), controlGains_.end(), 1.0f);
+        crossover_.reset();
+        audioOversampler_.reset();
+        gainOversampler_.reset();
+        detectorOversampler_.reset();
+        quietSamples_ = 0;
+    }
+
+    /** Move the audio behind the oversampled detector, and report the round trip. */
+    void updateOversamplingLatency()
+    {
+        bool oversampled = audioOversampler_.getFactor() > 1;
+        bool detection = oversampled && oversampledDetection_;
+
+        lookahead_.setDetectorLatency(detection ? detectorOversampler_.getUpsamplingLatencySamples() : 0);
+        lookahead_.setOutputLatency(oversampled ? audioOversampler_.getLatencySamples() : 0);
+        delaysDirty_ = true;
+    }
+
+    void updateDelays()
+    {
+        for (auto& delay : delayLines_)
+            delay.setDelay(lookahead_.getAudioDelaySamples());
+
+        for (auto& delay : gainDelayLines_)
+            delay.setDelay(lookahead_.getGainDelaySamples());
+
+        for (auto& window : peakLookaheads_)
+            window.setLookahead(lookahead_.getLookaheadSamples());
+
+        delaysDirty_ = false;
+        kernelDirty_ = true;
+    }
+
+    /** Flags of the cheapest loops that are exact for the current settings. */
+    unsigned computeKernelFlags() const
+    {
+        unsigned flags = getDetectorLinkMode() != LinkMode::independent ? kLinked : 0u;
+
+        if (!specialize_)
+            return flags | kSoftKnee | kHold | kLookahead;
+
+        if (compressionCurve_.hasSoftKnee())
+            flags |= kSoftKnee;
+
+        if (compressionCurve_.isInfiniteRatio())
+            flags |= kInfiniteRatio;
+
+        if (levelEstimator_.getHoldTimeSamples() > 0)
+            flags |= kHold;
+
+        if (!delayLines_.empty() && (delayLines_[0].getDelay() > 0 || delayLines_[0].isCrossfading()))
+            flags |= kLookahead;
+
+        return flags;
+    }
+
+    void selectKernel()
+    {
+        selectedFlags_ = computeKernelFlags();
+        kernelDirty_ = false;
+    }
+
+    /** The curve's gains (computeGainKernel) for the selected knee and ratio. */
+    float computeCurveGains(const float* levels, float* gains, size_t numSamples) const
+    {
+        switch (selectedFlags_ & (kSoftKnee | kInfiniteRatio))
+        {
+            case 0:              return compressionCurve_.computeGainKernel<false, false>(levels, gains, numSamples);
+            case kSoftKnee:      return compressionCurve_.computeGainKernel<true, false>(levels, gains, numSamples);
+            case kInfiniteRatio: return compressionCurve_.computeGainKernel<false, true>(levels, gains, numSamples);
+            default:             return compressionCurve_.computeGainKernel<true, true>(levels, gains, numSamples);
+        }
+    }
+
+    /** The curve's log2 gains (computeGainLog2Kernel) for the selected knee and ratio. */
+    float computeCurveGainsLog2(const float* levels, float* gains, size_t numSamples) const
+    {
+        const CompressionCurve& curve = compressionCurve_;
+
+        switch (selectedFlags_ & (kSoftKnee | kInfiniteRatio))
+        {
+            case 0:              return curve.computeGainLog2Kernel<false, false>(levels, gains, numSamples);
+            case kSoftKnee:      return curve.computeGainLog2Kernel<true, false>(levels, gains, numSamples);
+            case kInfiniteRatio: return curve.computeGainLog2Kernel<false, true>(levels, gains, numSamples);
+            default:             return curve.computeGainLog2Kernel<true, true>(levels, gains, numSamples);
+        }
+    }
+
+    /** Envelopes of several detectors at once (estimateLevelMultichannel) for the selected hold. */
+    void estimateLevels(const float* const* inputs, float* const* levels, LevelEstimator::State* const* states,
+                        size_t numDetectors, size_t numSamples) const
+    {
+        if ((selectedFlags_ & kHold) != 0)
+            levelEstimator_.estimateLevelMultichannel<true>(inputs, levels, states, numDetectors, numSamples);
+        else
+            levelEstimator_.estimateLevelMultichannel<false>(inputs, levels, states, numDetectors, numSamples);
+    }
+
+    //==============================================================================
+    // Routing for each link mode, built when the channel count or groups
+    // change, so switching modes on the audio thread never allocates. Every
+    // band count has its own set, so changing bands doesn't allocate either.
+
+    static constexpr size_t kNumLinkModes = 4;
+
+    const Routing& getRouting(LinkMode mode) const
+    {
+        return routings_[numBands_ - 1][static_cast<size_t>(mode)];
+    }
+
+    void updateRoutings()
+    {
+        size_t numChannels = channelGroups_.size();
+        std::array<Routing, kNumLinkModes> broadband;
+
+        // Independent: one group per channel
+        auto& independent = broadband[static_cast<size_t>(LinkMode::independent)];
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            addGroup(independent, { ch }, { ch });
+
+        if (numChannels > 0)
+            addLinkedGroups(broadband, numChannels);
+
+        // Each band repeats the broadband groups on its own channels
+        for (size_t numBands = 1; numBands <= kMaxBands; ++numBands)
+        {
+            for (size_t mode = 0; mode < kNumLinkModes; ++mode)
+            {
+                const Routing& source = broadband[mode];
+                Routing& routing = routings_[numBands - 1][mode];
+                routing = Routing();
+
+                for (size_t band = 0; band < numBands; ++band)
+                {
+                    for (const Group& group : source.groups)
+                    {
+                        std::vector<size_t> detectors(group.numDetectors);
+                        std::vector<size_t> members(group.numMembers);
+
+                        for (size_t k = 0; k < group.numDetectors; ++k)
+                            detectors[k] = source.detectors[group.firstDetector + k] + band * numChannels;
+
+                        for (size_t m = 0; m < group.numMembers; ++m)
+                            members[m] = source.members[group.firstMember + m] + band * numChannels;
+
+                        addGroup(routing, detectors, members);
+                    }
+                }
+            }
+        }
+    }
+
+    /** Routings of the linked modes for numChannels channels. */
+    void addLinkedGroups(std::array<Routing, kNumLinkModes>& routings, size_t numChannels) const
+    {
+        std::vector<size_t> allChannels(numChannels);
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            allChannels[ch] = ch;
+
+        addGroup(routings[static_cast<size_t>(LinkMode::all)], allChannels, allChannels);
+        addGroup(routings[static_cast<size_t>(LinkMode::wChannel)], { 0 }, allChannels);
+
+        // Groups, in order of first appearance
+        auto& grouped = routings[static_cast<size_t>(LinkMode::groups)];
+        std::vector<bool> assigned(numChannels, false);
+
+        for (size_t first = 0; first < numChannels; ++first)
+        {
+            if (assigned[first])
+                continue;
+
+            std::vector<size_t> group;
+            for (size_t ch = first; ch < numChannels; ++ch)
+            {
+                if (channelGroups_[ch] == channelGroups_[first])
+                {
+                    group.push_back(ch);
+                    assigned[ch] = true;
+                }
+            }
+
+            addGroup(grouped, group, group);
+        }
+    }
+
+    static void addGroup(Routing& routing, const std::vector<size_t>& detectors, const std::vector<size_t>& members)
+    {
+        Group group;
+        group.firstDetector = routing.detectors.size();
+        group.numDetectors = detectors.size();
+        group.firstMember = routing.members.size();
+        group.numMembers = members.size();
+
+        routing.detectors.insert(routing.detectors.end(), detectors.begin(), detectors.end());
+        routing.members.insert(routing.members.end(), members.begin(), members.end());
+        routing.groups.push_back(group);
+    }
+
+    /** Per-sample maximum of several level vectors. */
+    static void maxOfLevels(const float* const* levels, size_t numLevels, float* output, size_t numSamples)
+    {
+        std::memcpy(output, levels[0], numSamples * sizeof(float));
+
+        for (size_t k = 1; k < numLevels; ++k)
+        {
+            const float* level = levels[k];
+            size_t i = 0;
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(output + i, SIMD::max(SIMD::load(output + i), SIMD::load(level + i)));
+
+            for (; i < numSamples; ++i)
+                output[i] = std::max(output[i], level[i]);
+        }
+    }
+
+    /** data *= gain, with gain a per-sample ramp or (if ramp is null) a constant. */
+    static void applyGain(float* data, const float* ramp, float gain, size_t numSamples)
+    {
+        size_t i = 0;
+
+        if (ramp != nullptr)
+        {
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(data + i, SIMD::mul(SIMD::load(data + i), SIMD::load(ramp + i)));
+
+            for (; i < numSamples; ++i)
+                data[i] *= ramp[i];
+        }
+        else
+        {
+            SIMD::Float gainVec = SIMD::broadcast(gain);
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(data + i, SIMD::mul(SIMD::load(data + i), gainVec));
+
+            for (; i < numSamples; ++i)
+                data[i] *= gain;
+        }
+    }
+
+    /** data = data * compressionGain * outputGain, with the output gain as in applyGain. */
+    static void applyGains(float* data, const float* compressionGain, const float* ramp, float gain,
+                           size_t numSamples)
+    {
+        size_t i = 0;
+
+        if (ramp != nullptr)
+        {
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(data + i, SIMD::mul(SIMD::mul(SIMD::load(data + i), SIMD::load(compressionGain + i)),
+                                                SIMD::load(ramp + i)));
+
+            for (; i < numSamples; ++i)
+                data[i] = data[i] * compressionGain[i] * ramp[i];
+        }
+        else
+        {
+            SIMD::Float gainVec = SIMD::broadcast(gain);
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(data + i, SIMD::mul(SIMD::mul(SIMD::load(data + i), SIMD::load(compressionGain + i)),
+                                                gainVec));
+
+            for (; i < numSamples; ++i)
+                data[i] = data[i] * compressionGain[i] * gain;
+        }
+    }
+
+    /** Render a smoother for one pass.
+        @return The ramp, or nullptr if the gain is constant (use getTargetValue())
+    */
+    static const float* renderRamp(LinearSmoother& smoother, std::vector<float>& ramp, size_t numSamples)
+    {
+        if (!smoother.isSmoothing())
+            return nullptr;
+
+        smoother.getNextValues(ramp.data(), numSamples);
+        return ramp.data();
+    }
+
+    //==============================================================================
+    // Silence fast path
+
+    /** Samples from the start of data that are at most limit in magnitude. */
+    static size_t getSilentLength(const float* data, size_t numSamples, float limit)
+    {
+        constexpr size_t kChunkSize = 64;
+
+        for (size_t start = 0; start < numSamples; start += kChunkSize)
+        {
+            size_t end = std::min(start + kChunkSize, numSamples);
+            size_t i = start;
+
+            if (end - start == kChunkSize)
+            {
+                SIMD::Float peak = SIMD::broadcast(0.0f);
+
+                for (; i < end; i += SIMD::kWidth)
+                    peak = SIMD::max(peak, SIMD::abs(SIMD::load(data + i)));
+
+                if (SIMD::reduceMax(peak) <= limit)
+                    continue;
+            }
+
+            for (i = start; i < end; ++i)
+                if (std::fabs(data[i]) > limit)
+                    return i;
+        }
+
+        return numSamples;
+    }
+
+    /** Groups of the kernel's routing. */
+    size_t getNumActiveGroups() const
+    {
+        return getNumGroups((selectedFlags_ & kLinked) != 0 ? getDetectorLinkMode() : LinkMode::independent);
+    }
+
+    /** Whether the engine could skip the detector if the input were silent:
+        nothing ramps or crossfades, and every envelope is below the level at
+        which the curve gives exactly unity gain (with 6 dB to spare for
+        fastLog2). The knee starts at threshold - knee / 2.
+        @return The envelope limit, or 0 if the engine must run the kernel
+    */
+    float getRestingLevel() const
+    {
+        if (silenceFloor_ <= 0.0f || inputGain_.isSmoothing() || outputGain_.isSmoothing()
+            || compressionCurve_.isSmoothing() || delayLines_[0].isCrossfading()
+            || gainDelayLines_[0].isCrossfading())
+            return 0.0f;
+
+        const auto& curve = compressionCurve_.getTargetCoefficients();
+        float level = std::min(silenceFloor_, fastExp2(curve.thresholdLog2 - curve.halfKneeLog2 - 1.0f));
+
+        if (detector_ == Detector::logGain)
+        {
+            // The input level is the envelope; each group's reduction must be gone
+            for (size_t g = 0; g < getNumActiveGroups(); ++g)
+                if (reductionStates_[g].levelEstimate > kRestingReductionLog2)
+                    return 0.0f;
+
+            return level;
+        }
+
+        for (const auto& state : levelStates_)
+            if (state.levelEstimate > level)
+                return 0.0f;
+
+        return level;
+    }
+
+    /** Run the silent start of a pass without the detector and gain computer.
+
+        Each quiet sample (at rest, silent input) produces a unity gain, and
+        the gain applied at the output was computed up to the gain delay plus
+        three peak windows earlier (see PeakLookahead::skipUnity), plus a
+        control interval, whose ramp starts from the previous interval's
+        gain. Once that many quiet samples have gone by, every gain in
+        flight is unity, so the output is the delayed audio times the input
+        and output gains, exactly as the kernel would make it.
+
+        @return Samples handled from the start of the pass
+    */
+    size_t processSilence(float* const* channels, size_t numChannels, size_t offset, size_t numSamples,
+                          TelemetryCollector* telemetry, SpscRing<TelemetryFrame>* telemetryRing)
+    {
+        float restingLevel = getRestingLevel();
+
+        // The crossover and the oversampling filters ring on after the input
+        // falls silent, so bands and oversampling always run
+        if (restingLevel <= 0.0f || numBands_ > 1 || audioOversampler_.getFactor() > 1)
+        {
+            quietSamples_ = 0;
+            return 0;
+        }
+
+        float inputGain = inputGain_.getTargetValue();
+        float outputGain = outputGain_.getTargetValue();
+
+        // The envelopes follow the input after the input gain, or the
+        // sidechain (its mean is silent wherever all of its channels are)
+        size_t silentSamples = numSamples;
+
+        if (isSidechainActive())
+        {
+            size_t numKeys = sidechain_ == Sidechain::mono ? 1 : numSidechainInputs_;
+
+            for (size_t k = 0; k < numKeys && silentSamples > 0; ++k)
+                silentSamples = getSilentLength(sidechainInputs_[k] + offset, silentSamples, restingLevel);
+        }
+        else
+        {
+            float limit = inputGain > 0.0f ? restingLevel / inputGain : positiveInfinity<float>();
+
+            for (size_t ch = 0; ch < numChannels && silentSamples > 0; ++ch)
+                silentSamples = getSilentLength(channels[ch] + offset, silentSamples, limit);
+        }
+
+        size_t windowSamples = peakLookahead_ ? 3 * (lookahead_.getLookaheadSamples() + 1) : 0;
+        size_t intervalSamples = isControlRate() ? gainDecimation_ : 0;
+        bool flushed = quietSamples_ >= gainDelayLines_[0].getDelay() + windowSamples + intervalSamples;
+
+        quietSamples_ = silentSamples < numSamples ? 0 : quietSamples_ + numSamples;
+
+        if (!flushed || silentSamples == 0)
+            return 0;
+
+        if (telemetry != nullptr)
+            telemetry->beginBlock(silentSamples);
+
+        bool lookahead = (selectedFlags_ & kLookahead) != 0;
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            float* channelData = channels[ch] + offset;
+
+            applyGain(channelData, nullptr, inputGain, silentSamples);
+
+            if (telemetry != nullptr)
+                telemetry->addInput(channelData);
+
+            if (lookahead)
+                delayLines_[ch].processInPlace(channelData, silentSamples);
+            else
+                delayLines_[ch].write(channelData, silentSamples);
+
+            applyGain(channelData, nullptr, outputGain, silentSamples);
+
+            if (telemetry != nullptr)
+                telemetry->addOutput(channelData);
+        }
+
+        // Everything else advances as if it had processed the silence
+        size_t numGroups = getNumActiveGroups();
+
+        if (detector_ == Detector::logGain)
+        {
+            for (size_t g = 0; g < numGroups; ++g)
+                levelEstimator_.skipSilence(reductionStates_[g], silentSamples);
+        }
+        else
+        {
+            for (auto& state : levelStates_)
+                levelEstimator_.skipSilence(state, silentSamples);
+        }
+
+        std::fill(gainBuffer_.begin(), gainBuffer_.begin() + static_cast<std::ptrdiff_t>(silentSamples), 1.0f);
+
+        for (size_t g = 0; g < numGroups; ++g)
+        {
+            if (peakLookahead_)
+                peakLookaheads_[g].skipUnity(silentSamples);
+
+            controlGains_[g] = 1.0f;
+
+            gainDelayLines_[g].write(gainBuffer_.data(), silentSamples);
+
+            if (gainOutputs_ != nullptr)
+                std::memcpy(gainOutputs_[g] + offset, gainBuffer_.data(), silentSamples * sizeof(float));
+
+            if (telemetry != nullptr)
+                telemetry->addGain(gainBuffer_.data());
+        }
+
+        if (telemetry != nullptr)
+            telemetry->endBlock(*telemetryRing);
+
+        if (silentSamples == numSamples)
+            ++skippedBlocks_;
+
+        return silentSamples;
+    }
+
+    //==============================================================================
+    // Multiband
+
+    /** One pass with several bands: the input gain, the crossover, the kernel
+        on every band of every channel, and the output gain on their sum. */
+    void processBands(float* const* channels, size_t numChannels, size_t offset, size_t numSamples,
+                      TelemetryCollector* telemetry, SpscRing<TelemetryFrame>* telemetryRing)
+    {
+        if (telemetry != nullptr)
+            telemetry->beginBlock(numSamples);
+
+        const float* inputRamp = renderRamp(inputGain_, inputGainRamp_, numSamples);
+        float inputGain = inputGain_.getTargetValue();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            float* channelData = channels[ch] + offset;
+
+            applyGain(channelData, inputRamp, inputGain, numSamples);
+
+            if (telemetry != nullptr)
+                telemetry->addInput(channelData);
+        }
+
+        crossover_.process(channels, offset, bandChannels_.data(), numSamples);
+
+        processKernel(bandChannels_.data(), numChannels_ * numBands_, 0, numSamples, telemetry);
+
+        const float* outputRamp = renderRamp(outputGain_, outputGainRamp_, numSamples);
+        float outputGain = outputGain_.getTargetValue();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            float* channelData = channels[ch] + offset;
+            std::memcpy(channelData, bandChannels_[ch], numSamples * sizeof(float));
+
+            for (size_t band = 1; band < numBands_; ++band)
+            {
+                const float* bandData = bandChannels_[band * numChannels_ + ch];
+                size_t i = 0;
+
+                for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                    SIMD::store(channelData + i, SIMD::add(SIMD::load(channelData + i), SIMD::load(bandData + i)));
+
+                for (; i < numSamples; ++i)
+                    channelData[i] += bandData[i];
+            }
+
+            applyGain(channelData, outputRamp, outputGain, numSamples);
+
+            if (telemetry != nullptr)
+                telemetry->addOutput(channelData);
+        }
+
+        if (telemetry != nullptr)
+            telemetry->endBlock(*telemetryRing);
+    }
+
+    //==============================================================================
+    // Oversampling
+
+    /** Upsample a group's gain into oversampledGain_. The filters ring around
+        steps, so it is kept within [0, 1]. */
+    void upsampleGain(size_t group, const float* gains, size_t numSamples)
+    {
+        float* data = oversampledGain_.data();
+        size_t length = numSamples * gainOversampler_.getFactor();
+
+        gainOversampler_.upsample(group, gains, data, numSamples);
+
+        SIMD::Float zero = SIMD::broadcast(0.0f);
+        SIMD::Float one = SIMD::broadcast(1.0f);
+        size_t i = 0;
+
+        for (; i + SIMD::kWidth <= length; i += SIMD::kWidth)
+            SIMD::store(data + i, SIMD::min(SIMD::max(SIMD::load(data + i), zero), one));
+
+        for (; i < length; ++i)
+            data[i] = std::min(std::max(data[i], 0.0f), 1.0f);
+    }
+
+    /** Multiply a channel by the upsampled gain (see upsampleGain) at the oversampled rate. */
+    void applyOversampledGain(size_t ch, float* data, size_t numSamples)
+    {
+        float* audio = oversampledAudio_.data();
+        const float* gains = oversampledGain_.data();
+        size_t length = numSamples * audioOversampler_.getFactor();
+
+        audioOversampler_.upsample(ch, data, audio, numSamples);
+
+        size_t i = 0;
+
+        for (; i + SIMD::kWidth <= length; i += SIMD::kWidth)
+            SIMD::store(audio + i, SIMD::mul(SIMD::load(audio + i), SIMD::load(gains + i)));
+
+        for (; i < length; ++i)
+            audio[i] *= gains[i];
+
+        audioOversampler_.downsample(ch, audio, data, numSamples);
+    }
+
+    //==============================================================================
+    // Log gain detector
+
+    /** Per-sample maximum magnitude of several signals. */
+    static void maxOfMagnitudes(const float* const* inputs, size_t numInputs, float* output, size_t numSamples)
+    {
+        const float* first = inputs[0];
+        size_t i = 0;
+
+        for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            SIMD::store(output + i, SIMD::abs(SIMD::load(first + i)));
+
+        for (; i < numSamples; ++i)
+            output[i] = std::fabs(first[i]);
+
+        for (size_t k = 1; k < numInputs; ++k)
+        {
+            const float* data = inputs[k];
+
+            for (i = 0; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(output + i, SIMD::max(SIMD::load(output + i), SIMD::abs(SIMD::load(data + i))));
+
+            for (; i < numSamples; ++i)
+                output[i] = std::max(output[i], std::fabs(data[i]));
+        }
+    }
+
+    /** Linear gains of smoothed reductions in log2 units: 2^-reduction. */
+    static void reductionsToGains(const float* reductions, float* gains, size_t numSamples)
+    {
+        const SIMD::Float zero = SIMD::broadcast(0.0f);
+        size_t i = 0;
+
+        for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            SIMD::store(gains + i, fastExp2(SIMD::sub(zero, SIMD::load(reductions + i))));
+
+        for (; i < numSamples; ++i)
+            gains[i] = fastExp2(0.0f - reductions[i]);
+    }
+
+    /** Smoothed gain reduction of every group, in log2 units, into the
+        group's detector buffer. The curve's log2 gains are zero or negative,
+        so the detector's rectifier turns them into reductions, and its
+        attack follows a growing reduction.
+        @param inputs Signal of every detector slot of the routing (see getDetectorInput)
+    */
+    void estimateReductions(const Routing& routing, const float* const* inputs, size_t numSamples)
+    {
+        size_t numGroups = routing.groups.size();
+
+        for (size_t g = 0; g < numGroups; ++g)
+        {
+            const Group& group = routing.groups[g];
+            float* reductions = detectorOutputs_[g];
+
+            maxOfMagnitudes(inputs + group.firstDetector, group.numDetectors, reductions, numSamples);
+            computeCurveGainsLog2(reductions, reductions, numSamples);
+
+            detectorStates_[g] = &reductionStates_[g];
+        }
+
+        // In place, one group per lane
+        estimateLevels(detectorOutputs_.data(), detectorOutputs_.data(), detectorStates_.data(), numGroups,
+                       numSamples);
+    }
+
+    //==============================================================================
+    // Sidechain
+
+    /** Link mode of the detectors: a mono or summed sidechain is one detector
+        on slot 0 driving every channel, like the W channel. */
+    LinkMode getDetectorLinkMode() const
+    {
+        if (isSidechainActive() && sidechain_ != Sidechain::perChannel)
+            return LinkMode::wChannel;
+
+        return linkMode_;
+    }
+
+    /** The signal detector channel ch reads in this pass: the channel itself,
+        or (see setSidechain) the host's sidechain buffer or its mix. */
+    const float* getDetectorInput(float* const* channels, size_t ch, size_t offset) const
+    {
+        if (!isSidechainActive())
+            return channels[ch] + offset;
+
+        switch (sidechain_)
+        {
+            case Sidechain::mono:      return sidechainInputs_[0] + offset;
+            case Sidechain::linkedSum: return sidechainMix_.data();
+            default:                   return sidechainInputs_[ch % numSidechainInputs_] + offset;
+        }
+    }
+
+    /** Mean of all sidechain channels into sidechainMix_. */
+    void mixSidechain(size_t offset, size_t numSamples)
+    {
+        float* output = sidechainMix_.data();
+        const float* first = sidechainInputs_[0] + offset;
+        std::memcpy(output, first, numSamples * sizeof(float));
+
+        if (numSidechainInputs_ == 1)
+            return;
+
+        for (size_t k = 1; k < numSidechainInputs_; ++k)
+        {
+            const float* data = sidechainInputs_[k] + offset;
+            size_t i = 0;
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                SIMD::store(output + i, SIMD::add(SIMD::load(output + i), SIMD::load(data + i)));
+
+            for (; i < numSamples; ++i)
+                output[i] += data[i];
+        }
+
+        applyGain(output, nullptr, 1.0f / static_cast<float>(numSidechainInputs_), numSamples);
+    }
+
+    //==============================================================================
+    // Control-rate gain computer
+
+    /** Whether the gain computer runs at control rate (see setGainDecimation). */
+    bool isControlRate() const { return gainDecimation_ > 1 && detector_ == Detector::level; }
+
+    /** Largest of numSamples values. */
+    static float maxOf(const float* data, size_t numSamples)
+    {
+        size_t i = 0;
+        float result = 0.0f;
+
+        if (numSamples >= SIMD::kWidth)
+        {
+            SIMD::Float maxVec = SIMD::load(data);
+
+            for (i = SIMD::kWidth; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+                maxVec = SIMD::max(maxVec, SIMD::load(data + i));
+
+            result = SIMD::reduceMax(maxVec);
+        }
+
+        for (; i < numSamples; ++i)
+            result = std::max(result, data[i]);
+
+        return result;
+    }
+
+    /** Gains at control rate (see setGainDecimation).
+        @param levels   Levels of the pass (may alias gains)
+        @param gains    Linear gains of the pass
+        @param previous Gain at the end of the previous interval
+    */
+    void computeControlRateGains(const float* levels, float* gains, size_t numSamples, float previous)
+    {
+        const size_t factor = gainDecimation_;
+        const size_t numPoints = (numSamples + factor - 1) / factor;
+        float* points = controlPoints_.data();
+
+        for (size_t k = 0; k < numPoints; ++k)
+            points[k] = maxOf(levels + k * factor, std::min(factor, numSamples - k * factor));
+
+        computeCurveGains(points, points, numPoints);
+
+        // Each interval ramps onto its point, reaching it exactly on its last sample
+        for (size_t k = 0; k < numPoints; ++k)
+        {
+            size_t start = k * factor;
+            size_t length = std::min(factor, numSamples - start);
+            float invLength = 1.0f / static_cast<float>(length);
+            float delta = points[k] - previous;
+
+            for (size_t j = 0; j + 1 < length; ++j)
+                gains[start + j] = previous + delta * (static_cast<float>(j + 1) * invLength);
+
+            gains[start + length - 1] = points[k];
+            previous = points[k];
+        }
+    }
+
+    //==============================================================================
+    void processKernel(float* const* channels, size_t numChannels, size_t offset, size_t numSamples,
+                       TelemetryCollector* telemetry)
+    {
+        const bool linked = (selectedFlags_ & kLinked) != 0;
+        const bool lookahead = (selectedFlags_ & kLookahead) != 0;
+
+        const Routing& routing = getRouting(linked ? getDetectorLinkMode() : LinkMode::independent);
+        float* gainData = gainBuffer_.data();
+
+        // With several bands the channels are bands, and processBands applies
+        // the input and output gains and meters the audio around the crossover
+        const bool bands = numBands_ > 1;
+        TelemetryCollector* audioTelemetry = bands ? nullptr : telemetry;
+
+        // The input and output gain ramps are rendered once and shared by
+        // every channel, so all channels see the same point on the ramp
+        const float* inputRamp = bands ? nullptr : renderRamp(inputGain_, inputGainRamp_, numSamples);
+        const float* outputRamp = bands ? nullptr : renderRamp(outputGain_, outputGainRamp_, numSamples);
+        float inputGain = bands ? 1.0f : inputGain_.getTargetValue();
+        float outputGain = bands ? 1.0f : outputGain_.getTargetValue();
+
+        // Phase 1: Apply input gain
+        for (size_t ch = 0; ch < numChannels && !bands; ++ch)
+        {
+            float* channelData = channels[ch] + offset;
+
+            applyGain(channelData, inputRamp, inputGain, numSamples);
+
+            if (audioTelemetry != nullptr)
+                audioTelemetry->addInput(channelData);
+        }
+
+        // Phase 2: Estimate the levels of every detector channel at once, or
+        // (log gain detector) the smoothed reductions of every group
+        const bool logGain = detector_ == Detector::logGain;
+        size_t numDetectors = routing.detectors.size();
+
+        if (isSidechainActive() && sidechain_ == Sidechain::linkedSum)
+            mixSidechain(offset, numSamples);
+
+        for (size_t k = 0; k < numDetectors; ++k)
+            detectorInputs_[k] = getDetectorInput(channels, routing.detectors[k], offset);
+
+        // Inter-sample peaks, which lag the input as much as the audio delay adds
+        const bool oversampled = audioOversampler_.getFactor() > 1;
+
+        if (oversampled && oversampledDetection_)
+        {
+            for (size_t k = 0; k < numDetectors; ++k)
+            {
+                float* peaks = peakBuffer_.data() + k * maxBlockSize_;
+                detectorOversampler_.upsamplePeaks(routing.detectors[k], detectorInputs_[k], peaks, numSamples);
+                detectorInputs_[k] = peaks;
+            }
+        }
+
+        if (logGain)
+        {
+            estimateReductions(routing, detectorInputs_.data(), numSamples);
+        }
+        else
+        {
+            for (size_t k = 0; k < numDetectors; ++k)
+                detectorStates_[k] = &levelStates_[routing.detectors[k]];
+
+            estimateLevels(detectorInputs_.data(), detectorOutputs_.data(), detectorStates_.data(), numDetectors,
+                           numSamples);
+        }
+
+        // Phase 3: Compute each group's gain and apply it to its channels
+        for (size_t g = 0; g < routing.groups.size(); ++g)
+        {
+            const Group& group = routing.groups[g];
+
+            if (logGain)
+            {
+                reductionsToGains(detectorOutputs_[g], gainData, numSamples);
+            }
+            else
+            {
+                const float* levelData = detectorOutputs_[group.firstDetector];
+
+                if (linked && group.numDetectors > 1)
+                {
+                    // Linked channels follow the loudest detector
+                    maxOfLevels(detectorOutputs_.data() + group.firstDetector, group.numDetectors,
+                                gainData, numSamples);
+                    levelData = gainData;
+                }
+
+                if (isControlRate() && !compressionCurve_.isSmoothing())
+                    computeControlRateGains(levelData, gainData, numSamples, controlGains_[g]);
+                else
+                    computeCurveGains(levelData, gainData, numSamples);
+            }
+
+            controlGains_[g] = gainData[numSamples - 1];
+
+            if (peakLookahead_)
+                peakLookaheads_[g].process(gainData, numSamples);
+
+            // Align the gain with the audio (fixed latency mode only)
+            gainDelayLines_[g].processInPlace(gainData, numSamples);
+
+            if (gainOutputs_ != nullptr)
+                std::memcpy(gainOutputs_[g] + gainOutputOffset_, gainData, numSamples * sizeof(float));
+
+            if (telemetry != nullptr)
+                telemetry->addGain(gainData);
+
+            if (oversampled)
+                upsampleGain(g, gainData, numSamples);
+
+            for (size_t m = 0; m < group.numMembers; ++m)
+            {
+                size_t ch = routing.members[group.firstMember + m];
+                float* channelData = channels[ch] + offset;
+
+                // Without lookahead the delayed signal is the input itself; only
+                // the history is kept so that enabling lookahead fades in real audio
+                if (lookahead)
+                    delayLines_[ch].processInPlace(channelData, numSamples);
+                else
+                    delayLines_[ch].write(channelData, numSamples);
+
+                if (oversampled)
+                {
+                    applyOversampledGain(ch, channelData, numSamples);
+                    applyGain(channelData, outputRamp, outputGain, numSamples);
+                }
+                else
+                {
+                    applyGains(channelData, gainData, outputRamp, outputGain, numSamples);
+                }
+
+                if (audioTelemetry != nullptr)
+                    audioTelemetry->addOutput(channelData);
+            }
+        }
+    }
+
+    //==============================================================================
+    /** Largest smoothed reduction (log2 units) whose gain fastExp2 rounds to
+        exactly unity, so a group below it is at rest. */
+    static constexpr float kRestingReductionLog2 = 1.0e-9f;
+
+    size_t maxBlockSize_ = 1;
+    size_t numChannels_ = 0;
+    size_t subBlockSize_ = kDefaultSubBlockSize;
+    LinkMode linkMode_ = LinkMode::all;
+
+    LevelEstimator levelEstimator_;
+    CompressionCurve compressionCurve_;
+    LookaheadController lookahead_;
+    std::vector<DelayLine> delayLines_;
+    std::vector<DelayLine> gainDelayLines_;
+    std::vector<PeakLookahead> peakLookaheads_;  // One per group (at most one per channel)
+    std::vector<LevelEstimator::State> levelStates_;
+    std::vector<LevelEstimator::State> reductionStates_;  // One per group (log gain detector)
+    Detector detector_ = Detector::level;
+
+    // Sidechain: the host's buffers (never copied) and the mix of linkedSum
+    Sidechain sidechain_ = Sidechain::off;
+    const float* const* sidechainInputs_ = nullptr;
+    size_t numSidechainInputs_ = 0;
+    std::vector<float> sidechainMix_;
+
+    // Channel routing per link mode
+    std::vector<int> channelGroups_;
+    std::array<std::array<Routing, kNumLinkModes>, kMaxBands> routings_;  // [bands - 1][mode]
+
+    // Detector scratch: one level buffer per detector slot
+    std::vector<float> levelBuffer_;
+    std::vector<float> gainBuffer_;
+    std::vector<float> inputGainRamp_;
+    std::vector<float> outputGainRamp_;
+    std::vector<const float*> detectorInputs_;
+    std::vector<float*> detectorOutputs_;
+    std::vector<LevelEstimator::State*> detectorStates_;
+    float* const* gainOutputs_ = nullptr;
+    size_t gainOutputOffset_ = 0;  // Where the kernel's gains go in gainOutputs_ (band buffers start at 0)
+
+    // Short blocks: the block's channels and silent stand-ins for the rest
+    std::vector<float> paddingBuffer_;
+    std::vector<float*> paddedChannels_;
+
+    // Multiband: the crossover and one pass of every band of every channel
+    size_t numBands_ = 1;
+    Crossover crossover_;
+    std::vector<float> bandBuffer_;
+    std::vector<float*> bandChannels_;
+
+    // Oversampling: the audio of each channel, the gain of each group and the
+    // input of each detector slot, with one pass of gain and audio at the high rate
+    Oversampler audioOversampler_;
+    Oversampler gainOversampler_;
+    Oversampler detectorOversampler_;
+    bool oversampledDetection_ = false;
+    std::vector<float> oversampledAudio_;
+    std::vector<float> oversampledGain_;
+    std::vector<float> peakBuffer_;
+
+    LinearSmoother inputGain_;
+    LinearSmoother outputGain_;
+
+    // Change detection for the setters
+    AppliedSettings applied_;
+    size_t coefficientUpdates_ = 0;
+
+    bool peakLookahead_ = false;
+
+    // Control-rate gain computer: one point per interval, and each group's last gain
+    size_t gainDecimation_ = 1;
+    std::vector<float> controlPoints_;
+    std::vector<float> controlGains_;
+
+    // Silence fast path
+    float silenceFloor_ = db2Mag(kDefaultSilenceFloorDb);
+    size_t quietSamples_ = 0;   // Consecutive samples at rest with silent input
+    size_t skippedBlocks_ = 0;
+
+    // Kernel dispatch
+    bool delaysDirty_ = false;
+    bool specialize_ = true;
+    bool kernelDirty_ = true;
+    unsigned selectedFlags_ = 0;
+};
+
+} // namespace DSP
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Compressor.h"
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace DSP
+{
+
+/**
+    The plugin's parameter values in plugin units, independent of JUCE.
+
+    The plugin fills this from its parameter tree and offline tools fill it
+    from a saved plugin state, and both hand it to the engine through
+    applyTo(). Keeping the one mapping here is what makes offline renders
+    match the plugin. IDs, choice indices and defaults follow Parameters.h.
+*/
+struct CompressorSettings
+{
+    bool linked = true;
+    bool bypass = false;
+    float inputGainDb = 0.0f;
+    float thresholdDb = 0.0f;
+    float ratio = 1.0f;
+    float kneeWidthDb = 0.0f;
+    float outputGainDb = 0.0f;
+    float attackTimeMs = 0.0f;
+    float releaseTimeMs = 100.0f;
+    float holdTimeMs = 0.0f;
+    float lookaheadTimeMs = 0.0f;
+    bool fixedLatency = false;
+    bool peakLookahead = false;
+    int linkMode = 0;        // Index into Parameters::Choices::linkMode
+    int curveSmoothing = 3;  // Index into Parameters::Choices::curveSmoothing
+    int gainRate = 0;        // Index into Parameters::Choices::gainRate
+    int detector = 0;        // Index into Parameters::Choices::detector
+    int sidechain = 0;       // Index into Parameters::Choices::sidechain
+    int bands = 0;           // Index into Parameters::Choices::bands
+    int oversampling = 0;    // Index into Parameters::Choices::oversampling
+    bool oversampledDetection = false;
+    std::array<float, 4> crossoverHz{ { 150.0f, 800.0f, 3000.0f, 8000.0f } };
+
+    //==============================================================================
+    /** Set a value by parameter ID, as stored in the plugin state.
+        Booleans and choices use the same numbers as the plugin parameters.
+        @return False if the ID is unknown
+    */
+    bool set(const std::string& id, float value)
+    {
+        if (id == "linked")              linked = value > 0.5f;
+        else if (id == "bypass")         bypass = value > 0.5f;
+        else if (id == "inputGain")      inputGainDb = value;
+        else if (id == "threshold")      thresholdDb = value;
+        else if (id == "ratio")          ratio = value;
+        else if (id == "kneeWidth")      kneeWidthDb = value;
+        else if (id == "outputGain")     outputGainDb = value;
+        else if (id == "attackTime")     attackTimeMs = value;
+        else if (id == "releaseTime")    releaseTimeMs = value;
+        else if (id == "holdTime")       holdTimeMs = value;
+        else if (id == "lookaheadTime")  lookaheadTimeMs = value;
+        else if (id == "fixedLatency")   fixedLatency = value > 0.5f;
+        else if (id == "peakLookahead")  peakLookahead = value > 0.5f;
+        else if (id == "linkMode")       linkMode = static_cast<int>(value);
+        else if (id == "curveSmoothing") curveSmoothing = static_cast<int>(value);
+        else if (id == "gainRate")       gainRate = static_cast<int>(value);
+        else if (id == "detector")       detector = static_cast<int>(value);
+        else if (id == "sidechain")      sidechain = static_cast<int>(value);
+        else if (id == "bands")          bands = static_cast<int>(value);
+        else if (id == "crossover1")     crossoverHz[0] = value;
+        else if (id == "crossover2")     crossoverHz[1] = value;
+        else if (id == "crossover3")     crossoverHz[2] = value;
+        else if (id == "crossover4")     crossoverHz[3] = value;
+        else if (id == "oversampling")   oversampling = static_cast<int>(value);
+        else if (id == "oversampledDetection") oversampledDetection = value > 0.5f;
+        else                             return false;
+
+        return true;
+    }
+
+    //==============================================================================
+    Compressor::LinkMode getLinkMode() const
+    {
+        using LinkMode = Compressor::LinkMode;
+
+        if (!linked)
+            return LinkMode::independent;
+
+        switch (linkMode)
+        {
+            case 1:  return LinkMode::groups;
+            case 2:  return LinkMode::wChannel;
+            default: return LinkMode::all;
+        }
+    }
+
+    CompressionCurve::Smoothing getCurveSmoothing() const
+    {
+        using Smoothing = CompressionCurve::Smoothing;
+
+        switch (curveSmoothing)
+        {
+            case 0:  return Smoothing::block;
+            case 1:  return Smoothing::subBlock32;
+            case 2:  return Smoothing::subBlock16;
+            default: return Smoothing::perSample;
+        }
+    }
+
+    Compressor::Detector getDetector() const
+    {
+        return detector == 1 ? Compressor::Detector::logGain : Compressor::Detector::level;
+    }
+
+    Compressor::Sidechain getSidechain() const
+    {
+        using Sidechain = Compressor::Sidechain;
+
+        switch (sidechain)
+        {
+            case 1:  return Sidechain::mono;
+            case 2:  return Sidechain::perChannel;
+            case 3:  return Sidechain::linkedSum;
+            default: return Sidechain::off;
+        }
+    }
+
+    /** Bands of the multiband mode (1 is broadband). */
+    size_t getNumBands() const { return static_cast<size_t>(std::max(0, std::min(bands, 4))) + 1; }
+
+    /** Rate factor of the gain (see Compressor::setOversampling). */
+    size_t getOversampling() const { return size_t(1) << std::max(0, std::min(oversampling, 3)); }
+
+    /** Samples per gain computer update (see Compressor::setGainDecimation). */
+    size_t getGainDecimation() const
+    {
+        switch (gainRate)
+        {
+            case 1:  return 8;
+            case 2:  return 16;
+            case 3:  return 32;
+            default: return 1;
+        }
+    }
+
+    //==============================================================================
+    /** Hand every setting to the engine. Unchanged values cost nothing, so
+        this can be called whenever any parameter moved. Bypass is left to
+        the caller.
+    */
+    void applyTo(Compressor& compressor) const
+    {
+        compressor.setLinkMode(getLinkMode());
+        compressor.setSidechain(getSidechain());
+        compressor.setNumBands(getNumBands());
+
+        for (size_t k = 0; k < crossoverHz.size(); ++k)
+            compressor.setCrossoverHz(k, crossoverHz[k]);
+
+        // Before the curve settings, so that their changes ramp in the new mode
+        compressor.setCurveSmoothing(getCurveSmoothing());
+
+        // Update level estimator
+        compressor.setDetector(getDetector());
+        compressor.setAttackTimeMs(attackTimeMs);
+        compressor.setReleaseTimeMs(releaseTimeMs);
+        compressor.setHoldTimeMs(holdTimeMs);
+
+        // Update compression curve
+        compressor.setThresholdDb(thresholdDb);
+        compressor.setRatio(ratio);
+        compressor.setKneeWidthDb(kneeWidthDb);
+        compressor.setGainDecimation(getGainDecimation());
+
+        // Update lookahead delays (tap changes are crossfaded)
+        compressor.setFixedLatency(fixedLatency);
+        compressor.setLookaheadMs(lookaheadTimeMs);
+        compressor.setPeakLookahead(peakLookahead);
+        compressor.setOversampling(getOversampling());
+        compressor.setOversampledDetection(oversampledDetection);
+
+        // Update gain smoothing targets
+        compressor.setInputGainDb(inputGainDb);
+        compressor.setOutputGainDb(outputGainDb);
+    }
+};
+
+} // namespace DSP
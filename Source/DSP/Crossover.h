@@ -0,0 +1,308 @@
+#pragma once
+
+#include "SIMD.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    Splits channels into 2 to kMaxBands bands with 4th-order Linkwitz-Riley
+    crossovers. The bands add up to an allpass, so summing them gives back
+    the input's magnitude response exactly.
+
+    With crossovers f[0] < f[1] < ..., band b is
+
+        HP(f[0]) ... HP(f[b - 1]) . LP(f[b]) . AP(f[b + 1]) ...
+
+    where LP and HP are two Butterworth biquads each and AP(f) is the
+    allpass that LP(f) + HP(f) adds up to. Adding the bands from the top
+    down turns each crossover into its allpass in turn. An AP stage is its
+    allpass biquad and an identity biquad, so every band is the same cascade
+    of two biquads per crossover with its own coefficients.
+
+    Like LevelEstimator::estimateLevelMultichannel, the (band, channel)
+    pairs run SIMD::kWidth at a time, one per vector lane: short tiles of
+    the input are interleaved on the stack, each biquad runs once per sample
+    for all lanes, and the bands are de-interleaved into their outputs. A
+    stereo split into 4 bands is then two vectors per sample with SSE, or
+    one with AVX2, rather than eight filter chains.
+*/
+class Crossover
+{
+public:
+    static constexpr size_t kMaxBands = 5;
+
+    Crossover() = default;
+
+    /** Allocate for up to kMaxBands bands of numChannels channels. */
+    void prepare(double sampleRateHz, size_t numChannels)
+    {
+        sampleRateHz_ = sampleRateHz;
+        numChannels_ = numChannels;
+
+        size_t numVectors = (numChannels * kMaxBands + SIMD::kWidth - 1) / SIMD::kWidth;
+        coefficients_.assign(numVectors * kMaxStages * kNumCoefficients * SIMD::kWidth, 0.0f);
+        states_.assign(numVectors * kMaxStages * 2 * SIMD::kWidth, 0.0f);
+
+        updateCoefficients();
+    }
+
+    /** Set the number of bands (1 passes the input through). Clears the filters. */
+    void setNumBands(size_t numBands)
+    {
+        numBands_ = std::max<size_t>(1, std::min(numBands, kMaxBands));
+        updateCoefficients();
+        reset();
+    }
+
+    size_t getNumBands() const { return numBands_; }
+
+    /** Set one crossover frequency. The crossovers in use are sorted, so
+        they don't have to be given in order.
+        @param index       Crossover between bands index and index + 1
+        @param frequencyHz Kept between 10 Hz and 0.45 x the sample rate
+    */
+    void setFrequency(size_t index, float frequencyHz)
+    {
+        if (index >= frequenciesHz_.size())
+            return;
+
+        frequenciesHz_[index] = frequencyHz;
+        updateCoefficients();
+    }
+
+    float getFrequency(size_t index) const { return index < frequenciesHz_.size() ? frequenciesHz_[index] : 0.0f; }
+
+    void reset() { std::fill(states_.begin(), states_.end(), 0.0f); }
+
+    /** Samples until the filters have forgotten all but residual of their
+        state, from the slowest pole (the lowest crossover). Each pole is
+        repeated, so twice the single-pole figure is allowed. */
+    size_t getSettleSamples(float residual) const
+    {
+        if (numBands_ <= 1 || residual <= 0.0f || residual >= 1.0f)
+            return 0;
+
+        double lowest = *std::min_element(frequenciesHz_.begin(), frequenciesHz_.begin() + (numBands_ - 1));
+        double radius = std::sqrt(getButterworth(clampFrequency(lowest)).a2);
+
+        return 2 * static_cast<size_t>(std::ceil(std::log(static_cast<double>(residual)) / std::log(radius)));
+    }
+
+    /** Split a block of every channel into bands.
+        @param inputs     One pointer per channel
+        @param offset     First sample of each input to read
+        @param outputs    One pointer per band and channel, band-major: band b of channel ch at b * numChannels + ch
+        @param numSamples Number of samples
+    */
+    void process(const float* const* inputs, size_t offset, float* const* outputs, size_t numSamples)
+    {
+        size_t numLanes = numChannels_ * numBands_;
+
+        for (size_t first = 0, vector = 0; first < numLanes; first += SIMD::kWidth, ++vector)
+            processLanes(inputs, offset, outputs, first, std::min(SIMD::kWidth, numLanes - first), vector,
+                         numSamples);
+    }
+
+private:
+    static constexpr size_t kMaxStages = 2 * (kMaxBands - 1);
+    static constexpr size_t kNumCoefficients = 5;  // b0, b1, b2, a1, a2
+    static constexpr size_t kLaneTileSize = 32;
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    double clampFrequency(double frequencyHz) const
+    {
+        return std::max(10.0, std::min(frequencyHz, 0.45 * sampleRateHz_));
+    }
+
+    enum class Response
+    {
+        lowPass,
+        highPass,
+        allPass
+    };
+
+    /** Bilinear Butterworth biquad (Q = 1/sqrt 2), prewarped to frequencyHz.
+        The all pass is the sum of the squared low and high passes. */
+    Biquad getButterworth(double frequencyHz, Response response = Response::lowPass) const
+    {
+        const double k = std::tan(3.14159265358979323846 * frequencyHz / sampleRateHz_);
+        const double norm = 1.0 / (1.0 + std::sqrt(2.0) * k + k * k);
+
+        Biquad biquad;
+        biquad.a1 = 2.0 * (k * k - 1.0) * norm;
+        biquad.a2 = (1.0 - std::sqrt(2.0) * k + k * k) * norm;
+
+        switch (response)
+        {
+            case Response::lowPass:
+                biquad.b0 = k * k * norm;
+                biquad.b1 = 2.0 * biquad.b0;
+                biquad.b2 = biquad.b0;
+                break;
+
+            case Response::highPass:
+                biquad.b0 = norm;
+                biquad.b1 = -2.0 * norm;
+                biquad.b2 = norm;
+                break;
+
+            case Response::allPass:
+                biquad.b0 = biquad.a2;
+                biquad.b1 = biquad.a1;
+                biquad.b2 = 1.0;
+                break;
+        }
+
+        return biquad;
+    }
+
+    void updateCoefficients()
+    {
+        if (coefficients_.empty())
+            return;
+
+        std::fill(coefficients_.begin(), coefficients_.end(), 0.0f);
+
+        size_t numCrossovers = numBands_ - 1;
+        std::array<double, kMaxBands - 1> sorted{};
+
+        for (size_t j = 0; j < numCrossovers; ++j)
+            sorted[j] = clampFrequency(frequenciesHz_[j]);
+
+        std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(numCrossovers));
+
+        for (size_t lane = 0; lane < numChannels_ * numBands_; ++lane)
+        {
+            size_t band = lane / numChannels_;
+
+            // One band passes straight through
+            if (numCrossovers == 0)
+            {
+                setStage(lane, 0, Biquad());
+                continue;
+            }
+
+            // Below the band: high pass; at its top: low pass; above: all pass
+            for (size_t j = 0; j < numCrossovers; ++j)
+            {
+                if (j > band)
+                {
+                    setStage(lane, 2 * j, getButterworth(sorted[j], Response::allPass));
+                    setStage(lane, 2 * j + 1, Biquad());
+                }
+                else
+                {
+                    Biquad biquad = getButterworth(sorted[j], j == band ? Response::lowPass : Response::highPass);
+                    setStage(lane, 2 * j, biquad);
+                    setStage(lane, 2 * j + 1, biquad);
+                }
+            }
+        }
+    }
+
+    void setStage(size_t lane, size_t stage, const Biquad& biquad)
+    {
+        size_t vector = lane / SIMD::kWidth;
+        float* c = coefficients_.data() + (vector * kMaxStages + stage) * kNumCoefficients * SIMD::kWidth
+                   + lane % SIMD::kWidth;
+
+        c[0 * SIMD::kWidth] = static_cast<float>(biquad.b0);
+        c[1 * SIMD::kWidth] = static_cast<float>(biquad.b1);
+        c[2 * SIMD::kWidth] = static_cast<float>(biquad.b2);
+        c[3 * SIMD::kWidth] = static_cast<float>(biquad.a1);
+        c[4 * SIMD::kWidth] = static_cast<float>(biquad.a2);
+    }
+
+    void processLanes(const float* const* inputs, size_t offset, float* const* outputs, size_t firstLane,
+                      size_t numLanes, size_t vector, size_t numSamples)
+    {
+        constexpr size_t width = SIMD::kWidth;
+        const size_t numStages = numBands_ > 1 ? 2 * (numBands_ - 1) : 1;
+
+        const float* c = coefficients_.data() + vector * kMaxStages * kNumCoefficients * width;
+        float* s = states_.data() + vector * kMaxStages * 2 * width;
+
+        SIMD::Float b0[kMaxStages], b1[kMaxStages], b2[kMaxStages], a1[kMaxStages], a2[kMaxStages];
+        SIMD::Float s1[kMaxStages], s2[kMaxStages];
+
+        for (size_t k = 0; k < numStages; ++k)
+        {
+            const float* stage = c + k * kNumCoefficients * width;
+            b0[k] = SIMD::load(stage);
+            b1[k] = SIMD::load(stage + width);
+            b2[k] = SIMD::load(stage + 2 * width);
+            a1[k] = SIMD::load(stage + 3 * width);
+            a2[k] = SIMD::load(stage + 4 * width);
+            s1[k] = SIMD::load(s + 2 * k * width);
+            s2[k] = SIMD::load(s + (2 * k + 1) * width);
+        }
+
+        // Unused lanes see silence and are never written back
+        float tile[kLaneTileSize * width] = {};
+
+        for (size_t start = 0; start < numSamples; start += kLaneTileSize)
+        {
+            size_t length = std::min(kLaneTileSize, numSamples - start);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                const float* input = inputs[(firstLane + lane) % numChannels_] + offset + start;
+
+                for (size_t i = 0; i < length; ++i)
+                    tile[i * width + lane] = input[i];
+            }
+
+            // Transposed direct form II, stage after stage
+            for (size_t i = 0; i < length; ++i)
+            {
+                SIMD::Float x = SIMD::load(tile + i * width);
+
+                for (size_t k = 0; k < numStages; ++k)
+                {
+                    SIMD::Float y = SIMD::add(SIMD::mul(b0[k], x), s1[k]);
+                    s1[k] = SIMD::add(SIMD::sub(SIMD::mul(b1[k], x), SIMD::mul(a1[k], y)), s2[k]);
+                    s2[k] = SIMD::sub(SIMD::mul(b2[k], x), SIMD::mul(a2[k], y));
+                    x = y;
+                }
+
+                SIMD::store(tile + i * width, x);
+            }
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                float* output = outputs[firstLane + lane] + start;
+
+                for (size_t i = 0; i < length; ++i)
+                    output[i] = tile[i * width + lane];
+            }
+        }
+
+        for (size_t k = 0; k < numStages; ++k)
+        {
+            SIMD::store(s + 2 * k * width, s1[k]);
+            SIMD::store(s + (2 * k + 1) * width, s2[k]);
+        }
+    }
+
+    double sampleRateHz_ = 44100.0;
+    size_t numChannels_ = 0;
+    size_t numBands_ = 1;
+    std::array<float, kMaxBands - 1> frequenciesHz_{ { 150.0f, 800.0f, 3000.0f, 8000.0f } };
+
+    // Per lane vector: kMaxStages stages of kNumCoefficients vectors, and two state vectors per stage
+    std::vector<float> coefficients_;
+    std::vector<float> states_;
+};
+
+} // namespace DSP
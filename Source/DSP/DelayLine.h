@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 
 namespace DSP
@@ -12,6 +13,16 @@ namespace DSP
 
     Provides sample-accurate delay with variable delay time.
     Maximum delay is set at construction time.
+
+    The ring buffer capacity is a power of two so wrap-around is a mask.
+    Block processing writes the input and reads the delayed output in at
+    most two contiguous memcpy segments each, so a block costs roughly the
+    same as a copy regardless of the delay length.
+
+    With a crossfade length set, delay changes move the read tap by fading
+    from the old tap to the new one instead of jumping, so lookahead can be
+    automated without clicks. A change requested while a fade is running
+    starts as soon as that fade completes.
 */
 class DelayLine
 {
@@ -20,36 +31,71 @@ public:
 
     /** Create a delay line with specified maximum delay.
         @param maxDelaySamples Maximum delay in samples
+        @param maxBlockSize    Largest block passed to process() (0 if unknown)
     */
-    explicit DelayLine(size_t maxDelaySamples)
-        : maxDelay_(maxDelaySamples)
+    explicit DelayLine(size_t maxDelaySamples, size_t maxBlockSize = 0)
     {
-        buffer_.resize(maxDelaySamples + 1, 0.0f);
+        prepare(maxDelaySamples, maxBlockSize);
     }
 
     /** Prepare the delay line for processing.
+
+        Blocks larger than maxBlockSize are still handled, but are split into
+        several ring-buffer passes.
+
         @param maxDelaySamples Maximum delay in samples
+        @param maxBlockSize    Largest block passed to process() (0 if unknown)
     */
-    void prepare(size_t maxDelaySamples)
+    void prepare(size_t maxDelaySamples, size_t maxBlockSize = 0)
     {
         maxDelay_ = maxDelaySamples;
-        buffer_.resize(maxDelaySamples + 1, 0.0f);
+
+        size_t capacity = 1;
+        while (capacity < maxDelaySamples + std::max<size_t>(maxBlockSize, 1))
+            capacity <<= 1;
+
+        buffer_.assign(capacity, 0.0f);
+        mask_ = capacity - 1;
+        targetDelay_ = std::min(targetDelay_, maxDelay_);
+        previousDelay_ = targetDelay_;
         reset();
     }
 
-    /** Clear the delay buffer. */
+    /** Clear the delay buffer. Any crossfade in progress is completed. */
     void reset()
     {
         std::fill(buffer_.begin(), buffer_.end(), 0.0f);
         writeIndex_ = 0;
+        delay_ = targetDelay_;
+        fadeRemaining_ = 0;
+    }
+
+    /** Set the length of the crossfade used when the delay changes.
+        @param crossfadeSamples Fade length in samples (0 = jump immediately)
+    */
+    void setCrossfadeLength(size_t crossfadeSamples)
+    {
+        crossfadeLength_ = crossfadeSamples;
     }
 
+    size_t getCrossfadeLength() const { return crossfadeLength_; }
+
     /** Set the delay time in samples.
         @param delaySamples Delay in samples (0 to maxDelay)
     */
     void setDelay(size_t delaySamples)
     {
-        delay_ = std::min(delaySamples, maxDelay_);
+        targetDelay_ = std::min(delaySamples, maxDelay_);
+
+        if (crossfadeLength_ == 0)
+        {
+            delay_ = previousDelay_ = targetDelay_;
+            fadeRemaining_ = 0;
+        }
+        else if (fadeRemaining_ == 0)
+        {
+            startCrossfade();
+        }
     }
 
     /** Set the delay time in milliseconds.
@@ -62,12 +108,21 @@ public:
         setDelay(delaySamples);
     }
 
-    /** Get the current delay in samples. */
+    /** Get the current delay in samples (the tap being faded to, if fading). */
     size_t getDelay() const { return delay_; }
 
+    /** Get the most recently requested delay in samples. */
+    size_t getTargetDelay() const { return targetDelay_; }
+
+    /** True while the read tap is crossfading between two delays. */
+    bool isCrossfading() const { return fadeRemaining_ > 0; }
+
     /** Get the maximum delay in samples. */
     size_t getMaxDelay() const { return maxDelay_; }
 
+    /** Get the ring buffer capacity in samples (a power of two). */
+    size_t getCapacity() const { return buffer_.size(); }
+
     /** Process a single sample through the delay line.
         @param input The input sample
         @return The delayed output sample
@@ -77,29 +132,93 @@ public:
         // Write input to buffer
         buffer_[writeIndex_] = input;
 
-        // Calculate read index
-        size_t readIndex = (writeIndex_ + buffer_.size() - delay_) % buffer_.size();
-
         // Read delayed sample
-        float output = buffer_[readIndex];
+        float output = buffer_[(writeIndex_ - delay_) & mask_];
+
+        if (fadeRemaining_ > 0)
+        {
+            float previous = buffer_[(writeIndex_ - previousDelay_) & mask_];
+            output = previous + (output - previous) * nextFadeGain();
+            advanceCrossfade(1);
+        }
 
         // Advance write index
-        writeIndex_ = (writeIndex_ + 1) % buffer_.size();
+        writeIndex_ = (writeIndex_ + 1) & mask_;
 
         return output;
     }
 
     /** Process a buffer of samples.
         @param input  Pointer to input samples
-        @param output Pointer to output samples
+        @param output Pointer to output samples (may alias input)
         @param numSamples Number of samples to process
     */
     void process(const float* input, float* output, size_t numSamples)
     {
-        for (size_t i = 0; i < numSamples; ++i)
+        if (delay_ == 0 && fadeRemaining_ == 0)
         {
-            output[i] = processSample(input[i]);
+            // Zero delay: the output is the input, only the history needs updating
+            write(input, numSamples);
+
+            if (output != input)
+                std::memcpy(output, input, numSamples * sizeof(float));
+
+            return;
         }
+
+        while (numSamples > 0)
+        {
+            // Each pass must not overwrite samples that are still to be read
+            size_t chunk = std::min(numSamples, buffer_.size() - std::max(delay_, previousDelay_));
+
+            if (fadeRemaining_ > 0)
+                chunk = std::min(chunk, fadeRemaining_);
+
+            // Write the whole chunk first so delays shorter than the chunk
+            // read back the samples that were just written
+            copyToRing(writeIndex_, input, chunk);
+            copyFromRing((writeIndex_ - delay_) & mask_, output, chunk);
+
+            if (fadeRemaining_ > 0)
+            {
+                for (size_t i = 0; i < chunk; ++i)
+                {
+                    float previous = buffer_[(writeIndex_ + i - previousDelay_) & mask_];
+                    output[i] = previous + (output[i] - previous) * nextFadeGain();
+                }
+
+                advanceCrossfade(chunk);
+            }
+
+            writeIndex_ = (writeIndex_ + chunk) & mask_;
+
+            input += chunk;
+            output += chunk;
+            numSamples -= chunk;
+        }
+    }
+
+    /** Write samples into the history without reading the delayed output.
+
+        Use this while the delayed signal isn't needed (e.g. lookahead off)
+        so that a later delay change still fades in valid audio. Must not be
+        called while crossfading.
+
+        @param input      Pointer to input samples
+        @param numSamples Number of samples to write
+    */
+    void write(const float* input, size_t numSamples)
+    {
+        // Only the most recent capacity samples can be read back
+        if (numSamples > buffer_.size())
+        {
+            input += numSamples - buffer_.size();
+            writeIndex_ = (writeIndex_ + numSamples - buffer_.size()) & mask_;
+            numSamples = buffer_.size();
+        }
+
+        copyToRing(writeIndex_, input, numSamples);
+        writeIndex_ = (writeIndex_ + numSamples) & mask_;
     }
 
     /** Process in-place.
@@ -108,17 +227,64 @@ public:
     */
     void processInPlace(float* buffer, size_t numSamples)
     {
-        for (size_t i = 0; i < numSamples; ++i)
+        process(buffer, buffer, numSamples);
+    }
+
+private:
+    void startCrossfade()
+    {
+        if (targetDelay_ == delay_)
+            return;
+
+        previousDelay_ = delay_;
+        delay_ = targetDelay_;
+        fadeRemaining_ = crossfadeLength_;
+        fadePosition_ = 0;
+    }
+
+    /** Linear fade gain for the next sample, reaching 1 on the last one. */
+    float nextFadeGain()
+    {
+        return static_cast<float>(++fadePosition_) / static_cast<float>(crossfadeLength_);
+    }
+
+    void advanceCrossfade(size_t numSamples)
+    {
+        fadeRemaining_ -= numSamples;
+
+        if (fadeRemaining_ == 0)
         {
-            buffer[i] = processSample(buffer[i]);
+            previousDelay_ = delay_;
+            startCrossfade();
         }
     }
 
-private:
-    std::vector<float> buffer_;
+    void copyToRing(size_t start, const float* source, size_t numSamples)
+    {
+        size_t first = std::min(numSamples, buffer_.size() - start);
+        std::memcpy(buffer_.data() + start, source, first * sizeof(float));
+        std::memcpy(buffer_.data(), source + first, (numSamples - first) * sizeof(float));
+    }
+
+    void copyFromRing(size_t start, float* destination, size_t numSamples) const
+    {
+        size_t first = std::min(numSamples, buffer_.size() - start);
+        std::memcpy(destination, buffer_.data() + start, first * sizeof(float));
+        std::memcpy(destination + first, buffer_.data(), (numSamples - first) * sizeof(float));
+    }
+
+    std::vector<float> buffer_ = std::vector<float>(1, 0.0f);
+    size_t mask_ = 0;
     size_t writeIndex_ = 0;
     size_t delay_ = 0;
+    size_t targetDelay_ = 0;
+    size_t previousDelay_ = 0;
     size_t maxDelay_ = 0;
+
+    // Crossfade between read taps
+    size_t crossfadeLength_ = 0;
+    size_t fadeRemaining_ = 0;
+    size_t fadePosition_ = 0;
 };
 
 } // namespace DSP
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "SIMD.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace DSP
+{
+
+//==============================================================================
+// Fast log2 / exp2 approximations
+//==============================================================================
+//
+// Both approximations split the IEEE-754 float into exponent and mantissa
+// and evaluate a 5th-order polynomial fitted (minimax, Lawson iteration) on
+// the reduced range:
+//
+//   fastLog2: log2(1 + t), t in [0, 1)       |abs error| < 1.5e-5
+//   fastExp2: 2^f,         f in [-0.5, 0.5]  |rel error| < 1.4e-7
+//
+// In decibel terms this is < 9e-5 dB for mag2Db and < 1.2e-6 dB for db2Mag,
+// far below anything audible or visible on a meter. Both polynomials are
+// exact at the origin, so fastLog2(1) == 0 and fastExp2(0) == 1 exactly,
+// which keeps a 1:1 ratio bit-transparent.
+//
+// The scalar and vector versions perform the same operations in the same
+// order, so block kernels can finish their tails with the scalar versions.
+
+namespace FastMath
+{
+    constexpr float kLog2C1 =  1.4419670941f;
+    constexpr float kLog2C2 = -0.7096802263f;
+    constexpr float kLog2C3 =  0.4176575495f;
+    constexpr float kLog2C4 = -0.1963541021f;
+    constexpr float kLog2C5 =  0.0464245089f;
+
+    constexpr float kExp2C1 = 0.6931472147f;
+    constexpr float kExp2C2 = 0.2402223662f;
+    constexpr float kExp2C3 = 0.0555030886f;
+    constexpr float kExp2C4 = 0.0096717457f;
+    constexpr float kExp2C5 = 0.0013407078f;
+
+    /** Smallest input accepted by fastLog2 (inputs below are clamped). */
+    constexpr float kMinLog2Input = std::numeric_limits<float>::min();
+
+    /** Input range of fastExp2 (inputs outside are clamped). */
+    constexpr float kMaxExp2Input = 126.0f;
+
+    /** 20 * log10(2): converts log2 to dB. */
+    constexpr float kDbPerLog2 = 6.0205999133f;
+
+    /** log2(10) / 20: converts dB to log2. */
+    constexpr float kLog2PerDb = 0.1660964047f;
+}
+
+//==============================================================================
+// Scalar versions
+
+/** Fast base-2 logarithm. Non-positive inputs are clamped to kMinLog2Input. */
+inline float fastLog2(float x)
+{
+    using namespace FastMath;
+
+    x = x < kMinLog2Input ? kMinLog2Input : x;
+
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(float));
+
+    float exponent = static_cast<float>(static_cast<int32_t>(static_cast<uint32_t>(bits) >> 23) - 127);
+
+    int32_t mantissaBits = (bits & 0x007fffff) | 0x3f800000;
+    float mantissa;
+    std::memcpy(&mantissa, &mantissaBits, sizeof(float));
+
+    float t = mantissa - 1.0f;
+    float p = kLog2C5;
+    p = p * t + kLog2C4;
+    p = p * t + kLog2C3;
+    p = p * t + kLog2C2;
+    p = p * t + kLog2C1;
+
+    return exponent + p * t;
+}
+
+/** Fast base-2 exponential. Inputs are clamped to +/- kMaxExp2Input. */
+inline float fastExp2(float x)
+{
+    using namespace FastMath;
+
+    x = x < -kMaxExp2Input ? -kMaxExp2Input : x;
+    x = x > kMaxExp2Input ? kMaxExp2Input : x;
+
+    int32_t n = static_cast<int32_t>(std::lrint(x));
+    float f = x - static_cast<float>(n);
+
+    float p = kExp2C5;
+    p = p * f + kExp2C4;
+    p = p * f + kExp2C3;
+    p = p * f + kExp2C2;
+    p = p * f + kExp2C1;
+
+    int32_t scaleBits = static_cast<int32_t>(static_cast<uint32_t>(n + 127) << 23);
+    float scale;
+    std::memcpy(&scale, &scaleBits, sizeof(float));
+
+    return (1.0f + p * f) * scale;
+}
+
+/** Fast linear magnitude to dB (see error bounds above). */
+inline float fastMag2Db(float mag)
+{
+    return FastMath::kDbPerLog2 * fastLog2(std::fabs(mag));
+}
+
+/** Fast dB to linear magnitude (see error bounds above). */
+inline float fastDb2Mag(float db)
+{
+    return fastExp2(FastMath::kLog2PerDb * db);
+}
+
+//==============================================================================
+// Vector versions
+
+inline SIMD::Float fastLog2(SIMD::Float x)
+{
+    using namespace FastMath;
+
+    x = SIMD::max(x, SIMD::broadcast(kMinLog2Input));
+
+    SIMD::Int bits = SIMD::asInt(x);
+    SIMD::Float exponent = SIMD::toFloat(SIMD::addInt(SIMD::shiftRight<23>(bits), -127));
+    SIMD::Float mantissa = SIMD::asFloat(SIMD::orInt(SIMD::andInt(bits, 0x007fffff), 0x3f800000));
+
+    SIMD::Float t = SIMD::sub(mantissa, SIMD::broadcast(1.0f));
+    SIMD::Float p = SIMD::broadcast(kLog2C5);
+    p = SIMD::add(SIMD::mul(p, t), SIMD::broadcast(kLog2C4));
+    p = SIMD::add(SIMD::mul(p, t), SIMD::broadcast(kLog2C3));
+    p = SIMD::add(SIMD::mul(p, t), SIMD::broadcast(kLog2C2));
+    p = SIMD::add(SIMD::mul(p, t), SIMD::broadcast(kLog2C1));
+
+    return SIMD::add(exponent, SIMD::mul(p, t));
+}
+
+inline SIMD::Float fastExp2(SIMD::Float x)
+{
+    using namespace FastMath;
+
+    x = SIMD::max(x, SIMD::broadcast(-kMaxExp2Input));
+    x = SIMD::min(x, SIMD::broadcast(kMaxExp2Input));
+
+    SIMD::Int n = SIMD::roundToInt(x);
+    SIMD::Float f = SIMD::sub(x, SIMD::toFloat(n));
+
+    SIMD::Float p = SIMD::broadcast(kExp2C5);
+    p = SIMD::add(SIMD::mul(p, f), SIMD::broadcast(kExp2C4));
+    p = SIMD::add(SIMD::mul(p, f), SIMD::broadcast(kExp2C3));
+    p = SIMD::add(SIMD::mul(p, f), SIMD::broadcast(kExp2C2));
+    p = SIMD::add(SIMD::mul(p, f), SIMD::broadcast(kExp2C1));
+
+    SIMD::Float scale = SIMD::asFloat(SIMD::shiftLeft<23>(SIMD::addInt(n, 127)));
+
+    return SIMD::mul(SIMD::add(SIMD::broadcast(1.0f), SIMD::mul(p, f)), scale);
+}
+
+inline SIMD::Float fastMag2Db(SIMD::Float mag)
+{
+    return SIMD::mul(SIMD::broadcast(FastMath::kDbPerLog2), fastLog2(SIMD::abs(mag)));
+}
+
+inline SIMD::Float fastDb2Mag(SIMD::Float db)
+{
+    return fastExp2(SIMD::mul(SIMD::broadcast(FastMath::kLog2PerDb), db));
+}
+
+} // namespace DSP
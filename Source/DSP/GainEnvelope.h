@@ -0,0 +1,542 @@
+#pragma once
+
+#include "FastMath.h"
+#include "SIMD.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace DSP
+{
+
+//==============================================================================
+// Gain envelope sidecar
+//==============================================================================
+//
+// A precomputed gain envelope replaces the detector and gain computer at
+// playback: the compressor runs offline, and a device only multiplies the
+// dry audio by the stored gain. All values are little-endian.
+//
+//   offset  size  field
+//        0     4  magic "BBGE"
+//        4     2  version (kVersion)
+//        6     2  number of channels
+//        8     2  number of tracks (one per compressor channel group)
+//       10     2  reserved (zero)
+//       12     4  sample rate in Hz
+//       16     4  decimation (samples between points)
+//       20     4  points per block
+//       24     4  quantization step in dB (float)
+//       28     8  number of samples
+//       36     4  number of blocks
+//       40   2*C  track of each channel
+//        .   8*B  byte offset of each block from the start of the file
+//        .        blocks
+//
+// Point k is the gain at sample k * decimation; there are
+// ceil(numSamples / decimation) + 1 points, so the last interval has an end
+// point. Each block holds pointsPerBlock points (the last block fewer),
+// point by point, each point with one value per track. Values are dB
+// divided by the step, as signed LEB128 varints after zigzag coding: the
+// first point of a block is stored as is and the others as the difference
+// to the previous point, so any block can be decoded on its own.
+//
+// Point k is the lowest gain of the two intervals it joins, rounded down
+// to the step, so the interpolated gain never exceeds the gain the
+// compressor applied: playback can only reduce more, by at most the
+// gain's change over the neighbouring intervals plus one step.
+
+namespace GainEnvelope
+{
+    constexpr uint8_t kMagic[4] = { 'B', 'B', 'G', 'E' };
+    constexpr uint16_t kVersion = 1;
+    constexpr size_t kHeaderSize = 40;
+
+    constexpr size_t kDefaultDecimation = 32;
+    constexpr size_t kDefaultPointsPerBlock = 512;
+    constexpr float kDefaultStepDb = 1.0f / 32.0f;
+
+    /** Lowest stored gain; silence-level gains are clamped to it. */
+    constexpr float kMinGainDb = -200.0f;
+
+    /** Header fields (see the layout above). */
+    struct Info
+    {
+        size_t numChannels = 0;
+        size_t numTracks = 0;
+        uint32_t sampleRate = 0;
+        size_t decimation = 0;
+        size_t pointsPerBlock = 0;
+        float stepDb = 0.0f;
+        uint64_t numSamples = 0;
+        size_t numBlocks = 0;
+
+        uint64_t getNumPoints() const
+        {
+            return decimation > 0 && numSamples > 0 ? (numSamples + decimation - 1) / decimation + 1 : 0;
+        }
+    };
+
+    inline void writeBytes(std::vector<uint8_t>& out, uint64_t value, size_t numBytes)
+    {
+        for (size_t i = 0; i < numBytes; ++i)
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    inline uint64_t readBytes(const uint8_t* data, size_t numBytes)
+    {
+        uint64_t value = 0;
+
+        for (size_t i = 0; i < numBytes; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+
+        return value;
+    }
+
+    inline void writeVarint(std::vector<uint8_t>& out, int32_t value)
+    {
+        uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+
+        while (zigzag >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+
+        out.push_back(static_cast<uint8_t>(zigzag));
+    }
+
+    /** Decode one varint, or return false if it runs past end. */
+    inline bool readVarint(const uint8_t*& data, const uint8_t* end, int32_t& value)
+    {
+        uint32_t zigzag = 0;
+
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (data == end)
+                return false;
+
+            uint8_t byte = *data++;
+            zigzag |= static_cast<uint32_t>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                value = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+//==============================================================================
+/**
+    Encodes the gain of a compressor into a sidecar (see GainEnvelope).
+
+    Gains are added as they are produced, one buffer per track, and the
+    encoded blocks are kept in memory (about a byte per point and track)
+    until finish() returns the complete file.
+*/
+class GainEnvelopeWriter
+{
+public:
+    /** Start a new envelope.
+
+        @param sampleRateHz   Sample rate of the audio
+        @param channelTracks  Track of each channel
+        @param numTracks      Number of gain buffers passed to addGains
+        @param fixedGain      Constant linear gain folded into every point (input and output gain)
+        @param decimation     Samples between points
+        @param pointsPerBlock Points per seekable block
+        @param stepDb         Quantization step
+    */
+    void prepare(uint32_t sampleRateHz, const std::vector<uint16_t>& channelTracks, size_t numTracks,
+                 float fixedGain = 1.0f,
+                 size_t decimation = GainEnvelope::kDefaultDecimation,
+                 size_t pointsPerBlock = GainEnvelope::kDefaultPointsPerBlock,
+                 float stepDb = GainEnvelope::kDefaultStepDb)
+    {
+        info_ = {};
+        info_.numChannels = channelTracks.size();
+        info_.numTracks = numTracks;
+        info_.sampleRate = sampleRateHz;
+        info_.decimation = std::max<size_t>(decimation, 1);
+        info_.pointsPerBlock = std::max<size_t>(pointsPerBlock, 1);
+        info_.stepDb = stepDb;
+
+        channelTracks_ = channelTracks;
+        fixedGain_ = fixedGain;
+
+        intervalMin_.assign(numTracks, positiveInfinity<float>());
+        previousMin_.assign(numTracks, positiveInfinity<float>());
+        previousValues_.assign(numTracks, 0);
+        intervalFill_ = 0;
+        numPoints_ = 0;
+
+        blockOffsets_.clear();
+        blocks_.clear();
+    }
+
+    /** Add the next numSamples linear gains of every track. */
+    void addGains(const float* const* trackGains, size_t numSamples)
+    {
+        size_t done = 0;
+
+        while (done < numSamples)
+        {
+            size_t count = std::min(info_.decimation - intervalFill_, numSamples - done);
+
+            for (size_t t = 0; t < info_.numTracks; ++t)
+            {
+                const float* gains = trackGains[t] + done;
+                float lowest = intervalMin_[t];
+
+                for (size_t i = 0; i < count; ++i)
+                    lowest = std::min(lowest, gains[i]);
+
+                intervalMin_[t] = lowest;
+            }
+
+            intervalFill_ += count;
+            done += count;
+            info_.numSamples += count;
+
+            if (intervalFill_ == info_.decimation)
+                finishInterval();
+        }
+    }
+
+    /** Close the last interval and return the complete sidecar file. */
+    std::vector<uint8_t> finish()
+    {
+        if (intervalFill_ > 0)
+            finishInterval();
+
+        // End point of the last interval
+        if (numPoints_ > 0)
+            addPoint(previousMin_);
+
+        info_.numBlocks = blockOffsets_.size();
+
+        std::vector<uint8_t> file;
+        size_t dataOffset = GainEnvelope::kHeaderSize + 2 * info_.numChannels + 8 * info_.numBlocks;
+        file.reserve(dataOffset + blocks_.size());
+
+        uint32_t stepBits;
+        std::memcpy(&stepBits, &info_.stepDb, sizeof(stepBits));
+
+        for (uint8_t byte : GainEnvelope::kMagic)
+            file.push_back(byte);
+
+        GainEnvelope::writeBytes(file, GainEnvelope::kVersion, 2);
+        GainEnvelope::writeBytes(file, info_.numChannels, 2);
+        GainEnvelope::writeBytes(file, info_.numTracks, 2);
+        GainEnvelope::writeBytes(file, 0, 2);
+        GainEnvelope::writeBytes(file, info_.sampleRate, 4);
+        GainEnvelope::writeBytes(file, info_.decimation, 4);
+        GainEnvelope::writeBytes(file, info_.pointsPerBlock, 4);
+        GainEnvelope::writeBytes(file, stepBits, 4);
+        GainEnvelope::writeBytes(file, info_.numSamples, 8);
+        GainEnvelope::writeBytes(file, info_.numBlocks, 4);
+
+        for (uint16_t track : channelTracks_)
+            GainEnvelope::writeBytes(file, track, 2);
+
+        for (size_t offset : blockOffsets_)
+            GainEnvelope::writeBytes(file, dataOffset + offset, 8);
+
+        file.insert(file.end(), blocks_.begin(), blocks_.end());
+        blocks_.clear();
+
+        return file;
+    }
+
+    const GainEnvelope::Info& getInfo() const { return info_; }
+
+private:
+    void finishInterval()
+    {
+        // Point k joins intervals k - 1 and k; point 0 only has interval 0
+        for (size_t t = 0; t < info_.numTracks; ++t)
+        {
+            float current = intervalMin_[t];
+            intervalMin_[t] = std::min(previousMin_[t], current);
+            previousMin_[t] = current;
+        }
+
+        addPoint(intervalMin_);
+
+        std::fill(intervalMin_.begin(), intervalMin_.end(), positiveInfinity<float>());
+        intervalFill_ = 0;
+    }
+
+    void addPoint(const std::vector<float>& gains)
+    {
+        bool firstOfBlock = numPoints_ % info_.pointsPerBlock == 0;
+
+        if (firstOfBlock)
+            blockOffsets_.push_back(blocks_.size());
+
+        for (size_t t = 0; t < info_.numTracks; ++t)
+        {
+            float gainDb = std::max(mag2Db(gains[t] * fixedGain_), GainEnvelope::kMinGainDb);
+            int32_t value = static_cast<int32_t>(std::floor(gainDb / info_.stepDb));
+
+            GainEnvelope::writeVarint(blocks_, firstOfBlock ? value : value - previousValues_[t]);
+            previousValues_[t] = value;
+        }
+
+        ++numPoints_;
+    }
+
+    GainEnvelope::Info info_;
+    std::vector<uint16_t> channelTracks_;
+    float fixedGain_ = 1.0f;
+
+    std::vector<float> intervalMin_;
+    std::vector<float> previousMin_;
+    std::vector<int32_t> previousValues_;
+    size_t intervalFill_ = 0;
+    uint64_t numPoints_ = 0;
+
+    std::vector<size_t> blockOffsets_;
+    std::vector<uint8_t> blocks_;
+};
+
+//==============================================================================
+/**
+    Applies a gain envelope sidecar to dry audio.
+
+    The player reads the file in place (typically memory-mapped) and keeps
+    one decoded block of linear gains, so its memory does not grow with the
+    length of the file. Between points the gain is ramped linearly: each
+    sample costs one multiply and one add, with a dB conversion per point.
+    Audio past the end of the envelope gets the gain of the last point.
+*/
+class GainEnvelopePlayer
+{
+public:
+    /** Open a sidecar file held in memory.
+
+        The data must stay valid while the player is used.
+
+        @return false if the data is not a valid gain envelope
+    */
+    bool open(const uint8_t* data, size_t size)
+    {
+        using namespace GainEnvelope;
+
+        data_ = nullptr;
+        info_ = {};
+
+        if (size < kHeaderSize || !std::equal(std::begin(kMagic), std::end(kMagic), data)
+            || readBytes(data + 4, 2) != kVersion)
+            return false;
+
+        GainEnvelope::Info info;
+        info.numChannels = static_cast<size_t>(readBytes(data + 6, 2));
+        info.numTracks = static_cast<size_t>(readBytes(data + 8, 2));
+        info.sampleRate = static_cast<uint32_t>(readBytes(data + 12, 4));
+        info.decimation = static_cast<size_t>(readBytes(data + 16, 4));
+        info.pointsPerBlock = static_cast<size_t>(readBytes(data + 20, 4));
+        info.numSamples = readBytes(data + 28, 8);
+        info.numBlocks = static_cast<size_t>(readBytes(data + 36, 4));
+
+        uint32_t stepBits = static_cast<uint32_t>(readBytes(data + 24, 4));
+        std::memcpy(&info.stepDb, &stepBits, sizeof(stepBits));
+
+        uint64_t numPoints = info.getNumPoints();
+        size_t tableSize = 2 * info.numChannels + 8 * info.numBlocks;
+
+        if (info.numTracks == 0 || info.decimation == 0 || info.pointsPerBlock == 0
+            || info.numBlocks != (numPoints + info.pointsPerBlock - 1) / info.pointsPerBlock
+            || size < kHeaderSize + tableSize)
+            return false;
+
+        channelTracks_.resize(info.numChannels);
+
+        for (size_t ch = 0; ch < info.numChannels; ++ch)
+        {
+            channelTracks_[ch] = static_cast<size_t>(readBytes(data + kHeaderSize + 2 * ch, 2));
+
+            if (channelTracks_[ch] >= info.numTracks)
+                return false;
+        }
+
+        blockOffsets_.resize(info.numBlocks + 1);
+
+        for (size_t b = 0; b < info.numBlocks; ++b)
+            blockOffsets_[b] = readBytes(data + kHeaderSize + 2 * info.numChannels + 8 * b, 8);
+
+        blockOffsets_[info.numBlocks] = size;
+
+        for (size_t b = 0; b < info.numBlocks; ++b)
+            if (blockOffsets_[b] < kHeaderSize + tableSize || blockOffsets_[b] > blockOffsets_[b + 1])
+                return false;
+
+        data_ = data;
+        info_ = info;
+        numPoints_ = numPoints;
+
+        // One block of points plus the first point of the next block
+        gains_.assign((info_.pointsPerBlock + 1) * info_.numTracks, 1.0f);
+        values_.assign(info_.numTracks, 0);
+        decodedBlock_ = std::numeric_limits<size_t>::max();
+        position_ = 0;
+
+        return true;
+    }
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    const GainEnvelope::Info& getInfo() const { return info_; }
+
+    /** Bytes held by the player besides the file itself. */
+    size_t getMemoryBytes() const
+    {
+        return sizeof(*this) + gains_.capacity() * sizeof(float) + values_.capacity() * sizeof(int32_t)
+               + channelTracks_.capacity() * sizeof(size_t) + blockOffsets_.capacity() * sizeof(uint64_t);
+    }
+
+    /** Continue playback from a sample position. */
+    void seek(uint64_t sample) { position_ = sample; }
+
+    uint64_t getPosition() const { return position_; }
+
+    /** Multiply the next numSamples of audio by the envelope.
+
+        Channels beyond those in the file use the track of the last channel.
+        Blocks that fail to decode (a truncated file) are played at unity gain.
+    */
+    void process(float* const* channels, size_t numChannels, size_t numSamples)
+    {
+        if (!isOpen() || numChannels == 0)
+            return;
+
+        size_t done = 0;
+
+        while (done < numSamples)
+        {
+            uint64_t point = position_ / info_.decimation;
+            size_t offset = static_cast<size_t>(position_ % info_.decimation);
+            size_t count = std::min(info_.decimation - offset, numSamples - done);
+
+            // Past the end: hold the last point (unity if there is none)
+            uint64_t lastPoint = numPoints_ > 0 ? numPoints_ - 1 : 0;
+            bool holding = point >= lastPoint;
+            uint64_t startPoint = holding ? lastPoint : point;
+
+            const float* startGains = getPoint(startPoint);
+            const float* endGains = holding ? startGains : startGains + info_.numTracks;
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                size_t track = info_.numChannels > 0 ? channelTracks_[std::min(ch, info_.numChannels - 1)] : 0;
+                float slope = (endGains[track] - startGains[track]) / static_cast<float>(info_.decimation);
+
+                applyRamp(channels[ch] + done, count, startGains[track] + slope * static_cast<float>(offset), slope);
+            }
+
+            position_ += count;
+            done += count;
+        }
+    }
+
+private:
+    /** Linear gains of a point, decoding its block if needed. The gains of
+        the following point come right after, also across blocks.
+    */
+    const float* getPoint(uint64_t point)
+    {
+        if (numPoints_ == 0)
+            return gains_.data();
+
+        size_t block = static_cast<size_t>(point / info_.pointsPerBlock);
+
+        if (block != decodedBlock_)
+            decodeBlock(block);
+
+        return gains_.data() + static_cast<size_t>(point % info_.pointsPerBlock) * info_.numTracks;
+    }
+
+    void decodeBlock(size_t block)
+    {
+        decodedBlock_ = block;
+
+        size_t numBlockPoints = static_cast<size_t>(
+            std::min<uint64_t>(info_.pointsPerBlock, numPoints_ - static_cast<uint64_t>(block) * info_.pointsPerBlock));
+
+        if (!decodePoints(block, numBlockPoints, gains_.data()))
+        {
+            std::fill(gains_.begin(), gains_.end(), 1.0f);
+            return;
+        }
+
+        if (block + 1 < info_.numBlocks && !decodePoints(block + 1, 1, gains_.data() + info_.pointsPerBlock * info_.numTracks))
+            std::fill(gains_.begin() + static_cast<std::ptrdiff_t>(info_.pointsPerBlock * info_.numTracks), gains_.end(), 1.0f);
+    }
+
+    bool decodePoints(size_t block, size_t numBlockPoints, float* destination)
+    {
+        const uint8_t* read = data_ + blockOffsets_[block];
+        const uint8_t* end = data_ + blockOffsets_[block + 1];
+        float log2PerStep = FastMath::kLog2PerDb * info_.stepDb;
+
+        for (size_t p = 0; p < numBlockPoints; ++p)
+        {
+            for (size_t t = 0; t < info_.numTracks; ++t)
+            {
+                int32_t value;
+
+                if (!GainEnvelope::readVarint(read, end, value))
+                    return false;
+
+                values_[t] = p == 0 ? value : values_[t] + value;
+                destination[p * info_.numTracks + t] = fastExp2(log2PerStep * static_cast<float>(values_[t]));
+            }
+        }
+
+        return true;
+    }
+
+    static void applyRamp(float* data, size_t numSamples, float gain, float slope)
+    {
+        size_t i = 0;
+
+        if (numSamples >= SIMD::kWidth)
+        {
+            SIMD::Float gains = SIMD::ramp(gain, slope);
+            SIMD::Float step = SIMD::broadcast(slope * static_cast<float>(SIMD::kWidth));
+
+            for (; i + SIMD::kWidth <= numSamples; i += SIMD::kWidth)
+            {
+                SIMD::store(data + i, SIMD::mul(SIMD::load(data + i), gains));
+                gains = SIMD::add(gains, step);
+            }
+        }
+
+        for (; i < numSamples; ++i)
+            data[i] *= gain + slope * static_cast<float>(i);
+    }
+
+    const uint8_t* data_ = nullptr;
+    GainEnvelope::Info info_;
+    uint64_t numPoints_ = 0;
+
+    std::vector<size_t> channelTracks_;
+    std::vector<uint64_t> blockOffsets_;
+
+    std::vector<float> gains_;
+    std::vector<int32_t> values_;
+    size_t decodedBlock_ = std::numeric_limits<size_t>::max();
+    uint64_t position_ = 0;
+};
+
+} // namespace DSP
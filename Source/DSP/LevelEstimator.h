@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Utilities.h"
+#include "SIMD.h"
 #include <cstddef>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 
@@ -13,6 +15,11 @@ namespace DSP
 
     This class estimates the level of an audio signal using a peak detector
     with configurable attack, hold, and release characteristics.
+
+    The detector recursion is serial in time, so a single channel can't be
+    vectorized. estimateLevelMultichannel() instead runs SIMD::kWidth
+    channels side by side, one per vector lane, so 4/8/16 channels cost
+    about as much as one or two.
 */
 class LevelEstimator
 {
@@ -99,9 +106,43 @@ public:
     float getHoldTimeMs() const { return holdTimeSec_ * 1000.0f; }
     size_t getHoldTimeSamples() const { return holdTimeSamples_; }
 
+    /** Samples after which two estimators fed the same input agree to within
+        residual times their initial difference. Every sample moves both
+        estimates toward the input by at least the smaller coefficient, so the
+        difference shrinks geometrically; a hold can pause it for the hold time.
+        @param residual Remaining fraction of the initial difference (0 to 1)
+    */
+    size_t getSettleSamples(float residual) const
+    {
+        double coefficient = std::min(attackCoefficient_, releaseCoefficient_);
+
+        if (coefficient >= 1.0 || residual >= 1.0f)
+            return holdTimeSamples_;
+
+        double decaySamples = std::log(std::max(static_cast<double>(residual), 1.0e-30)) / std::log1p(-coefficient);
+        return holdTimeSamples_ + static_cast<size_t>(std::ceil(decaySamples));
+    }
+
     //==============================================================================
     // Processing
 
+    /** Advance a state over numSamples of digital silence without processing
+        them: the hold runs out, then the estimate releases toward zero. The
+        release is applied in one step, so it can differ from per-sample
+        processing by rounding, and input below the silence floor is taken
+        as zero, where processing it would hold the estimate at its level.
+        Either way the estimate only differs far below any threshold.
+    */
+    void skipSilence(State& state, size_t numSamples) const
+    {
+        size_t holding = state.holdCount < holdTimeSamples_ ? std::min(numSamples, holdTimeSamples_ - state.holdCount)
+                                                            : 0;
+        state.holdCount += holding;
+
+        if (numSamples > holding)
+            state.levelEstimate *= std::pow(1.0f - releaseCoefficient_, static_cast<float>(numSamples - holding));
+    }
+
     /** Process a buffer of audio samples and estimate the level.
 
         @param input        Pointer to input samples
@@ -114,29 +155,10 @@ public:
                        size_t numSamples,
                        State& state) const
     {
-        for (size_t i = 0; i < numSamples; ++i)
-        {
-            float level = std::fabs(input[i]);
-
-            if (level > state.levelEstimate)
-            {
-                // Attack phase: level is increasing
-                state.levelEstimate += (level - state.levelEstimate) * attackCoefficient_;
-                state.holdCount = 0;
-            }
-            else if (state.holdCount < holdTimeSamples_)
-            {
-                // Hold phase: maintain current level
-                state.holdCount++;
-            }
-            else
-            {
-                // Release phase: level is decreasing
-                state.levelEstimate += (level - state.levelEstimate) * releaseCoefficient_;
-            }
-
-            levelOutput[i] = state.levelEstimate;
-        }
+        if (holdTimeSamples_ > 0)
+            estimateLevelKernel<true, false>(input, levelOutput, numSamples, state);
+        else
+            estimateLevelKernel<false, false>(input, levelOutput, numSamples, state);
     }
 
     /** Process a buffer with linked mode (use max level across channels).
@@ -153,43 +175,217 @@ public:
                              State& state,
                              bool linked) const
     {
+        if (linked)
+        {
+            if (holdTimeSamples_ > 0)
+                estimateLevelKernel<true, true>(input, levelOutput, numSamples, state);
+            else
+                estimateLevelKernel<false, true>(input, levelOutput, numSamples, state);
+        }
+        else
+        {
+            estimateLevel(input, levelOutput, numSamples, state);
+        }
+    }
+
+    /** Level detector specialized at compile time.
+
+        With Hold == false the attack/release choice reduces to a select that
+        the compiler can if-convert; it gives the same result as the hold
+        path whenever the hold time is zero.
+
+        @tparam Hold       Whether the hold stage is evaluated
+        @tparam Accumulate If true, take the max with the existing levelOutput value
+    */
+    template <bool Hold, bool Accumulate>
+    void estimateLevelKernel(const float* input,
+                             float* levelOutput,
+                             size_t numSamples,
+                             State& state) const
+    {
+        float levelEstimate = state.levelEstimate;
+        size_t holdCount = state.holdCount;
+        bool attacked = false;
+
         for (size_t i = 0; i < numSamples; ++i)
         {
             float level = std::fabs(input[i]);
 
-            if (level > state.levelEstimate)
+            if (Hold)
             {
-                // Attack phase
-                state.levelEstimate += (level - state.levelEstimate) * attackCoefficient_;
-                state.holdCount = 0;
+                if (level > levelEstimate)
+                {
+                    // Attack phase: level is increasing
+                    levelEstimate += (level - levelEstimate) * attackCoefficient_;
+                    holdCount = 0;
+                }
+                else if (holdCount < holdTimeSamples_)
+                {
+                    // Hold phase: maintain current level
+                    holdCount++;
+                }
+                else
+                {
+                    // Release phase: level is decreasing
+                    levelEstimate += (level - levelEstimate) * releaseCoefficient_;
+                }
             }
-            else if (state.holdCount < holdTimeSamples_)
+            else
             {
-                // Hold phase
-                state.holdCount++;
+                // Attack or release, without a hold stage
+                bool attack = level > levelEstimate;
+                float coefficient = attack ? attackCoefficient_ : releaseCoefficient_;
+                levelEstimate += (level - levelEstimate) * coefficient;
+                attacked |= attack;
             }
+
+            if (Accumulate)
+                levelOutput[i] = std::max(levelOutput[i], levelEstimate);
             else
+                levelOutput[i] = levelEstimate;
+        }
+
+        // An attack restarts the hold counter, as in the hold path, in case
+        // hold is switched on later
+        state.levelEstimate = levelEstimate;
+        state.holdCount = attacked ? 0 : holdCount;
+    }
+
+    /** Estimate the levels of several channels at once.
+
+        Channels are processed SIMD::kWidth at a time with one channel per
+        vector lane: short tiles of each channel are interleaved on the
+        stack, the recursion runs once per sample for all lanes, and the
+        estimates are de-interleaved into the outputs. The result matches
+        estimateLevelKernel<Hold, false> per channel.
+
+        @param inputs       One input pointer per channel
+        @param levelOutputs One output pointer per channel
+        @param states       One state pointer per channel
+        @param numChannels  Number of channels
+        @param numSamples   Number of samples per channel
+    */
+    template <bool Hold>
+    void estimateLevelMultichannel(const float* const* inputs,
+                                   float* const* levelOutputs,
+                                   State* const* states,
+                                   size_t numChannels,
+                                   size_t numSamples) const
+    {
+        size_t ch = 0;
+
+        if (SIMD::kWidth > 1)
+        {
+            // A lone trailing channel is cheaper on the scalar path
+            for (; ch + 1 < numChannels; ch += SIMD::kWidth)
+            {
+                size_t numLanes = std::min(SIMD::kWidth, numChannels - ch);
+                estimateLanes<Hold>(inputs + ch, levelOutputs + ch, states + ch, numLanes, numSamples);
+            }
+        }
+
+        for (; ch < numChannels; ++ch)
+            estimateLevelKernel<Hold, false>(inputs[ch], levelOutputs[ch], numSamples, *states[ch]);
+    }
+
+private:
+    //==============================================================================
+    static constexpr size_t kLaneTileSize = 32;
+
+    template <bool Hold>
+    void estimateLanes(const float* const* inputs,
+                       float* const* levelOutputs,
+                       State* const* states,
+                       size_t numLanes,
+                       size_t numSamples) const
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        // Unused lanes see silence and are never written back
+        float tile[kLaneTileSize * width] = {};
+        float laneEstimates[width] = {};
+        float laneHoldCounts[width] = {};
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            laneEstimates[lane] = states[lane]->levelEstimate;
+            laneHoldCounts[lane] = static_cast<float>(states[lane]->holdCount);
+        }
+
+        const SIMD::Float zero = SIMD::broadcast(0.0f);
+        const SIMD::Float one = SIMD::broadcast(1.0f);
+        const SIMD::Float attackCoefficient = SIMD::broadcast(attackCoefficient_);
+        const SIMD::Float releaseCoefficient = SIMD::broadcast(releaseCoefficient_);
+        const SIMD::Float holdTime = SIMD::broadcast(static_cast<float>(holdTimeSamples_));
+
+        // Hold counts are exact in float up to 2^24 samples
+        SIMD::Float levelEstimate = SIMD::load(laneEstimates);
+        SIMD::Float holdCount = SIMD::load(laneHoldCounts);
+        SIMD::Float attacked = zero;
+
+        for (size_t start = 0; start < numSamples; start += kLaneTileSize)
+        {
+            size_t length = std::min(kLaneTileSize, numSamples - start);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                for (size_t i = 0; i < length; ++i)
+                    tile[i * width + lane] = inputs[lane][start + i];
+
+            for (size_t i = 0; i < length; ++i)
             {
-                // Release phase
-                state.levelEstimate += (level - state.levelEstimate) * releaseCoefficient_;
+                SIMD::Float level = SIMD::abs(SIMD::load(tile + i * width));
+                SIMD::Float attack = SIMD::greaterThan(level, levelEstimate);
+                SIMD::Float coefficient;
+
+                if (Hold)
+                {
+                    // Holding lanes use a zero coefficient, leaving the estimate unchanged
+                    SIMD::Float holding = SIMD::andNot(attack, SIMD::greaterThan(holdTime, holdCount));
+                    coefficient = SIMD::select(attack, attackCoefficient,
+                                               SIMD::select(holding, zero, releaseCoefficient));
+                    holdCount = SIMD::select(attack, zero,
+                                             SIMD::select(holding, SIMD::add(holdCount, one), holdCount));
+                }
+                else
+                {
+                    coefficient = SIMD::select(attack, attackCoefficient, releaseCoefficient);
+                    attacked = SIMD::bitOr(attacked, attack);
+                }
+
+                levelEstimate = SIMD::add(levelEstimate, SIMD::mul(SIMD::sub(level, levelEstimate), coefficient));
+                SIMD::store(tile + i * width, levelEstimate);
             }
 
-            level = state.levelEstimate;
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                for (size_t i = 0; i < length; ++i)
+                    levelOutputs[lane][start + i] = tile[i * width + lane];
+        }
+
+        float laneAttacked[width];
+        SIMD::store(laneEstimates, levelEstimate);
+        SIMD::store(laneHoldCounts, holdCount);
+        SIMD::store(laneAttacked, attacked);
 
-            if (linked)
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            states[lane]->levelEstimate = laneEstimates[lane];
+
+            if (Hold)
             {
-                // Take max of this channel's level and existing level
-                if (level > levelOutput[i])
-                    levelOutput[i] = level;
+                states[lane]->holdCount = static_cast<size_t>(laneHoldCounts[lane]);
             }
             else
             {
-                levelOutput[i] = level;
+                // Same hold counter bookkeeping as estimateLevelKernel
+                uint32_t bits;
+                std::memcpy(&bits, &laneAttacked[lane], sizeof(bits));
+
+                if (bits != 0)
+                    states[lane]->holdCount = 0;
             }
         }
     }
 
-private:
     void updateCoefficients()
     {
         attackCoefficient_ = timeConstantToCoefficient(attackTimeSec_, sampleRateHz_);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace DSP
+{
+
+/**
+    Linear parameter ramp, without JUCE.
+
+    Follows the same arithmetic as juce::SmoothedValue<float> in linear mode
+    (fixed step count, step = remaining distance / steps, snap to the target
+    on the last step), so code moved off SmoothedValue produces bit-identical
+    output.
+*/
+class LinearSmoother
+{
+public:
+    LinearSmoother() = default;
+
+    /** Set the ramp length and jump to the current target.
+        @param sampleRateHz  The sample rate in Hz
+        @param rampLengthSec Time to reach a new target, in seconds
+    */
+    void reset(double sampleRateHz, double rampLengthSec)
+    {
+        stepsToTarget_ = static_cast<int>(std::floor(rampLengthSec * sampleRateHz));
+        setCurrentAndTargetValue(target_);
+    }
+
+    /** Jump to a value without ramping. */
+    void setCurrentAndTargetValue(float value)
+    {
+        target_ = current_ = value;
+        countdown_ = 0;
+    }
+
+    /** Start a ramp from the current value to a new target. */
+    void setTargetValue(float value)
+    {
+        if (value == target_)
+            return;
+
+        if (stepsToTarget_ <= 0)
+        {
+            setCurrentAndTargetValue(value);
+            return;
+        }
+
+        target_ = value;
+        countdown_ = stepsToTarget_;
+        step_ = (target_ - current_) / static_cast<float>(countdown_);
+    }
+
+    /** Advance by one sample.
+        @return The smoothed value for this sample
+    */
+    float getNextValue()
+    {
+        if (!isSmoothing())
+            return target_;
+
+        --countdown_;
+
+        if (isSmoothing())
+            current_ += step_;
+        else
+            current_ = target_;
+
+        return current_;
+    }
+
+    /** Advance by a block, writing one value per sample.
+        @param output     Destination for the smoothed values
+        @param numSamples Number of samples to advance
+    */
+    void getNextValues(float* output, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+            output[i] = getNextValue();
+    }
+
+    bool isSmoothing() const { return countdown_ > 0; }
+    float getCurrentValue() const { return current_; }
+    float getTargetValue() const { return target_; }
+
+private:
+    float current_ = 0.0f;
+    float target_ = 0.0f;
+    float step_ = 0.0f;
+    int countdown_ = 0;
+    int stepsToTarget_ = 0;
+};
+
+} // namespace DSP
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+namespace DSP
+{
+
+/**
+    Decides how lookahead is realized and what latency is reported to the host.
+
+    Lookahead means the gain is computed from audio that is `lookahead`
+    samples ahead of the audio it is applied to. Two modes are supported:
+
+    - Variable latency (default): the audio is delayed by the lookahead and
+      the gain is applied undelayed. The reported latency follows the
+      lookahead, but only once it has stayed unchanged for the settle time,
+      so automating lookahead doesn't make the host redo delay compensation
+      on every block.
+
+    - Fixed latency: the audio is always delayed by the maximum lookahead and
+      the gain is delayed by (maximum - lookahead). The reported latency never
+      changes, so a session keeps constant PDC while lookahead is swept.
+
+    Processing can add latency of its own on either side of the gain: a
+    detector that runs late delays the audio by as much again, so the gain
+    still leads it by the lookahead (setDetectorLatency), and a stage after
+    the gain adds to the reported latency only (setOutputLatency).
+
+    The controller only computes delays; the caller owns the DelayLines and
+    should give them a crossfade so that tap changes are click-free.
+*/
+class LookaheadController
+{
+public:
+    LookaheadController() = default;
+
+    /** Prepare for processing.
+        @param sampleRateHz        The sample rate in Hz
+        @param maxLookaheadSamples Largest lookahead (and fixed-mode latency) in samples
+    */
+    void prepare(float sampleRateHz, size_t maxLookaheadSamples)
+    {
+        sampleRateHz_ = sampleRateHz;
+        maxLookaheadSamples_ = maxLookaheadSamples;
+        lookaheadSamples_ = std::min(lookaheadSamples_, maxLookaheadSamples_);
+        updateSettleSamples();
+        reset();
+    }
+
+    /** Report the current latency immediately, discarding any pending change. */
+    void reset()
+    {
+        reportedLatency_ = pendingLatency_ = getLatencySamples();
+        stableSamples_ = 0;
+    }
+
+    //==============================================================================
+    // Configuration
+
+    void setLookaheadMs(float lookaheadMs)
+    {
+        float samples = std::max(0.0f, lookaheadMs * sampleRateHz_ / 1000.0f);
+        lookaheadSamples_ = std::min(static_cast<size_t>(samples), maxLookaheadSamples_);
+    }
+
+    size_t getLookaheadSamples() const { return lookaheadSamples_; }
+    size_t getMaxLookaheadSamples() const { return maxLookaheadSamples_; }
+
+    void setFixedLatency(bool shouldUseFixedLatency) { fixedLatency_ = shouldUseFixedLatency; }
+    bool isFixedLatency() const { return fixedLatency_; }
+
+    /** Set how long a new latency must stay unchanged before it is reported. */
+    void setSettleTimeMs(float settleTimeMs)
+    {
+        settleTimeMs_ = std::max(0.0f, settleTimeMs);
+        updateSettleSamples();
+    }
+
+    float getSettleTimeMs() const { return settleTimeMs_; }
+
+    /** Set how far the detector's view of the input lags the input itself. */
+    void setDetectorLatency(size_t latencySamples) { detectorLatency_ = latencySamples; }
+    size_t getDetectorLatency() const { return detectorLatency_; }
+
+    /** Set the latency added after the gain is applied. */
+    void setOutputLatency(size_t latencySamples) { outputLatency_ = latencySamples; }
+    size_t getOutputLatency() const { return outputLatency_; }
+
+    //==============================================================================
+    // Delays
+
+    /** Delay to apply to the audio path (including the detector latency). */
+    size_t getAudioDelaySamples() const
+    {
+        return (fixedLatency_ ? maxLookaheadSamples_ : lookaheadSamples_) + detectorLatency_;
+    }
+
+    /** Delay to apply to the gain signal (non-zero only in fixed latency mode). */
+    size_t getGainDelaySamples() const
+    {
+        return fixedLatency_ ? maxLookaheadSamples_ - lookaheadSamples_ : 0;
+    }
+
+    //==============================================================================
+    // Latency reporting
+
+    /** Advance the settle timer after processing a block.
+        @param numSamples Number of samples just processed
+        @return True if the reported latency changed
+    */
+    bool advance(size_t numSamples)
+    {
+        size_t latency = getLatencySamples();
+
+        if (latency == reportedLatency_)
+        {
+            pendingLatency_ = latency;
+            stableSamples_ = 0;
+            return false;
+        }
+
+        if (latency != pendingLatency_)
+        {
+            pendingLatency_ = latency;
+            stableSamples_ = 0;
+        }
+
+        stableSamples_ += numSamples;
+
+        if (stableSamples_ < settleSamples_)
+            return false;
+
+        reportedLatency_ = latency;
+        stableSamples_ = 0;
+        return true;
+    }
+
+    /** The latency of the current settings: the audio delay and the output latency. */
+    size_t getLatencySamples() const { return getAudioDelaySamples() + outputLatency_; }
+
+    /** The latency that should currently be reported to the host. */
+    size_t getReportedLatencySamples() const { return reportedLatency_; }
+
+private:
+    void updateSettleSamples()
+    {
+        settleSamples_ = static_cast<size_t>(settleTimeMs_ * sampleRateHz_ / 1000.0f);
+    }
+
+    float sampleRateHz_ = 44100.0f;
+    size_t maxLookaheadSamples_ = 0;
+    size_t lookaheadSamples_ = 0;
+    bool fixedLatency_ = false;
+    size_t detectorLatency_ = 0;
+    size_t outputLatency_ = 0;
+
+    float settleTimeMs_ = 250.0f;
+    size_t settleSamples_ = 0;
+
+    size_t reportedLatency_ = 0;
+    size_t pendingLatency_ = 0;
+    size_t stableSamples_ = 0;
+};
+
+} // namespace DSP
@@ -0,0 +1,621 @@
+#pragma once
+
+#include "CompressorSettings.h"
+#include "FastMath.h"
+#include "PeakLookahead.h"
+#include "SIMD.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    Runs one input through many compressor settings at once, for tuning.
+
+    Every SIMD lane carries its own threshold, ratio, knee, attack, release
+    and hold, and kVectorsPerGroup vectors are stepped together, so a group
+    of kLanesPerGroup settings costs about as much as a couple of engine
+    passes. The input is broadcast to all lanes, so unlike
+    LevelEstimator::estimateLevelMultichannel nothing is interleaved. The
+    independent vectors also hide the latency of the detector recursion.
+
+    The settings shared by every lane (input and output gain, lookahead,
+    peak lookahead, gain rate, detector, link mode and channel groups) are
+    taken from a prepared Compressor, which must be broadband and not
+    oversampled (see Compressor::setNumBands and setOversampling).
+    Each lane matches that Compressor, reset and then run with the lane's
+    settings, with its latency removed. The curve is evaluated with the
+    general (soft knee, finite ratio) formula and the detector with the
+    hold stage; both give the same results as the specialized loops.
+
+    Instead of audio the sweep produces, per lane, the largest gain
+    reduction, the output peak and RMS, and a gain envelope (the lowest
+    gain of each interval). Audio is written only if outputs are given.
+*/
+class ParameterSweep
+{
+public:
+    /** Vectors stepped together; each lane of each vector is one setting. */
+    static constexpr size_t kVectorsPerGroup = 2;
+
+    /** Settings processed by one call to process(). */
+    static constexpr size_t kLanesPerGroup = kVectorsPerGroup * SIMD::kWidth;
+
+    /** Samples per pass through all stages. */
+    static constexpr size_t kBlockSize = 256;
+
+    /** Output statistics of one setting. */
+    struct Summary
+    {
+        float maxGainReductionDb = 0.0f;  // Zero or positive
+        float outputPeak = 0.0f;          // Linear
+        double sumOfSquares = 0.0;        // Of every output sample
+        size_t numSamples = 0;            // Output samples in sumOfSquares (frames x channels)
+        std::vector<float> envelopeDb;    // Lowest gain of each envelope interval (zero or negative)
+
+        float getOutputPeakDb() const { return mag2Db(outputPeak); }
+
+        float getOutputRmsDb() const
+        {
+            return numSamples > 0 ? mag2Db(static_cast<float>(std::sqrt(sumOfSquares / static_cast<double>(numSamples))))
+                                  : negativeInfinity<float>();
+        }
+
+        /** Peak to RMS ratio of the output, in dB. */
+        float getCrestFactorDb() const { return getOutputPeakDb() - getOutputRmsDb(); }
+    };
+
+    ParameterSweep() = default;
+
+    /** Take the shared settings and allocate all storage.
+        @param compressor       Prepared engine with the shared settings applied
+        @param sampleRateHz     The sample rate in Hz (as given to the compressor)
+        @param envelopeInterval Samples per envelope value, or 0 for no envelope
+    */
+    void prepare(const Compressor& compressor, double sampleRateHz, size_t envelopeInterval)
+    {
+        sampleRateHz_ = static_cast<float>(sampleRateHz);
+        routing_ = compressor.getRouting();
+        numChannels_ = compressor.getNumChannels();
+        lookaheadSamples_ = compressor.getLookahead().getLookaheadSamples();
+        latencySamples_ = std::max(compressor.getReportedLatencySamples(), lookaheadSamples_);
+        inputGain_ = compressor.getInputGain();
+        outputGain_ = compressor.getOutputGain();
+        envelopeInterval_ = envelopeInterval;
+        gainDecimation_ = compressor.getGainDecimation();
+        logGain_ = compressor.getDetector() == Compressor::Detector::logGain;
+
+        // One window per group and lane
+        size_t numWindows = compressor.isPeakLookahead() && lookaheadSamples_ > 0
+                                ? routing_.groups.size() * kLanesPerGroup
+                                : 0;
+        peakLookaheads_.resize(numWindows);
+
+        for (auto& window : peakLookaheads_)
+        {
+            window.prepare(lookaheadSamples_);
+            window.setLookahead(lookaheadSamples_);
+        }
+
+        gainedInput_.assign(numChannels_ * kBlockSize, 0.0f);
+        levels_.assign(kBlockSize * kLanesPerGroup, 0.0f);
+        gains_.assign(kBlockSize * kLanesPerGroup, 0.0f);
+        gainsLog2_.assign(kBlockSize * kLanesPerGroup, 0.0f);
+        controlGains_.assign(routing_.groups.size() * kLanesPerGroup, 1.0f);
+        estimates_.assign(routing_.detectors.size() * kLanesPerGroup, 0.0f);
+        holdCounts_.assign(routing_.detectors.size() * kLanesPerGroup, 0.0f);
+    }
+
+    /** Render the input with up to kLanesPerGroup settings.
+
+        Only the threshold, ratio, knee, attack, release and hold of each
+        setting are used. The output of each lane is aligned with the input
+        and runs for numSamples; the lookahead tail is flushed with silence.
+
+        @param input      One pointer per prepared channel, numSamples each
+        @param numSamples Length of the input
+        @param settings   One setting per lane
+        @param numLanes   Number of settings (at most kLanesPerGroup)
+        @param summaries  One summary per lane, overwritten
+        @param outputs    Optional output audio: outputs[lane][channel], numSamples each
+    */
+    void process(const float* const* input, size_t numSamples, const CompressorSettings* settings, size_t numLanes,
+                 Summary* summaries, float* const* const* outputs = nullptr)
+    {
+        numLanes = std::min(numLanes, kLanesPerGroup);
+
+        if (numLanes == 0)
+            return;
+
+        setLanes(settings, numLanes);
+
+        std::fill(estimates_.begin(), estimates_.end(), 0.0f);
+        std::fill(holdCounts_.begin(), holdCounts_.end(), 0.0f);
+        std::fill(controlGains_.begin(), controlGains_.end(), 1.0f);
+
+        for (auto& window : peakLookaheads_)
+            window.reset();
+
+        size_t numIntervals = envelopeInterval_ > 0 ? (numSamples + envelopeInterval_ - 1) / envelopeInterval_ : 0;
+
+        // Gains are logged in log2 units and converted at the end
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            summaries[lane] = Summary();
+            summaries[lane].envelopeDb.assign(numIntervals, 0.0f);
+        }
+
+        float minGainLog2[kLanesPerGroup];
+        float peaks[kLanesPerGroup];
+        double sumsOfSquares[kLanesPerGroup] = {};
+        std::fill(std::begin(minGainLog2), std::end(minGainLog2), 0.0f);
+        std::fill(std::begin(peaks), std::end(peaks), 0.0f);
+
+        // Gain at time t applies to the input at t - lookahead. A render
+        // flushes the reported latency, which can be longer (fixed latency),
+        // and the last control interval sees the silence it flushes
+        const size_t total = numSamples + lookaheadSamples_;
+        const size_t flushed = numSamples + latencySamples_;
+
+        for (size_t start = 0; start < total; start += kBlockSize)
+        {
+            size_t length = std::min(kBlockSize, flushed - start);
+            size_t last = std::min(length, total - start);
+
+            // Gained input, as the engine's detectors see it; silent past the end
+            for (size_t ch = 0; ch < numChannels_; ++ch)
+            {
+                float* gained = gainedInput_.data() + ch * kBlockSize;
+                size_t numInput = start < numSamples ? std::min(length, numSamples - start) : 0;
+
+                for (size_t i = 0; i < numInput; ++i)
+                    gained[i] = input[ch][start + i] * inputGain_;
+
+                std::fill(gained + numInput, gained + length, 0.0f);
+            }
+
+            // Samples [first, last) of this block produce output
+            size_t first = start >= lookaheadSamples_ ? 0 : std::min(last, lookaheadSamples_ - start);
+            size_t outputStart = start + first - lookaheadSamples_;
+
+            for (size_t g = 0; g < routing_.groups.size(); ++g)
+            {
+                const auto& group = routing_.groups[g];
+
+                if (logGain_)
+                {
+                    estimateReductions(g, length);
+                }
+                else
+                {
+                    for (size_t k = 0; k < group.numDetectors; ++k)
+                    {
+                        size_t detector = group.firstDetector + k;
+                        const float* gained = gainedInput_.data() + routing_.detectors[detector] * kBlockSize;
+
+                        // Linked groups follow their loudest detector
+                        if (k == 0)
+                            estimateLevels<false>(gained, detector, length);
+                        else
+                            estimateLevels<true>(gained, detector, length);
+                    }
+
+                    if (gainDecimation_ > 1)
+                        computeControlRateGains(g, length);
+                    else
+                        computeGains(length);
+                }
+
+                if (!peakLookaheads_.empty())
+                    holdPeaks(g, length);
+
+                if (first == last)
+                    continue;
+
+                trackGainReduction(first, last, outputStart, minGainLog2, summaries, numLanes);
+
+                for (size_t m = 0; m < group.numMembers; ++m)
+                {
+                    size_t ch = routing_.members[group.firstMember + m];
+                    applyGains(input[ch] + outputStart, first, last, peaks, sumsOfSquares,
+                               outputs, ch, outputStart, numLanes);
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            auto& summary = summaries[lane];
+            summary.maxGainReductionDb = -minGainLog2[lane] * FastMath::kDbPerLog2;
+            summary.outputPeak = peaks[lane];
+            summary.sumOfSquares = sumsOfSquares[lane];
+            summary.numSamples = numSamples * numChannels_;
+
+            for (auto& value : summary.envelopeDb)
+                value *= FastMath::kDbPerLog2;
+        }
+    }
+
+private:
+    //==============================================================================
+    /** Per-lane coefficients, as the engine derives them from each setting.
+        Unused lanes repeat the first setting and are never read back. */
+    void setLanes(const CompressorSettings* settings, size_t numLanes)
+    {
+        for (size_t lane = 0; lane < kLanesPerGroup; ++lane)
+        {
+            const CompressorSettings& setting = settings[lane < numLanes ? lane : 0];
+
+            LevelEstimator estimator(sampleRateHz_);
+            estimator.setAttackTimeMs(setting.attackTimeMs);
+            estimator.setReleaseTimeMs(setting.releaseTimeMs);
+            estimator.setHoldTimeMs(setting.holdTimeMs);
+
+            CompressionCurve curve;
+            curve.setSmoothing(CompressionCurve::Smoothing::block);
+            curve.setThresholdDb(setting.thresholdDb);
+            curve.setCompressionRatio(setting.ratio);
+            curve.setKneeWidthDb(setting.kneeWidthDb);
+
+            const auto& c = curve.getTargetCoefficients();
+            attackCoefficients_[lane] = estimator.getAttackCoefficient();
+            releaseCoefficients_[lane] = estimator.getReleaseCoefficient();
+            holdTimes_[lane] = static_cast<float>(estimator.getHoldTimeSamples());
+            thresholds_[lane] = c.thresholdLog2;
+            knees_[lane] = c.kneeLog2;
+            halfKnees_[lane] = c.halfKneeLog2;
+            invTwoKnees_[lane] = c.invTwoKneeLog2;
+            slopes_[lane] = c.slope;
+        }
+    }
+
+    /** The LevelEstimator recursion with the hold stage, one setting per lane.
+        @tparam Accumulate If true, take the max with the levels already stored
+    */
+    template <bool Accumulate>
+    void estimateLevels(const float* gained, size_t detector, size_t numSamples)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        float* estimates = estimates_.data() + detector * kLanesPerGroup;
+        float* holdCounts = holdCounts_.data() + detector * kLanesPerGroup;
+
+        const SIMD::Float zero = SIMD::broadcast(0.0f);
+        const SIMD::Float one = SIMD::broadcast(1.0f);
+        SIMD::Float attackCoefficient[kVectorsPerGroup];
+        SIMD::Float releaseCoefficient[kVectorsPerGroup];
+        SIMD::Float holdTime[kVectorsPerGroup];
+        SIMD::Float estimate[kVectorsPerGroup];
+        SIMD::Float holdCount[kVectorsPerGroup];
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            attackCoefficient[v] = SIMD::load(attackCoefficients_ + v * width);
+            releaseCoefficient[v] = SIMD::load(releaseCoefficients_ + v * width);
+            holdTime[v] = SIMD::load(holdTimes_ + v * width);
+            estimate[v] = SIMD::load(estimates + v * width);
+            holdCount[v] = SIMD::load(holdCounts + v * width);
+        }
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            SIMD::Float level = SIMD::abs(SIMD::broadcast(gained[i]));
+            float* levels = levels_.data() + i * kLanesPerGroup;
+
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                // Holding lanes use a zero coefficient, leaving the estimate unchanged
+                SIMD::Float attack = SIMD::greaterThan(level, estimate[v]);
+                SIMD::Float holding = SIMD::andNot(attack, SIMD::greaterThan(holdTime[v], holdCount[v]));
+                SIMD::Float coefficient = SIMD::select(attack, attackCoefficient[v],
+                                                       SIMD::select(holding, zero, releaseCoefficient[v]));
+                holdCount[v] = SIMD::select(attack, zero,
+                                            SIMD::select(holding, SIMD::add(holdCount[v], one), holdCount[v]));
+                estimate[v] = SIMD::add(estimate[v], SIMD::mul(SIMD::sub(level, estimate[v]), coefficient));
+
+                if (Accumulate)
+                    SIMD::store(levels + v * width, SIMD::max(SIMD::load(levels + v * width), estimate[v]));
+                else
+                    SIMD::store(levels + v * width, estimate[v]);
+            }
+        }
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            SIMD::store(estimates + v * width, estimate[v]);
+            SIMD::store(holdCounts + v * width, holdCount[v]);
+        }
+    }
+
+    /** The log gain detector (see Compressor::setDetector): each lane's curve
+        on the group's loudest rectified input, then the LevelEstimator
+        recursion with the hold stage on the reduction. The state of group g
+        is kept in the slots of detector g. */
+    void estimateReductions(size_t group, size_t numSamples)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        const auto& detectors = routing_.groups[group];
+        float* estimates = estimates_.data() + group * kLanesPerGroup;
+        float* holdCounts = holdCounts_.data() + group * kLanesPerGroup;
+
+        CompressionCurve::VectorCoefficients c[kVectorsPerGroup];
+        loadCurves(c);
+
+        const SIMD::Float zero = SIMD::broadcast(0.0f);
+        const SIMD::Float one = SIMD::broadcast(1.0f);
+        SIMD::Float attackCoefficient[kVectorsPerGroup];
+        SIMD::Float releaseCoefficient[kVectorsPerGroup];
+        SIMD::Float holdTime[kVectorsPerGroup];
+        SIMD::Float estimate[kVectorsPerGroup];
+        SIMD::Float holdCount[kVectorsPerGroup];
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            attackCoefficient[v] = SIMD::load(attackCoefficients_ + v * width);
+            releaseCoefficient[v] = SIMD::load(releaseCoefficients_ + v * width);
+            holdTime[v] = SIMD::load(holdTimes_ + v * width);
+            estimate[v] = SIMD::load(estimates + v * width);
+            holdCount[v] = SIMD::load(holdCounts + v * width);
+        }
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            float magnitude = 0.0f;
+
+            for (size_t k = 0; k < detectors.numDetectors; ++k)
+            {
+                size_t ch = routing_.detectors[detectors.firstDetector + k];
+                float value = std::fabs(gainedInput_[ch * kBlockSize + i]);
+                magnitude = k == 0 ? value : std::max(magnitude, value);
+            }
+
+            SIMD::Float levelLog2 = fastLog2(SIMD::broadcast(magnitude));
+            size_t index = i * kLanesPerGroup;
+
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                SIMD::Float reduction = SIMD::abs(CompressionCurve::gainLog2<true, false>(levelLog2, c[v]));
+
+                SIMD::Float attack = SIMD::greaterThan(reduction, estimate[v]);
+                SIMD::Float holding = SIMD::andNot(attack, SIMD::greaterThan(holdTime[v], holdCount[v]));
+                SIMD::Float coefficient = SIMD::select(attack, attackCoefficient[v],
+                                                       SIMD::select(holding, zero, releaseCoefficient[v]));
+                holdCount[v] = SIMD::select(attack, zero,
+                                            SIMD::select(holding, SIMD::add(holdCount[v], one), holdCount[v]));
+                estimate[v] = SIMD::add(estimate[v], SIMD::mul(SIMD::sub(reduction, estimate[v]), coefficient));
+
+                SIMD::Float g = SIMD::sub(zero, estimate[v]);
+                SIMD::store(gainsLog2_.data() + index + v * width, g);
+                SIMD::store(gains_.data() + index + v * width, fastExp2(g));
+            }
+        }
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            SIMD::store(estimates + v * width, estimate[v]);
+            SIMD::store(holdCounts + v * width, holdCount[v]);
+        }
+    }
+
+    /** Each vector's curve coefficients. */
+    void loadCurves(CompressionCurve::VectorCoefficients* c) const
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            c[v] = { SIMD::load(thresholds_ + v * width), SIMD::load(knees_ + v * width),
+                     SIMD::load(halfKnees_ + v * width), SIMD::load(invTwoKnees_ + v * width),
+                     SIMD::load(slopes_ + v * width) };
+    }
+
+    /** Gains (linear and log2) of the levels, each lane on its own curve. */
+    void computeGains(size_t numSamples)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        CompressionCurve::VectorCoefficients c[kVectorsPerGroup];
+        loadCurves(c);
+
+        for (size_t i = 0; i < numSamples * kLanesPerGroup; i += kLanesPerGroup)
+        {
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                size_t index = i + v * width;
+                SIMD::Float g = CompressionCurve::gainLog2<true, false>(fastLog2(SIMD::load(levels_.data() + index)),
+                                                                        c[v]);
+                SIMD::store(gainsLog2_.data() + index, g);
+                SIMD::store(gains_.data() + index, fastExp2(g));
+            }
+        }
+    }
+
+    /** Gains at control rate, with the engine's intervals, points and ramps
+        (see Compressor::setGainDecimation). */
+    void computeControlRateGains(size_t group, size_t numSamples)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        CompressionCurve::VectorCoefficients c[kVectorsPerGroup];
+        loadCurves(c);
+
+        float* previous = controlGains_.data() + group * kLanesPerGroup;
+
+        for (size_t start = 0; start < numSamples; start += gainDecimation_)
+        {
+            size_t length = std::min(gainDecimation_, numSamples - start);
+            float invLength = 1.0f / static_cast<float>(length);
+
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                const float* levels = levels_.data() + start * kLanesPerGroup + v * width;
+                float* gains = gains_.data() + start * kLanesPerGroup + v * width;
+
+                SIMD::Float level = SIMD::load(levels);
+                for (size_t j = 1; j < length; ++j)
+                    level = SIMD::max(level, SIMD::load(levels + j * kLanesPerGroup));
+
+                SIMD::Float point = fastExp2(CompressionCurve::gainLog2<true, false>(fastLog2(level), c[v]));
+                SIMD::Float from = SIMD::load(previous + v * width);
+                SIMD::Float delta = SIMD::sub(point, from);
+
+                for (size_t j = 0; j + 1 < length; ++j)
+                {
+                    SIMD::Float fraction = SIMD::broadcast(static_cast<float>(j + 1) * invLength);
+                    SIMD::store(gains + j * kLanesPerGroup, SIMD::add(from, SIMD::mul(delta, fraction)));
+                }
+
+                SIMD::store(gains + (length - 1) * kLanesPerGroup, point);
+                SIMD::store(previous + v * width, point);
+            }
+        }
+
+        for (size_t i = 0; i < numSamples * kLanesPerGroup; i += SIMD::kWidth)
+            SIMD::store(gainsLog2_.data() + i, fastLog2(SIMD::load(gains_.data() + i)));
+    }
+
+    /** Run each lane's gains through its PeakLookahead, as the engine does per group. */
+    void holdPeaks(size_t group, size_t numSamples)
+    {
+        for (size_t lane = 0; lane < kLanesPerGroup; ++lane)
+            peakLookaheads_[group * kLanesPerGroup + lane].process(gains_.data() + lane, numSamples, kLanesPerGroup);
+
+        for (size_t i = 0; i < numSamples * kLanesPerGroup; i += SIMD::kWidth)
+            SIMD::store(gainsLog2_.data() + i, fastLog2(SIMD::load(gains_.data() + i)));
+    }
+
+    /** Fold the gains of output samples [first, last) into the lowest gain and the envelope. */
+    void trackGainReduction(size_t first, size_t last, size_t outputStart, float* minGainLog2,
+                            Summary* summaries, size_t numLanes)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        // One envelope interval at a time
+        for (size_t begin = first, end = first; begin < last; begin = end)
+        {
+            size_t position = outputStart + begin - first;
+            end = envelopeInterval_ > 0 ? std::min(last, begin + envelopeInterval_ - position % envelopeInterval_)
+                                        : last;
+
+            float intervalMin[kLanesPerGroup];
+
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                SIMD::Float lowest = SIMD::broadcast(0.0f);
+
+                for (size_t i = begin; i < end; ++i)
+                    lowest = SIMD::min(lowest, SIMD::load(gainsLog2_.data() + i * kLanesPerGroup + v * width));
+
+                SIMD::store(intervalMin + v * width, lowest);
+            }
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                minGainLog2[lane] = std::min(minGainLog2[lane], intervalMin[lane]);
+
+                if (envelopeInterval_ > 0)
+                {
+                    float& value = summaries[lane].envelopeDb[position / envelopeInterval_];
+                    value = std::min(value, intervalMin[lane]);
+                }
+            }
+        }
+    }
+
+    /** Apply the gains to one channel's delayed input and measure the output.
+        @param delayed The channel's input at the first output sample, before the input gain
+    */
+    void applyGains(const float* delayed, size_t first, size_t last, float* peaks, double* sumsOfSquares,
+                    float* const* const* outputs, size_t ch, size_t outputStart, size_t numLanes)
+    {
+        constexpr size_t width = SIMD::kWidth;
+
+        const SIMD::Float outputGain = SIMD::broadcast(outputGain_);
+        SIMD::Float peak[kVectorsPerGroup];
+        SIMD::Float sumOfSquares[kVectorsPerGroup];
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            peak[v] = SIMD::load(peaks + v * width);
+            sumOfSquares[v] = SIMD::broadcast(0.0f);
+        }
+
+        float lanes[kLanesPerGroup];
+
+        for (size_t i = first; i < last; ++i)
+        {
+            // Same operations, in the same order, as the engine's gain stage
+            SIMD::Float sample = SIMD::broadcast(delayed[i - first] * inputGain_);
+
+            for (size_t v = 0; v < kVectorsPerGroup; ++v)
+            {
+                SIMD::Float gain = SIMD::load(gains_.data() + i * kLanesPerGroup + v * width);
+                SIMD::Float y = SIMD::mul(SIMD::mul(sample, gain), outputGain);
+
+                peak[v] = SIMD::max(peak[v], SIMD::abs(y));
+                sumOfSquares[v] = SIMD::add(sumOfSquares[v], SIMD::mul(y, y));
+
+                if (outputs != nullptr)
+                    SIMD::store(lanes + v * width, y);
+            }
+
+            if (outputs != nullptr)
+                for (size_t lane = 0; lane < numLanes; ++lane)
+                    outputs[lane][ch][outputStart + i - first] = lanes[lane];
+        }
+
+        // Block sums are short enough for float; the file total is kept in double
+        float blockSums[kLanesPerGroup];
+
+        for (size_t v = 0; v < kVectorsPerGroup; ++v)
+        {
+            SIMD::store(peaks + v * width, peak[v]);
+            SIMD::store(blockSums + v * width, sumOfSquares[v]);
+        }
+
+        for (size_t lane = 0; lane < kLanesPerGroup; ++lane)
+            sumsOfSquares[lane] += blockSums[lane];
+    }
+
+    //==============================================================================
+    float sampleRateHz_ = 44100.0f;
+    Compressor::Routing routing_;
+    size_t numChannels_ = 0;
+    size_t lookaheadSamples_ = 0;
+    size_t latencySamples_ = 0;
+    float inputGain_ = 1.0f;
+    float outputGain_ = 1.0f;
+    size_t envelopeInterval_ = 0;
+    size_t gainDecimation_ = 1;
+    bool logGain_ = false;
+
+    // Per-lane settings
+    float attackCoefficients_[kLanesPerGroup] = {};
+    float releaseCoefficients_[kLanesPerGroup] = {};
+    float holdTimes_[kLanesPerGroup] = {};
+    float thresholds_[kLanesPerGroup] = {};
+    float knees_[kLanesPerGroup] = {};
+    float halfKnees_[kLanesPerGroup] = {};
+    float invTwoKnees_[kLanesPerGroup] = {};
+    float slopes_[kLanesPerGroup] = {};
+
+    // Per-block scratch, sample-major with kLanesPerGroup values per sample
+    std::vector<float> gainedInput_;
+    std::vector<float> levels_;
+    std::vector<float> gains_;
+    std::vector<float> gainsLog2_;
+
+    // Detector state, kLanesPerGroup values per detector
+    std::vector<float> estimates_;
+    std::vector<float> holdCounts_;
+
+    // Gain at the end of the last control interval, kLanesPerGroup per group
+    std::vector<float> controlGains_;
+
+    // Peak lookahead windows, kLanesPerGroup per group (none when off)
+    std::vector<PeakLookahead> peakLookaheads_;
+};
+
+} // namespace DSP
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Utilities.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    Turns a gain signal into one that reaches every reduction by the time
+    the delayed audio gets there.
+
+    Plain lookahead delays the audio, so the detector reacts L samples
+    early, but the gain can already be releasing again when a short
+    transient comes out of the delay. This stage runs on the gain of each
+    channel group, before it is applied to the delayed audio:
+
+      1. h[n] = min(g[n - L] ... g[n])     (lowest gain in the window)
+      2. y[n] = mean(h[n - L] ... h[n])    (ramp into it across the window)
+
+    Every h in the mean is at most g[n - L], the gain the audio now leaving
+    the delay asked for, so y never lets a transient through (y is also
+    clamped to g[n - L], so rounding in the mean can't either). 1 / (L + 1)
+    is rounded up, so a run of unity gains comes out exactly unity. The ramp
+    starts L samples before the transient and lands on its full reduction
+    as the transient arrives.
+
+    Both stages use the van Herk / Gil-Werman decomposition: the stream is
+    cut into segments of L + 1 samples, and a window is the tail of the
+    previous segment plus the head of the current one. Suffix minima and
+    sums of each finished segment are computed in one backward pass, and
+    the current segment only keeps a running minimum and sum. Each sample
+    then costs a few operations whatever L is, and the sums start afresh
+    with every segment, so they don't drift.
+*/
+class PeakLookahead
+{
+public:
+    PeakLookahead() = default;
+
+    /** Allocate for windows up to maxLookaheadSamples + 1 samples. */
+    void prepare(size_t maxLookaheadSamples)
+    {
+        size_t maxWindow = maxLookaheadSamples + 1;
+
+        gains_.assign(maxWindow, 0.0f);
+        minima_.assign(maxWindow, 0.0f);
+        suffixMin_.assign(maxWindow + 1, 0.0f);
+        suffixSum_.assign(maxWindow + 1, 0.0f);
+
+        window_ = std::min(window_, maxWindow);
+        reset();
+    }
+
+    /** Set the lookahead L. A change keeps the current gain for the new window. */
+    void setLookahead(size_t lookaheadSamples)
+    {
+        size_t window = std::max<size_t>(1, std::min(lookaheadSamples + 1, gains_.size()));
+
+        if (window == window_)
+            return;
+
+        window_ = window;
+
+        if (primed_)
+            restart(last_);
+    }
+
+    size_t getLookahead() const { return window_ - 1; }
+
+    /** Forget the history; it is taken to have held the next gain processed. */
+    void reset() { primed_ = false; }
+
+    /** Process gains in place.
+        @param gains      The first gain
+        @param numSamples Number of gains
+        @param stride     Distance between consecutive gains
+    */
+    void process(float* gains, size_t numSamples, size_t stride = 1)
+    {
+        if (numSamples == 0 || window_ <= 1)
+            return;
+
+        if (!primed_)
+            restart(gains[0]);
+
+        const float invWindow = std::nextafter(1.0f / static_cast<float>(window_), 1.0f);
+        size_t position = position_;
+        float prefixMin = prefixMin_;
+        float prefixSum = prefixSum_;
+        float y = last_;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            float g = gains[i * stride];
+
+            gains_[position] = g;
+            prefixMin = std::min(prefixMin, g);
+
+            float h = std::min(suffixMin_[position + 1], prefixMin);
+            minima_[position] = h;
+            prefixSum += h;
+
+            // Rounding in the sum must not lift the mean above g[n - L], which is
+            // still in the buffer: in the previous segment, or first in this one
+            float oldest = position + 1 < window_ ? gains_[position + 1] : gains_[0];
+            y = std::min((suffixSum_[position + 1] + prefixSum) * invWindow, oldest);
+            gains[i * stride] = y;
+
+            if (++position == window_)
+            {
+                finishSegment();
+                position = 0;
+                prefixMin = positiveInfinity<float>();
+                prefixSum = 0.0f;
+            }
+        }
+
+        position_ = position;
+        prefixMin_ = prefixMin;
+        prefixSum_ = prefixSum;
+        last_ = y;
+    }
+
+    /** Advance over numSamples unity gains without processing them. Only
+        valid while the window holds nothing but unity gains, which is the case
+        after three windows of them: one for the minima to reach unity, up to
+        one to reach the next segment, and one to finish that segment.
+    */
+    void skipUnity(size_t numSamples)
+    {
+        if (!primed_ || window_ <= 1)
+            return;
+
+        // The same state as processing them: every segment is all unity, and
+        // the prefix of the current one sums to its length
+        position_ = (position_ + numSamples) % window_;
+        prefixMin_ = position_ > 0 ? 1.0f : positiveInfinity<float>();
+        prefixSum_ = static_cast<float>(position_);
+        last_ = 1.0f;
+    }
+
+private:
+    /** Start a segment with a history of constant value. */
+    void restart(float value)
+    {
+        for (size_t k = 0; k < window_; ++k)
+        {
+            gains_[k] = value;
+            suffixMin_[k] = value;
+            suffixSum_[k] = static_cast<float>(window_ - k) * value;
+        }
+
+        suffixMin_[window_] = positiveInfinity<float>();
+        suffixSum_[window_] = 0.0f;
+
+        position_ = 0;
+        prefixMin_ = positiveInfinity<float>();
+        prefixSum_ = 0.0f;
+        last_ = value;
+        primed_ = true;
+    }
+
+    /** Suffix minima of the finished segment's gains and suffix sums of its minima. */
+    void finishSegment()
+    {
+        float lowest = positiveInfinity<float>();
+        float sum = 0.0f;
+
+        for (size_t k = window_; k-- > 0;)
+        {
+            lowest = std::min(lowest, gains_[k]);
+            sum += minima_[k];
+            suffixMin_[k] = lowest;
+            suffixSum_[k] = sum;
+        }
+    }
+
+    size_t window_ = 1;
+
+    // The current segment
+    std::vector<float> gains_;
+    std::vector<float> minima_;
+    size_t position_ = 0;
+    float prefixMin_ = 0.0f;
+    float prefixSum_ = 0.0f;
+
+    // The previous segment, from each position to its end (one extra, empty)
+    std::vector<float> suffixMin_;
+    std::vector<float> suffixSum_;
+
+    float last_ = 1.0f;
+    bool primed_ = false;
+};
+
+} // namespace DSP
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(DSP_SIMD_DISABLE)
+    #define DSP_SIMD_SCALAR 1
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define DSP_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DSP_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DSP_SIMD_NEON 1
+#else
+    #define DSP_SIMD_SCALAR 1
+#endif
+
+namespace DSP
+{
+namespace SIMD
+{
+
+/**
+    Thin wrappers around the native float/int32 vector registers.
+
+    The widest instruction set enabled at compile time is selected:
+    AVX2 (8 lanes), SSE2 (4 lanes), NEON (4 lanes), or a 1-lane scalar
+    fallback so that generic kernels written against these primitives
+    always compile. Define DSP_SIMD_DISABLE to force the scalar fallback.
+    Only the operations needed by the DSP kernels are provided; all loads
+    and stores are unaligned. ramp(start, step) fills lane k with
+    start + k * step.
+
+    roundToInt() rounds half to even on every set, like std::lrint in the
+    default rounding mode.
+
+    Comparisons return a lane mask (all bits set or clear) for use with
+    select(), bitOr() and andNot(); andNot(a, b) is (~a & b).
+
+    gather(table, index) loads table[index] into each lane. Only AVX2 has a
+    gather instruction; the other sets load the lanes one at a time.
+*/
+
+//==============================================================================
+#if DSP_SIMD_AVX2
+
+constexpr size_t kWidth = 8;
+struct Float { __m256 v; };
+struct Int   { __m256i v; };
+
+inline Float load(const float* p)          { return { _mm256_loadu_ps(p) }; }
+inline void  store(float* p, Float a)      { _mm256_storeu_ps(p, a.v); }
+inline Float broadcast(float x)            { return { _mm256_set1_ps(x) }; }
+inline Float add(Float a, Float b)         { return { _mm256_add_ps(a.v, b.v) }; }
+inline Float sub(Float a, Float b)         { return { _mm256_sub_ps(a.v, b.v) }; }
+inline Float mul(Float a, Float b)         { return { _mm256_mul_ps(a.v, b.v) }; }
+inline Float div(Float a, Float b)         { return { _mm256_div_ps(a.v, b.v) }; }
+inline Float min(Float a, Float b)         { return { _mm256_min_ps(a.v, b.v) }; }
+inline Float max(Float a, Float b)         { return { _mm256_max_ps(a.v, b.v) }; }
+inline Float abs(Float a)                  { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+
+inline Float greaterThan(Float a, Float b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline Float bitOr(Float a, Float b)       { return { _mm256_or_ps(a.v, b.v) }; }
+inline Float andNot(Float a, Float b)      { return { _mm256_andnot_ps(a.v, b.v) }; }
+inline Float select(Float mask, Float a, Float b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+
+inline Float ramp(float start, float step)
+{
+    return { _mm256_add_ps(_mm256_set1_ps(start),
+                           _mm256_mul_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(step))) };
+}
+
+inline Int   asInt(Float a)                { return { _mm256_castps_si256(a.v) }; }
+inline Float asFloat(Int a)                { return { _mm256_castsi256_ps(a.v) }; }
+inline Float toFloat(Int a)                { return { _mm256_cvtepi32_ps(a.v) }; }
+inline Int   roundToInt(Float a)           { return { _mm256_cvtps_epi32(a.v) }; }
+inline Int   truncateToInt(Float a)        { return { _mm256_cvttps_epi32(a.v) }; }
+inline Float gather(const float* table, Int index) { return { _mm256_i32gather_ps(table, index.v, 4) }; }
+inline Int   addInt(Int a, int32_t b)      { return { _mm256_add_epi32(a.v, _mm256_set1_epi32(b)) }; }
+inline Int   andInt(Int a, int32_t b)      { return { _mm256_and_si256(a.v, _mm256_set1_epi32(b)) }; }
+inline Int   orInt(Int a, int32_t b)       { return { _mm256_or_si256(a.v, _mm256_set1_epi32(b)) }; }
+template <int N> inline Int shiftLeft(Int a)  { return { _mm256_slli_epi32(a.v, N) }; }
+template <int N> inline Int shiftRight(Int a) { return { _mm256_srli_epi32(a.v, N) }; }
+
+inline float reduceMin(Float a)
+{
+    __m128 m = _mm_min_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+    m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 0x55));
+    return _mm_cvtss_f32(m);
+}
+
+inline float reduceMax(Float a)
+{
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x55));
+    return _mm_cvtss_f32(m);
+}
+
+//==============================================================================
+#elif DSP_SIMD_SSE2
+
+constexpr size_t kWidth = 4;
+struct Float { __m128 v; };
+struct Int   { __m128i v; };
+
+inline Float load(const float* p)          { return { _mm_loadu_ps(p) }; }
+inline void  store(float* p, Float a)      { _mm_storeu_ps(p, a.v); }
+inline Float broadcast(float x)            { return { _mm_set1_ps(x) }; }
+inline Float add(Float a, Float b)         { return { _mm_add_ps(a.v, b.v) }; }
+inline Float sub(Float a, Float b)         { return { _mm_sub_ps(a.v, b.v) }; }
+inline Float mul(Float a, Float b)         { return { _mm_mul_ps(a.v, b.v) }; }
+inline Float div(Float a, Float b)         { return { _mm_div_ps(a.v, b.v) }; }
+inline Float min(Float a, Float b)         { return { _mm_min_ps(a.v, b.v) }; }
+inline Float max(Float a, Float b)         { return { _mm_max_ps(a.v, b.v) }; }
+inline Float abs(Float a)                  { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+
+inline Float greaterThan(Float a, Float b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline Float bitOr(Float a, Float b)       { return { _mm_or_ps(a.v, b.v) }; }
+inline Float andNot(Float a, Float b)      { return { _mm_andnot_ps(a.v, b.v) }; }
+inline Float select(Float mask, Float a, Float b)
+{
+    return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+inline Float ramp(float start, float step)
+{
+    return { _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(_mm_setr_ps(0, 1, 2, 3), _mm_set1_ps(step))) };
+}
+
+inline Int   asInt(Float a)                { return { _mm_castps_si128(a.v) }; }
+inline Float asFloat(Int a)                { return { _mm_castsi128_ps(a.v) }; }
+inline Float toFloat(Int a)                { return { _mm_cvtepi32_ps(a.v) }; }
+inline Int   roundToInt(Float a)           { return { _mm_cvtps_epi32(a.v) }; }
+inline Int   truncateToInt(Float a)        { return { _mm_cvttps_epi32(a.v) }; }
+
+inline Float gather(const float* table, Int index)
+{
+    alignas(16) int32_t i[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(i), index.v);
+    return { _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]) };
+}
+inline Int   addInt(Int a, int32_t b)      { return { _mm_add_epi32(a.v, _mm_set1_epi32(b)) }; }
+inline Int   andInt(Int a, int32_t b)      { return { _mm_and_si128(a.v, _mm_set1_epi32(b)) }; }
+inline Int   orInt(Int a, int32_t b)       { return { _mm_or_si128(a.v, _mm_set1_epi32(b)) }; }
+template <int N> inline Int shiftLeft(Int a)  { return { _mm_slli_epi32(a.v, N) }; }
+template <int N> inline Int shiftRight(Int a) { return { _mm_srli_epi32(a.v, N) }; }
+
+inline float reduceMin(Float a)
+{
+    __m128 m = _mm_min_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 0x55));
+    return _mm_cvtss_f32(m);
+}
+
+inline float reduceMax(Float a)
+{
+    __m128 m = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x55));
+    return _mm_cvtss_f32(m);
+}
+
+//==============================================================================
+#elif DSP_SIMD_NEON
+
+constexpr size_t kWidth = 4;
+struct Float { float32x4_t v; };
+struct Int   { int32x4_t v; };
+
+inline Float load(const float* p)          { return { vld1q_f32(p) }; }
+inline void  store(float* p, Float a)      { vst1q_f32(p, a.v); }
+inline Float broadcast(float x)            { return { vdupq_n_f32(x) }; }
+inline Float add(Float a, Float b)         { return { vaddq_f32(a.v, b.v) }; }
+inline Float sub(Float a, Float b)         { return { vsubq_f32(a.v, b.v) }; }
+inline Float mul(Float a, Float b)         { return { vmulq_f32(a.v, b.v) }; }
+inline Float min(Float a, Float b)         { return { vminq_f32(a.v, b.v) }; }
+inline Float max(Float a, Float b)         { return { vmaxq_f32(a.v, b.v) }; }
+inline Float abs(Float a)                  { return { vabsq_f32(a.v) }; }
+
+inline Float greaterThan(Float a, Float b) { return { vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v)) }; }
+inline Float bitOr(Float a, Float b)
+{
+    return { vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+}
+inline Float andNot(Float a, Float b)
+{
+    return { vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b.v), vreinterpretq_u32_f32(a.v))) };
+}
+inline Float select(Float mask, Float a, Float b) { return { vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) }; }
+
+inline Float ramp(float start, float step)
+{
+    static const float kLanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    return { vmlaq_f32(vdupq_n_f32(start), vld1q_f32(kLanes), vdupq_n_f32(step)) };
+}
+
+inline Float div(Float a, Float b)
+{
+   #if defined(__aarch64__)
+    return { vdivq_f32(a.v, b.v) };
+   #else
+    // Reciprocal estimate refined by two Newton-Raphson steps
+    float32x4_t r = vrecpeq_f32(b.v);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    return { vmulq_f32(a.v, r) };
+   #endif
+}
+
+inline Int   asInt(Float a)                { return { vreinterpretq_s32_f32(a.v) }; }
+inline Float asFloat(Int a)                { return { vreinterpretq_f32_s32(a.v) }; }
+inline Float toFloat(Int a)                { return { vcvtq_f32_s32(a.v) }; }
+inline Int   truncateToInt(Float a)        { return { vcvtq_s32_f32(a.v) }; }
+inline Int   addInt(Int a, int32_t b)      { return { vaddq_s32(a.v, vdupq_n_s32(b)) }; }
+inline Int   andInt(Int a, int32_t b)      { return { vandq_s32(a.v, vdupq_n_s32(b)) }; }
+inline Int   orInt(Int a, int32_t b)       { return { vorrq_s32(a.v, vdupq_n_s32(b)) }; }
+template <int N> inline Int shiftLeft(Int a)  { return { vshlq_n_s32(a.v, N) }; }
+template <int N> inline Int shiftRight(Int a)
+{
+    return { vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a.v), N)) };
+}
+
+inline Int roundToInt(Float a)
+{
+   #if defined(__aarch64__)
+    return { vcvtnq_s32_f32(a.v) };
+   #else
+    // Adding and subtracting 1.5 * 2^23 rounds half to even like the other
+    // sets (NEON always rounds to nearest); exact for |a| < 2^22
+    float32x4_t magic = vdupq_n_f32(12582912.0f);
+    return { vcvtq_s32_f32(vsubq_f32(vaddq_f32(a.v, magic), magic)) };
+   #endif
+}
+
+inline Float gather(const float* table, Int index)
+{
+    float lanes[4] = { table[vgetq_lane_s32(index.v, 0)], table[vgetq_lane_s32(index.v, 1)],
+                       table[vgetq_lane_s32(index.v, 2)], table[vgetq_lane_s32(index.v, 3)] };
+    return { vld1q_f32(lanes) };
+}
+
+inline float reduceMin(Float a)
+{
+   #if defined(__aarch64__)
+    return vminvq_f32(a.v);
+   #else
+    float32x2_t m = vpmin_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpmin_f32(m, m), 0);
+   #endif
+}
+
+inline float reduceMax(Float a)
+{
+   #if defined(__aarch64__)
+    return vmaxvq_f32(a.v);
+   #else
+    float32x2_t m = vpmax_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpmax_f32(m, m), 0);
+   #endif
+}
+
+//==============================================================================
+#else
+
+constexpr size_t kWidth = 1;
+struct Float { float v; };
+struct Int   { int32_t v; };
+
+inline Float load(const float* p)          { return { *p }; }
+inline void  store(float* p, Float a)      { *p = a.v; }
+inline Float broadcast(float x)            { return { x }; }
+inline Float add(Float a, Float b)         { return { a.v + b.v }; }
+inline Float sub(Float a, Float b)         { return { a.v - b.v }; }
+inline Float mul(Float a, Float b)         { return { a.v * b.v }; }
+inline Float div(Float a, Float b)         { return { a.v / b.v }; }
+inline Float min(Float a, Float b)         { return { b.v < a.v ? b.v : a.v }; }
+inline Float max(Float a, Float b)         { return { a.v < b.v ? b.v : a.v }; }
+inline Float abs(Float a)                  { return { std::fabs(a.v) }; }
+
+// Masks are all-ones (a NaN pattern) or zero, as in the vector versions
+inline Float maskFromBool(bool b)          { uint32_t bits = b ? 0xffffffffu : 0u; Float r; std::memcpy(&r.v, &bits, sizeof(float)); return r; }
+inline bool  isMaskSet(Float m)            { uint32_t bits; std::memcpy(&bits, &m.v, sizeof(float)); return bits != 0; }
+inline Float greaterThan(Float a, Float b) { return maskFromBool(a.v > b.v); }
+inline Float bitOr(Float a, Float b)       { return maskFromBool(isMaskSet(a) || isMaskSet(b)); }
+inline Float andNot(Float a, Float b)      { return maskFromBool(!isMaskSet(a) && isMaskSet(b)); }
+inline Float select(Float mask, Float a, Float b) { return isMaskSet(mask) ? a : b; }
+
+inline Float ramp(float start, float /*step*/) { return { start }; }
+
+inline Int   asInt(Float a)                { Int r; std::memcpy(&r.v, &a.v, sizeof(float)); return r; }
+inline Float asFloat(Int a)                { Float r; std::memcpy(&r.v, &a.v, sizeof(float)); return r; }
+inline Float toFloat(Int a)                { return { static_cast<float>(a.v) }; }
+inline Int   roundToInt(Float a)           { return { static_cast<int32_t>(std::lrint(a.v)) }; }
+inline Int   truncateToInt(Float a)        { return { static_cast<int32_t>(a.v) }; }
+inline Float gather(const float* table, Int index) { return { table[index.v] }; }
+inline Int   addInt(Int a, int32_t b)      { return { a.v + b }; }
+inline Int   andInt(Int a, int32_t b)      { return { a.v & b }; }
+inline Int   orInt(Int a, int32_t b)       { return { a.v | b }; }
+template <int N> inline Int shiftLeft(Int a)  { return { static_cast<int32_t>(static_cast<uint32_t>(a.v) << N) }; }
+template <int N> inline Int shiftRight(Int a) { return { static_cast<int32_t>(static_cast<uint32_t>(a.v) >> N) }; }
+
+inline float reduceMin(Float a)            { return a.v; }
+inline float reduceMax(Float a)            { return a.v; }
+
+#endif
+
+} // namespace SIMD
+} // namespace DSP
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    Wait-free single-producer / single-consumer ring buffer.
+
+    One thread may call push() and another may call pop() concurrently
+    without locks. Neither operation allocates or blocks: push() fails when
+    the ring is full and pop() fails when it is empty. Storage is allocated
+    once at construction, so the ring is safe to use from the audio thread.
+
+    The capacity is rounded up to a power of two.
+*/
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    /** Producer: append an item.
+        @return False (and drops the item) if the ring is full
+    */
+    bool push(const T& item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head - tail_.load(std::memory_order_acquire) > mask_)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer: remove the oldest item.
+        @return False if the ring is empty
+    */
+    bool pop(T& item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail == head_.load(std::memory_order_acquire))
+            return false;
+
+        item = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Approximate number of items waiting (exact when called from either end). */
+    size_t size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+    /** Number of items dropped because the ring was full. */
+    size_t getNumDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+    alignas(64) std::atomic<size_t> dropped_{ 0 };
+};
+
+} // namespace DSP
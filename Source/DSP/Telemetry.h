@@ -0,0 +1,229 @@
+#pragma once
+
+#include "SpscRing.h"
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+    Decimated metering data for a short stretch of audio (all channels).
+
+    Levels and gains are linear so that the audio thread never has to take
+    a logarithm; consumers convert to dB.
+*/
+struct TelemetryFrame
+{
+    float inputPeak = 0.0f;    // Max |x| at the compressor input (after input gain)
+    float inputRms = 0.0f;     // RMS at the compressor input
+    float outputPeak = 0.0f;   // Max |x| at the output
+    float outputRms = 0.0f;    // RMS at the output
+    float minGain = 1.0f;      // Deepest gain reduction in the frame (linear)
+    float maxGain = 1.0f;      // Lightest gain reduction in the frame (linear)
+    uint32_t numSamples = 0;   // Frame length in samples
+};
+
+/**
+    Builds TelemetryFrames on the audio thread.
+
+    Each block is split at frame boundaries that persist across blocks, so a
+    frame always covers exactly frameLength samples regardless of the host
+    block size. Per block the caller does:
+
+        beginBlock(numSamples);
+        addInput(channel) / addGain(gain) / addOutput(channel)   // any order, any count
+        endBlock(ring);
+
+    All storage is allocated in prepare(); blocks longer than the prepared
+    maximum fold their excess into the last frame of the block.
+*/
+class TelemetryCollector
+{
+public:
+    TelemetryCollector() = default;
+
+    /** Prepare for processing.
+        @param frameLength  Samples per telemetry frame
+        @param maxBlockSize Largest expected host block
+    */
+    void prepare(size_t frameLength, size_t maxBlockSize)
+    {
+        frameLength_ = std::max<size_t>(frameLength, 1);
+        segments_.assign(maxBlockSize / frameLength_ + 2, Accumulator{});
+        reset();
+    }
+
+    void reset()
+    {
+        pending_ = Accumulator{};
+        pendingSamples_ = 0;
+        blockSize_ = 0;
+        numSegments_ = 0;
+    }
+
+    size_t getFrameLength() const { return frameLength_; }
+
+    //==============================================================================
+    void beginBlock(size_t numSamples)
+    {
+        blockSize_ = numSamples;
+        firstSegmentLength_ = std::min(numSamples, frameLength_ - pendingSamples_);
+
+        size_t remaining = numSamples - firstSegmentLength_;
+        numSegments_ = 1 + (remaining + frameLength_ - 1) / frameLength_;
+        numSegments_ = std::min(numSegments_, segments_.size());
+
+        std::fill(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(numSegments_), Accumulator{});
+    }
+
+    /** Accumulate one channel of compressor input. */
+    void addInput(const float* data)
+    {
+        forEachSegment([&](Accumulator& acc, size_t start, size_t end) {
+            accumulateSignal(data, start, end, acc.inputPeak, acc.inputSumSquares, acc.inputCount);
+        });
+    }
+
+    /** Accumulate one channel of compressor output. */
+    void addOutput(const float* data)
+    {
+        forEachSegment([&](Accumulator& acc, size_t start, size_t end) {
+            accumulateSignal(data, start, end, acc.outputPeak, acc.outputSumSquares, acc.outputCount);
+        });
+    }
+
+    /** Accumulate a linear gain vector (once per channel, or once if linked). */
+    void addGain(const float* gain)
+    {
+        forEachSegment([&](Accumulator& acc, size_t start, size_t end) {
+            float minGain = acc.minGain;
+            float maxGain = acc.maxGain;
+
+            for (size_t i = start; i < end; ++i)
+            {
+                minGain = std::min(minGain, gain[i]);
+                maxGain = std::max(maxGain, gain[i]);
+            }
+
+            acc.minGain = minGain;
+            acc.maxGain = maxGain;
+        });
+    }
+
+    /** Push every frame completed by this block. Frames that don't fit are dropped. */
+    void endBlock(SpscRing<TelemetryFrame>& ring)
+    {
+        if (numSegments_ == 0)
+            return;
+
+        segments_[0].merge(pending_);
+        size_t completedSamples = pendingSamples_;
+
+        for (size_t k = 0; k < numSegments_; ++k)
+        {
+            size_t end = k + 1 < numSegments_ ? segmentStart(k + 1) : blockSize_;
+            completedSamples += end - segmentStart(k);
+
+            if (completedSamples < frameLength_)
+            {
+                // Partial frame at the end of the block, carried into the next one
+                pending_ = segments_[k];
+                pendingSamples_ = completedSamples;
+                numSegments_ = 0;
+                return;
+            }
+
+            ring.push(segments_[k].toFrame(completedSamples));
+            completedSamples = 0;
+        }
+
+        pending_ = Accumulator{};
+        pendingSamples_ = 0;
+        numSegments_ = 0;
+    }
+
+private:
+    struct Accumulator
+    {
+        float inputPeak = 0.0f;
+        float inputSumSquares = 0.0f;
+        size_t inputCount = 0;
+        float outputPeak = 0.0f;
+        float outputSumSquares = 0.0f;
+        size_t outputCount = 0;
+        float minGain = 1.0f;
+        float maxGain = 1.0f;
+
+        void merge(const Accumulator& other)
+        {
+            inputPeak = std::max(inputPeak, other.inputPeak);
+            inputSumSquares += other.inputSumSquares;
+            inputCount += other.inputCount;
+            outputPeak = std::max(outputPeak, other.outputPeak);
+            outputSumSquares += other.outputSumSquares;
+            outputCount += other.outputCount;
+            minGain = std::min(minGain, other.minGain);
+            maxGain = std::max(maxGain, other.maxGain);
+        }
+
+        TelemetryFrame toFrame(size_t numSamples) const
+        {
+            TelemetryFrame frame;
+            frame.inputPeak = inputPeak;
+            frame.inputRms = inputCount > 0 ? std::sqrt(inputSumSquares / static_cast<float>(inputCount)) : 0.0f;
+            frame.outputPeak = outputPeak;
+            frame.outputRms = outputCount > 0 ? std::sqrt(outputSumSquares / static_cast<float>(outputCount)) : 0.0f;
+            frame.minGain = minGain;
+            frame.maxGain = maxGain;
+            frame.numSamples = static_cast<uint32_t>(numSamples);
+            return frame;
+        }
+    };
+
+    size_t segmentStart(size_t k) const
+    {
+        return k == 0 ? 0 : firstSegmentLength_ + (k - 1) * frameLength_;
+    }
+
+    template <typename Function>
+    void forEachSegment(Function&& function)
+    {
+        for (size_t k = 0; k < numSegments_; ++k)
+        {
+            size_t end = k + 1 < numSegments_ ? segmentStart(k + 1) : blockSize_;
+            function(segments_[k], segmentStart(k), end);
+        }
+    }
+
+    static void accumulateSignal(const float* data, size_t start, size_t end,
+                                 float& peak, float& sumSquares, size_t& count)
+    {
+        float blockPeak = peak;
+        float blockSum = 0.0f;
+
+        for (size_t i = start; i < end; ++i)
+        {
+            blockPeak = std::max(blockPeak, std::fabs(data[i]));
+            blockSum += data[i] * data[i];
+        }
+
+        peak = blockPeak;
+        sumSquares += blockSum;
+        count += end - start;
+    }
+
+    size_t frameLength_ = 64;
+    std::vector<Accumulator> segments_;
+    size_t numSegments_ = 0;
+    size_t firstSegmentLength_ = 0;
+    size_t blockSize_ = 0;
+
+    Accumulator pending_;
+    size_t pendingSamples_ = 0;
+};
+
+} // namespace DSP
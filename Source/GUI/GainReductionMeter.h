@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../DSP/Telemetry.h"
+#include "../DSP/Utilities.h"
 
 /**
     VU-style meter for displaying gain reduction.
@@ -72,6 +74,21 @@ public:
 
     float getGainReductionDb() const { return currentLevel_; }
 
+    /** Feed one telemetry frame from the processor.
+
+        Frames received between two display updates are reduced to their
+        deepest gain reduction, so short transients still reach the meter.
+    */
+    void addFrame(const DSP::TelemetryFrame& frame)
+    {
+        float gainReductionDb = std::min(0.0f, DSP::mag2Db(frame.minGain));
+
+        if (!hasPendingFrames_ || gainReductionDb < pendingLevel_)
+            pendingLevel_ = gainReductionDb;
+
+        hasPendingFrames_ = true;
+    }
+
     //==============================================================================
     // Component overrides
 
@@ -176,6 +193,13 @@ public:
 
     void timerCallback() override
     {
+        // Apply telemetry received since the last update
+        if (hasPendingFrames_)
+        {
+            setGainReductionDb(pendingLevel_);
+            hasPendingFrames_ = false;
+        }
+
         // Smooth interpolation toward target level
         float smoothingFactor = 0.3f;
         currentLevel_ += (targetLevel_ - currentLevel_) * smoothingFactor;
@@ -205,6 +229,9 @@ private:
     float currentLevel_ = 0.0f;
     float targetLevel_ = 0.0f;
 
+    float pendingLevel_ = 0.0f;
+    bool hasPendingFrames_ = false;
+
     float peakHoldLevel_ = 0.0f;
     int peakHoldTimer_ = 0;
     int peakHoldTime_ = 60;  // ~2 seconds at 30 FPS
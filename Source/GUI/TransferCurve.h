@@ -3,6 +3,8 @@
 #include <JuceHeader.h>
 #include "../DSP/CompressionCurve.h"
 #include "../DSP/Utilities.h"
+#include "../DSP/Telemetry.h"
+#include <array>
 
 /**
     Transfer curve visualization for the compressor.
@@ -18,6 +20,7 @@ class TransferCurve : public juce::Component, public juce::Timer
 public:
     TransferCurve()
     {
+        history_.fill(-100.0f);
         startTimerHz(30);  // 30 FPS update rate
     }
 
@@ -49,6 +52,21 @@ public:
         currentInputLevel_ = inputLevelDb;
     }
 
+    /** Feed one telemetry frame from the processor.
+
+        The operating point follows the loudest input peak received since the
+        last repaint, and recent operating points are drawn as a fading trail.
+    */
+    void addFrame(const DSP::TelemetryFrame& frame)
+    {
+        float inputPeakDb = DSP::mag2Db(frame.inputPeak);
+
+        if (!hasPendingFrames_ || inputPeakDb > pendingInputLevel_)
+            pendingInputLevel_ = inputPeakDb;
+
+        hasPendingFrames_ = true;
+    }
+
     void setColors(juce::Colour background, juce::Colour grid, juce::Colour curve, juce::Colour cursor)
     {
         backgroundColor_ = background;
@@ -85,7 +103,8 @@ public:
         // Draw threshold indicator
         drawThresholdIndicator(g, bounds);
 
-        // Draw current operating point
+        // Draw recent operating points, then the current one
+        drawHistory(g, bounds);
         drawOperatingPoint(g, bounds);
 
         // Draw axis labels
@@ -99,6 +118,16 @@ public:
 
     void timerCallback() override
     {
+        if (hasPendingFrames_)
+        {
+            setCurrentInputLevel(pendingInputLevel_);
+            hasPendingFrames_ = false;
+        }
+
+        // Record operating point history for the trail
+        history_[historyIndex_] = currentInputLevel_;
+        historyIndex_ = (historyIndex_ + 1) % history_.size();
+
         repaint();
     }
 
@@ -226,6 +255,30 @@ private:
         g.drawLine(bounds.getX(), y, bounds.getRight(), y, 0.5f);
     }
 
+    void drawHistory(juce::Graphics& g, juce::Rectangle<float> bounds)
+    {
+        float range = maxDb_ - minDb_;
+
+        for (size_t age = 1; age < history_.size(); ++age)
+        {
+            float inputDb = history_[(historyIndex_ + history_.size() - 1 - age) % history_.size()];
+
+            if (inputDb <= minDb_)
+                continue;
+
+            inputDb = juce::jmin(maxDb_, inputDb);
+            float outputDb = compressionCurve_.calculateOutputLevelDb(inputDb);
+
+            float x = bounds.getX() + bounds.getWidth() * (inputDb - minDb_) / range;
+            float y = bounds.getBottom() - bounds.getHeight() * (outputDb - minDb_) / range;
+            y = juce::jlimit(bounds.getY(), bounds.getBottom(), y);
+
+            float alpha = 0.4f * (1.0f - static_cast<float>(age) / static_cast<float>(history_.size()));
+            g.setColour(cursorColor_.withAlpha(alpha));
+            g.fillEllipse(x - 2.5f, y - 2.5f, 5.0f, 5.0f);
+        }
+    }
+
     void drawLabels(juce::Graphics& g, juce::Rectangle<float> bounds)
     {
         g.setColour(juce::Colours::white.withAlpha(0.6f));
@@ -269,6 +322,13 @@ private:
     float maxDb_ = 0.0f;
     float currentInputLevel_ = -100.0f;
 
+    float pendingInputLevel_ = -100.0f;
+    bool hasPendingFrames_ = false;
+
+    // Operating point history (one entry per display update, ~1 s)
+    std::array<float, 30> history_;
+    size_t historyIndex_ = 0;
+
     juce::Colour backgroundColor_{ 0xff0f0f23 };
     juce::Colour gridColor_{ 0xff2a2a4a };
     juce::Colour curveColor_{ 0xff00d4ff };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+    Parameter ranges, which only need juce_core. Kept apart from Parameters.h
+    so the offline renderer can quantize preset values exactly as the
+    plugin's parameters do.
+*/
+namespace Parameters
+{
+
+//==============================================================================
+// Parameter Ranges (matching FBAudio specs)
+//==============================================================================
+
+namespace Range
+{
+    // Input/Output Gain: -30 to +30 dB
+    static const juce::NormalisableRange<float> gain(-30.0f, 30.0f, 0.1f);
+
+    // Threshold: -96 to 0 dB
+    static const juce::NormalisableRange<float> threshold(-96.0f, 0.0f, 0.1f);
+
+    // Ratio: 1:1 to 100:1 (with skew for better control at low ratios)
+    static const juce::NormalisableRange<float> ratio(1.0f, 100.0f, 0.1f, 0.3f);
+
+    // Knee Width: 0 to 48 dB
+    static const juce::NormalisableRange<float> kneeWidth(0.0f, 48.0f, 0.1f);
+
+    // Attack Time: 0 to 1000 ms
+    static const juce::NormalisableRange<float> attackTime(0.0f, 1000.0f, 0.1f, 0.4f);
+
+    // Release Time: 0 to 1000 ms
+    static const juce::NormalisableRange<float> releaseTime(0.0f, 1000.0f, 0.1f, 0.4f);
+
+    // Hold Time: 0 to 1000 ms
+    static const juce::NormalisableRange<float> holdTime(0.0f, 1000.0f, 0.1f, 0.4f);
+
+    // Lookahead Time: 0 to 30 ms
+    static const juce::NormalisableRange<float> lookaheadTime(0.0f, 30.0f, 0.1f);
+
+    // Crossover Frequency: 20 Hz to 20 kHz (skewed towards the low end)
+    static const juce::NormalisableRange<float> crossover(20.0f, 20000.0f, 1.0f, 0.25f);
+}
+
+} // namespace Parameters
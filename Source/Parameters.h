@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterRanges.h"
 
 namespace Parameters
 {
@@ -22,6 +23,30 @@ namespace ID
     static const juce::String releaseTime   = "releaseTime";
     static const juce::String holdTime      = "holdTime";
     static const juce::String lookaheadTime = "lookaheadTime";
+    static const juce::String fixedLatency  = "fixedLatency";
+    static const juce::String peakLookahead = "peakLookahead";
+    static const juce::String linkMode      = "linkMode";
+    static const juce::String curveSmoothing = "curveSmoothing";
+    static const juce::String gainRate      = "gainRate";
+    static const juce::String detector      = "detector";
+    static const juce::String sidechain     = "sidechain";
+    static const juce::String bands         = "bands";
+    static const juce::String crossover1    = "crossover1";
+    static const juce::String crossover2    = "crossover2";
+    static const juce::String crossover3    = "crossover3";
+    static const juce::String crossover4    = "crossover4";
+    static const juce::String oversampling  = "oversampling";
+    static const juce::String oversampledDetection = "oversampledDetection";
+
+    // Crossovers from the lowest, as in DSP::CompressorSettings::crossoverHz
+    static const juce::String crossover[] = { crossover1, crossover2, crossover3, crossover4 };
+
+    // Every parameter, for registering listeners
+    static const juce::String all[] = { linked, bypass, inputGain, threshold, ratio, kneeWidth, outputGain,
+                                        attackTime, releaseTime, holdTime, lookaheadTime, fixedLatency,
+                                        peakLookahead, linkMode, curveSmoothing, gainRate, detector,
+                                        sidechain, bands, crossover1, crossover2, crossover3, crossover4,
+                                        oversampling, oversampledDetection };
 }
 
 //==============================================================================
@@ -41,37 +66,48 @@ namespace Label
     static const juce::String releaseTime   = "Release";
     static const juce::String holdTime      = "Hold";
     static const juce::String lookaheadTime = "Lookahead";
+    static const juce::String fixedLatency  = "Fixed Latency";
+    static const juce::String peakLookahead = "Peak Lookahead";
+    static const juce::String linkMode      = "Link Mode";
+    static const juce::String curveSmoothing = "Curve Smoothing";
+    static const juce::String gainRate      = "Gain Rate";
+    static const juce::String detector      = "Detector";
+    static const juce::String sidechain     = "Sidechain";
+    static const juce::String bands         = "Bands";
+    static const juce::String crossover1    = "Crossover 1";
+    static const juce::String crossover2    = "Crossover 2";
+    static const juce::String crossover3    = "Crossover 3";
+    static const juce::String crossover4    = "Crossover 4";
+    static const juce::String oversampling  = "Oversampling";
+    static const juce::String oversampledDetection = "Oversampled Detection";
 }
 
 //==============================================================================
-// Parameter Ranges (matching FBAudio specs)
+// Parameter Choices
 //==============================================================================
 
-namespace Range
+namespace Choices
 {
-    // Input/Output Gain: -30 to +30 dB
-    static const juce::NormalisableRange<float> gain(-30.0f, 30.0f, 0.1f);
+    // Used while Linked is on (see DSP::Compressor::LinkMode)
+    static const juce::StringArray linkMode { "All Channels", "Per Group", "W Only" };
 
-    // Threshold: -96 to 0 dB
-    static const juce::NormalisableRange<float> threshold(-96.0f, 0.0f, 0.1f);
+    // Threshold/ratio/knee ramping (see DSP::CompressionCurve::Smoothing)
+    static const juce::StringArray curveSmoothing { "Off", "32 Samples", "16 Samples", "Per Sample" };
 
-    // Ratio: 1:1 to 100:1 (with skew for better control at low ratios)
-    static const juce::NormalisableRange<float> ratio(1.0f, 100.0f, 0.1f, 0.3f);
+    // Gain computer updates (see DSP::Compressor::setGainDecimation)
+    static const juce::StringArray gainRate { "Every Sample", "8 Samples", "16 Samples", "32 Samples" };
 
-    // Knee Width: 0 to 48 dB
-    static const juce::NormalisableRange<float> kneeWidth(0.0f, 48.0f, 0.1f);
+    // Detector topology (see DSP::Compressor::Detector)
+    static const juce::StringArray detector { "Level", "Log Gain" };
 
-    // Attack Time: 0 to 1000 ms
-    static const juce::NormalisableRange<float> attackTime(0.0f, 1000.0f, 0.1f, 0.4f);
+    // Detector source (see DSP::Compressor::Sidechain)
+    static const juce::StringArray sidechain { "Off", "Mono", "Per Channel", "Linked Sum" };
 
-    // Release Time: 0 to 1000 ms
-    static const juce::NormalisableRange<float> releaseTime(0.0f, 1000.0f, 0.1f, 0.4f);
+    // Multiband split (see DSP::Compressor::setNumBands)
+    static const juce::StringArray bands { "Broadband", "2 Bands", "3 Bands", "4 Bands", "5 Bands" };
 
-    // Hold Time: 0 to 1000 ms
-    static const juce::NormalisableRange<float> holdTime(0.0f, 1000.0f, 0.1f, 0.4f);
-
-    // Lookahead Time: 0 to 30 ms
-    static const juce::NormalisableRange<float> lookaheadTime(0.0f, 30.0f, 0.1f);
+    // Rate of the gain multiply (see DSP::Compressor::setOversampling)
+    static const juce::StringArray oversampling { "Off", "2x", "4x", "8x" };
 }
 
 //==============================================================================
@@ -91,6 +127,20 @@ namespace Default
     static const float releaseTime   = 100.0f;
     static const float holdTime      = 0.0f;
     static const float lookaheadTime = 0.0f;
+    static const bool  fixedLatency  = false;
+    static const bool  peakLookahead = false;
+    static const int   linkMode      = 0;
+    static const int   curveSmoothing = 3;
+    static const int   gainRate      = 0;
+    static const int   detector      = 0;
+    static const int   sidechain     = 0;
+    static const int   bands         = 0;
+    static const float crossover1    = 150.0f;
+    static const float crossover2    = 800.0f;
+    static const float crossover3    = 3000.0f;
+    static const float crossover4    = 8000.0f;
+    static const int   oversampling  = 0;
+    static const bool  oversampledDetection = false;
 }
 
 //==============================================================================
@@ -112,6 +162,64 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         Label::bypass,
         Default::bypass));
 
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID(ID::fixedLatency, 1),
+        Label::fixedLatency,
+        Default::fixedLatency));
+
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID(ID::peakLookahead, 1),
+        Label::peakLookahead,
+        Default::peakLookahead));
+
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID(ID::oversampledDetection, 1),
+        Label::oversampledDetection,
+        Default::oversampledDetection));
+
+    // Choice parameters
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::linkMode, 1),
+        Label::linkMode,
+        Choices::linkMode,
+        Default::linkMode));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::curveSmoothing, 1),
+        Label::curveSmoothing,
+        Choices::curveSmoothing,
+        Default::curveSmoothing));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::gainRate, 1),
+        Label::gainRate,
+        Choices::gainRate,
+        Default::gainRate));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::detector, 1),
+        Label::detector,
+        Choices::detector,
+        Default::detector));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::sidechain, 1),
+        Label::sidechain,
+        Choices::sidechain,
+        Default::sidechain));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::bands, 1),
+        Label::bands,
+        Choices::bands,
+        Default::bands));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ID::oversampling, 1),
+        Label::oversampling,
+        Choices::oversampling,
+        Default::oversampling));
+
     // Gain parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID(ID::inputGain, 1),
@@ -178,6 +286,35 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         Default::lookaheadTime,
         juce::AudioParameterFloatAttributes().withLabel("ms")));
 
+    // Crossover parameters
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(ID::crossover1, 1),
+        Label::crossover1,
+        Range::crossover,
+        Default::crossover1,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(ID::crossover2, 1),
+        Label::crossover2,
+        Range::crossover,
+        Default::crossover2,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(ID::crossover3, 1),
+        Label::crossover3,
+        Range::crossover,
+        Default::crossover3,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(ID::crossover4, 1),
+        Label::crossover4,
+        Range::crossover,
+        Default::crossover4,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
     return { params.begin(), params.end() };
 }
 
@@ -40,6 +40,10 @@ BroadbandCompressorAudioProcessorEditor::BroadbandCompressorAudioProcessorEditor
     setupSlider(holdTimeSlider_, " ms", false);
     setupSlider(lookaheadTimeSlider_, " ms", false);
 
+    // Setup crossover knobs
+    for (auto& slider : crossoverSliders_)
+        setupSlider(slider, " Hz", true);
+
     // Setup labels
     setupLabel(inputGainLabel_, "Input Gain");
     setupLabel(thresholdLabel_, "Threshold");
@@ -50,12 +54,44 @@ BroadbandCompressorAudioProcessorEditor::BroadbandCompressorAudioProcessorEditor
     setupLabel(releaseTimeLabel_, "Release");
     setupLabel(holdTimeLabel_, "Hold");
     setupLabel(lookaheadTimeLabel_, "Lookahead");
+    setupLabel(linkModeLabel_, "Link");
+    setupLabel(curveSmoothingLabel_, "Smoothing");
+    setupLabel(gainRateLabel_, "Gain Rate");
+    setupLabel(detectorLabel_, "Detector");
+    setupLabel(sidechainLabel_, "Sidechain");
+    setupLabel(bandsLabel_, "Bands");
+    setupLabel(oversamplingLabel_, "Oversample");
+
+    for (size_t k = 0; k < crossoverLabels_.size(); ++k)
+        setupLabel(crossoverLabels_[k], "Crossover " + juce::String(static_cast<int>(k) + 1));
 
     // Setup toggle buttons
     linkedButton_.setColour(juce::ToggleButton::textColourId, customLookAndFeel_.getTextColor());
     bypassButton_.setColour(juce::ToggleButton::textColourId, customLookAndFeel_.getTextColor());
+    fixedLatencyButton_.setColour(juce::ToggleButton::textColourId, customLookAndFeel_.getTextColor());
+    peakLookaheadButton_.setColour(juce::ToggleButton::textColourId, customLookAndFeel_.getTextColor());
+    oversampledDetectionButton_.setColour(juce::ToggleButton::textColourId, customLookAndFeel_.getTextColor());
     addAndMakeVisible(linkedButton_);
     addAndMakeVisible(bypassButton_);
+    addAndMakeVisible(fixedLatencyButton_);
+    addAndMakeVisible(peakLookaheadButton_);
+    addAndMakeVisible(oversampledDetectionButton_);
+
+    // Setup selectors (items must exist before the attachments)
+    linkModeBox_.addItemList(Parameters::Choices::linkMode, 1);
+    curveSmoothingBox_.addItemList(Parameters::Choices::curveSmoothing, 1);
+    gainRateBox_.addItemList(Parameters::Choices::gainRate, 1);
+    detectorBox_.addItemList(Parameters::Choices::detector, 1);
+    sidechainBox_.addItemList(Parameters::Choices::sidechain, 1);
+    bandsBox_.addItemList(Parameters::Choices::bands, 1);
+    oversamplingBox_.addItemList(Parameters::Choices::oversampling, 1);
+    addAndMakeVisible(linkModeBox_);
+    addAndMakeVisible(curveSmoothingBox_);
+    addAndMakeVisible(gainRateBox_);
+    addAndMakeVisible(detectorBox_);
+    addAndMakeVisible(sidechainBox_);
+    addAndMakeVisible(bandsBox_);
+    addAndMakeVisible(oversamplingBox_);
 
     // Create parameter attachments
     auto& vts = processorRef.getValueTreeState();
@@ -78,16 +114,41 @@ BroadbandCompressorAudioProcessorEditor::BroadbandCompressorAudioProcessorEditor
         vts, Parameters::ID::holdTime, holdTimeSlider_);
     lookaheadTimeAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         vts, Parameters::ID::lookaheadTime, lookaheadTimeSlider_);
+
+    for (size_t k = 0; k < crossoverSliders_.size(); ++k)
+        crossoverAttachments_[k] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+            vts, Parameters::ID::crossover[k], crossoverSliders_[k]);
+
     linkedAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         vts, Parameters::ID::linked, linkedButton_);
     bypassAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         vts, Parameters::ID::bypass, bypassButton_);
+    fixedLatencyAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        vts, Parameters::ID::fixedLatency, fixedLatencyButton_);
+    peakLookaheadAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        vts, Parameters::ID::peakLookahead, peakLookaheadButton_);
+    oversampledDetectionAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        vts, Parameters::ID::oversampledDetection, oversampledDetectionButton_);
+    linkModeAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::linkMode, linkModeBox_);
+    curveSmoothingAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::curveSmoothing, curveSmoothingBox_);
+    gainRateAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::gainRate, gainRateBox_);
+    detectorAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::detector, detectorBox_);
+    sidechainAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::sidechain, sidechainBox_);
+    bandsAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::bands, bandsBox_);
+    oversamplingAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        vts, Parameters::ID::oversampling, oversamplingBox_);
 
     // Start timer for GUI updates
     startTimerHz(30);
 
     // Set size
-    setSize(800, 500);
+    setSize(800, 600);
 }
 
 BroadbandCompressorAudioProcessorEditor::~BroadbandCompressorAudioProcessorEditor()
@@ -213,15 +274,71 @@ void BroadbandCompressorAudioProcessorEditor::resized()
     // Toggle buttons at bottom
     centerSection.removeFromTop(10);
     auto buttonRow = centerSection.removeFromTop(30);
-    auto buttonWidth = buttonRow.getWidth() / 3;
+    auto buttonWidth = buttonRow.getWidth() / 4;
     linkedButton_.setBounds(buttonRow.removeFromLeft(buttonWidth).reduced(10, 0));
     bypassButton_.setBounds(buttonRow.removeFromLeft(buttonWidth).reduced(10, 0));
+    fixedLatencyButton_.setBounds(buttonRow.removeFromLeft(buttonWidth).reduced(10, 0));
+    peakLookaheadButton_.setBounds(buttonRow.reduced(10, 0));
+
+    // Selectors below the toggles
+    auto selectorRow = centerSection.removeFromTop(30);
+    auto selectorWidth = selectorRow.getWidth() / 4;
+
+    auto linkModeArea = selectorRow.removeFromLeft(selectorWidth);
+    linkModeLabel_.setBounds(linkModeArea.removeFromLeft(labelWidth));
+    linkModeBox_.setBounds(linkModeArea.reduced(5, 2));
+
+    auto curveSmoothingArea = selectorRow.removeFromLeft(selectorWidth);
+    curveSmoothingLabel_.setBounds(curveSmoothingArea.removeFromLeft(labelWidth));
+    curveSmoothingBox_.setBounds(curveSmoothingArea.reduced(5, 2));
+
+    auto gainRateArea = selectorRow.removeFromLeft(selectorWidth);
+    gainRateLabel_.setBounds(gainRateArea.removeFromLeft(labelWidth));
+    gainRateBox_.setBounds(gainRateArea.reduced(5, 2));
+
+    detectorLabel_.setBounds(selectorRow.removeFromLeft(labelWidth));
+    detectorBox_.setBounds(selectorRow.reduced(5, 2));
+
+    // Sidechain source, bands and oversampling on a row of their own
+    auto sourceRow = centerSection.removeFromTop(30);
+
+    auto sidechainArea = sourceRow.removeFromLeft(selectorWidth);
+    sidechainLabel_.setBounds(sidechainArea.removeFromLeft(labelWidth));
+    sidechainBox_.setBounds(sidechainArea.reduced(5, 2));
+
+    auto bandsArea = sourceRow.removeFromLeft(selectorWidth);
+    bandsLabel_.setBounds(bandsArea.removeFromLeft(labelWidth));
+    bandsBox_.setBounds(bandsArea.reduced(5, 2));
+
+    auto oversamplingArea = sourceRow.removeFromLeft(selectorWidth);
+    oversamplingLabel_.setBounds(oversamplingArea.removeFromLeft(labelWidth));
+    oversamplingBox_.setBounds(oversamplingArea.reduced(5, 2));
+
+    oversampledDetectionButton_.setBounds(sourceRow.reduced(10, 0));
+
+    // Crossover knobs (used with two or more bands)
+    centerSection.removeFromTop(10);
+    auto crossoverRow = centerSection.removeFromTop(90);
+    auto crossoverWidth = crossoverRow.getWidth() / static_cast<int>(crossoverSliders_.size());
+
+    for (size_t k = 0; k < crossoverSliders_.size(); ++k)
+    {
+        auto crossoverArea = crossoverRow.removeFromLeft(crossoverWidth);
+        crossoverLabels_[k].setBounds(crossoverArea.removeFromTop(20));
+        crossoverSliders_[k].setBounds(crossoverArea);
+    }
 }
 
 void BroadbandCompressorAudioProcessorEditor::timerCallback()
 {
-    // Update gain reduction meter
-    gainReductionMeter_.setGainReductionDb(processorRef.getGainReductionDb());
+    // Drain metering frames from the audio thread
+    DSP::TelemetryFrame frame;
+
+    while (processorRef.popTelemetryFrame(frame))
+    {
+        gainReductionMeter_.addFrame(frame);
+        transferCurve_.addFrame(frame);
+    }
 
     // Update transfer curve visualization
     auto& vts = processorRef.getValueTreeState();
@@ -230,5 +347,4 @@ void BroadbandCompressorAudioProcessorEditor::timerCallback()
     float kneeWidth = *vts.getRawParameterValue(Parameters::ID::kneeWidth);
 
     transferCurve_.setCompressionParams(threshold, ratio, kneeWidth);
-    transferCurve_.setCurrentInputLevel(processorRef.getInputLevelDb());
 }
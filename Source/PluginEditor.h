@@ -51,10 +51,24 @@ private:
     juce::Slider releaseTimeSlider_;
     juce::Slider holdTimeSlider_;
     juce::Slider lookaheadTimeSlider_;
+    std::array<juce::Slider, 4> crossoverSliders_;
 
     // Toggle buttons
     juce::ToggleButton linkedButton_{ "Linked" };
     juce::ToggleButton bypassButton_{ "Bypass" };
+    juce::ToggleButton fixedLatencyButton_{ "Fixed Latency" };
+    juce::ToggleButton peakLookaheadButton_{ "Peak Lookahead" };
+    juce::ToggleButton oversampledDetectionButton_{ "Oversampled Detection" };
+
+    // Link mode selector (used while Linked is on), curve smoothing, gain rate,
+    // detector, sidechain source, bands and oversampling
+    juce::ComboBox linkModeBox_;
+    juce::ComboBox curveSmoothingBox_;
+    juce::ComboBox gainRateBox_;
+    juce::ComboBox detectorBox_;
+    juce::ComboBox sidechainBox_;
+    juce::ComboBox bandsBox_;
+    juce::ComboBox oversamplingBox_;
 
     // Labels
     juce::Label inputGainLabel_;
@@ -66,6 +80,14 @@ private:
     juce::Label releaseTimeLabel_;
     juce::Label holdTimeLabel_;
     juce::Label lookaheadTimeLabel_;
+    juce::Label linkModeLabel_;
+    juce::Label curveSmoothingLabel_;
+    juce::Label gainRateLabel_;
+    juce::Label detectorLabel_;
+    juce::Label sidechainLabel_;
+    juce::Label bandsLabel_;
+    juce::Label oversamplingLabel_;
+    std::array<juce::Label, 4> crossoverLabels_;
     juce::Label titleLabel_;
     juce::Label grLabel_;  // Gain reduction meter label
 
@@ -79,8 +101,19 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> releaseTimeAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> holdTimeAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lookaheadTimeAttachment_;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, 4> crossoverAttachments_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> linkedAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> fixedLatencyAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> peakLookaheadAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> oversampledDetectionAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> linkModeAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> curveSmoothingAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> gainRateAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> detectorAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> sidechainAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> bandsAttachment_;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttachment_;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BroadbandCompressorAudioProcessorEditor)
 };
@@ -1,12 +1,14 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ChannelGroups.h"
 #include "DSP/Utilities.h"
 
 //==============================================================================
 BroadbandCompressorAudioProcessor::BroadbandCompressorAudioProcessor()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
-                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+                         .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)),
       parameters_(*this, nullptr, juce::Identifier("XRVST_Plugins"),
                   Parameters::createParameterLayout())
 {
@@ -22,10 +24,30 @@ BroadbandCompressorAudioProcessor::BroadbandCompressorAudioProcessor()
     releaseTimeParam_ = parameters_.getRawParameterValue(Parameters::ID::releaseTime);
     holdTimeParam_ = parameters_.getRawParameterValue(Parameters::ID::holdTime);
     lookaheadTimeParam_ = parameters_.getRawParameterValue(Parameters::ID::lookaheadTime);
+    fixedLatencyParam_ = parameters_.getRawParameterValue(Parameters::ID::fixedLatency);
+    peakLookaheadParam_ = parameters_.getRawParameterValue(Parameters::ID::peakLookahead);
+    linkModeParam_ = parameters_.getRawParameterValue(Parameters::ID::linkMode);
+    curveSmoothingParam_ = parameters_.getRawParameterValue(Parameters::ID::curveSmoothing);
+    gainRateParam_ = parameters_.getRawParameterValue(Parameters::ID::gainRate);
+    detectorParam_ = parameters_.getRawParameterValue(Parameters::ID::detector);
+    sidechainParam_ = parameters_.getRawParameterValue(Parameters::ID::sidechain);
+    bandsParam_ = parameters_.getRawParameterValue(Parameters::ID::bands);
+
+    for (size_t k = 0; k < crossoverParams_.size(); ++k)
+        crossoverParams_[k] = parameters_.getRawParameterValue(Parameters::ID::crossover[k]);
+
+    oversamplingParam_ = parameters_.getRawParameterValue(Parameters::ID::oversampling);
+    oversampledDetectionParam_ = parameters_.getRawParameterValue(Parameters::ID::oversampledDetection);
+
+    // Track changes so unchanged parameters cost nothing per block
+    for (const auto& id : Parameters::ID::all)
+        parameters_.addParameterListener(id, this);
 }
 
 BroadbandCompressorAudioProcessor::~BroadbandCompressorAudioProcessor()
 {
+    for (const auto& id : Parameters::ID::all)
+        parameters_.removeParameterListener(id, this);
 }
 
 //==============================================================================
@@ -80,82 +102,95 @@ void BroadbandCompressorAudioProcessor::changeProgramName(int /*index*/, const j
 //==============================================================================
 void BroadbandCompressorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    currentSampleRate_ = sampleRate;
-
-    // Initialize level estimator
-    levelEstimator_.setSampleRate(static_cast<float>(sampleRate));
-    levelEstimator_.setAttackTimeMs(*attackTimeParam_);
-    levelEstimator_.setReleaseTimeMs(*releaseTimeParam_);
-    levelEstimator_.setHoldTimeMs(*holdTimeParam_);
-
-    // Initialize delay lines for each channel
-    int numChannels = getTotalNumInputChannels();
-    delayLines_.resize(numChannels);
-    levelStates_.resize(numChannels);
-
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        delayLines_[ch].prepare(kMaxLookaheadSamples);
-        delayLines_[ch].setDelayMs(*lookaheadTimeParam_, static_cast<float>(sampleRate));
-        levelStates_[ch].reset();
-    }
-
-    // Allocate level buffer
-    levelBuffer_.setSize(1, samplesPerBlock);
+    // Initialize the engine; lookahead covers the full parameter range,
+    // which is also the latency reported in fixed-latency mode
+    compressor_.prepare(sampleRate, static_cast<size_t>(samplesPerBlock),
+                        static_cast<size_t>(getMainBusNumInputChannels()),
+                        Parameters::Range::lookaheadTime.end);
+    compressor_.setChannelGroups(ChannelGroups::getChannelGroups(getChannelLayoutOfBus(true, 0)));
+    compressor_.setLatencySettleTimeMs(kLatencySettleMs);
+
+    // Pick up the current parameters, then start from them without fading
+    appliedParameterVersion_ = parameterVersion_.load(std::memory_order_acquire);
+    updateParameters();
+    compressor_.reset();
 
-    // Initialize gain smoothing
-    inputGainSmoothed_.reset(sampleRate, 0.02);  // 20ms smoothing
-    outputGainSmoothed_.reset(sampleRate, 0.02);
+    setLatencySamples(static_cast<int>(compressor_.getReportedLatencySamples()));
 
-    // Update compression curve parameters
-    updateParameters();
+    // Telemetry frames of ~1 ms
+    telemetry_.prepare(static_cast<size_t>(std::max(16.0, sampleRate / 1000.0)),
+                       static_cast<size_t>(samplesPerBlock));
 }
 
 void BroadbandCompressorAudioProcessor::releaseResources()
 {
-    // Clear delay lines
-    for (auto& delay : delayLines_)
-        delay.reset();
-
-    // Clear level states
-    for (auto& state : levelStates_)
-        state.reset();
+    // Clear delay lines and level states
+    compressor_.reset();
 }
 
 bool BroadbandCompressorAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    // Support mono and stereo configurations
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Support any discrete or ambisonic layout up to kMaxChannels
+    auto outputLayout = layouts.getMainOutputChannelSet();
+
+    if (outputLayout.isDisabled() || outputLayout.size() > kMaxChannels)
         return false;
 
     // Input and output must match
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
 
+    // The sidechain is optional: mono, stereo or the main layout
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechainLayout = layouts.getChannelSet(true, 1);
+
+        if (!sidechainLayout.isDisabled() && sidechainLayout != juce::AudioChannelSet::mono()
+            && sidechainLayout != juce::AudioChannelSet::stereo() && sidechainLayout != outputLayout)
+            return false;
+    }
+
     return true;
 }
 
+void BroadbandCompressorAudioProcessor::parameterChanged(const juce::String& /*parameterID*/, float /*newValue*/)
+{
+    // May be called on any thread; the new value is already stored
+    parameterVersion_.fetch_add(1, std::memory_order_release);
+}
+
 void BroadbandCompressorAudioProcessor::updateParameters()
 {
-    // Update level estimator
-    levelEstimator_.setAttackTimeMs(*attackTimeParam_);
-    levelEstimator_.setReleaseTimeMs(*releaseTimeParam_);
-    levelEstimator_.setHoldTimeMs(*holdTimeParam_);
-
-    // Update compression curve
-    compressionCurve_.setThresholdDb(*thresholdParam_);
-    compressionCurve_.setCompressionRatio(*ratioParam_);
-    compressionCurve_.setKneeWidthDb(*kneeWidthParam_);
-    compressionCurve_.setMakeupGainDb(*outputGainParam_);
-
-    // Update delay lines
-    for (auto& delay : delayLines_)
-        delay.setDelayMs(*lookaheadTimeParam_, static_cast<float>(currentSampleRate_));
-
-    // Update gain smoothing targets
-    inputGainSmoothed_.setTargetValue(DSP::db2Mag(*inputGainParam_));
-    outputGainSmoothed_.setTargetValue(DSP::db2Mag(*outputGainParam_));
+    DSP::CompressorSettings settings;
+    settings.linked = *linkedParam_ > 0.5f;
+    settings.inputGainDb = *inputGainParam_;
+    settings.thresholdDb = *thresholdParam_;
+    settings.ratio = *ratioParam_;
+    settings.kneeWidthDb = *kneeWidthParam_;
+    settings.outputGainDb = *outputGainParam_;
+    settings.attackTimeMs = *attackTimeParam_;
+    settings.releaseTimeMs = *releaseTimeParam_;
+    settings.holdTimeMs = *holdTimeParam_;
+    settings.lookaheadTimeMs = *lookaheadTimeParam_;
+    settings.fixedLatency = *fixedLatencyParam_ > 0.5f;
+    settings.peakLookahead = *peakLookaheadParam_ > 0.5f;
+    settings.linkMode = static_cast<int>(*linkModeParam_);
+    settings.curveSmoothing = static_cast<int>(*curveSmoothingParam_);
+    settings.gainRate = static_cast<int>(*gainRateParam_);
+    settings.detector = static_cast<int>(*detectorParam_);
+    settings.sidechain = static_cast<int>(*sidechainParam_);
+    settings.bands = static_cast<int>(*bandsParam_);
+
+    for (size_t k = 0; k < crossoverParams_.size(); ++k)
+        settings.crossoverHz[k] = *crossoverParams_[k];
+
+    settings.oversampling = static_cast<int>(*oversamplingParam_);
+    settings.oversampledDetection = *oversampledDetectionParam_ > 0.5f;
+
+    // Shared with the offline renderer, so both drive the engine identically
+    settings.applyTo(compressor_);
+
+    coefficientUpdates_.store(compressor_.getNumCoefficientUpdates(), std::memory_order_relaxed);
 }
 
 void BroadbandCompressorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
@@ -163,8 +198,13 @@ void BroadbandCompressorAudioProcessor::processBlock(juce::AudioBuffer<float>& b
 {
     juce::ScopedNoDenormals noDenormals;
 
-    int totalNumInputChannels = getTotalNumInputChannels();
-    int totalNumOutputChannels = getTotalNumOutputChannels();
+    // The sidechain channels follow the main ones in the host buffer; both
+    // views share its memory
+    auto mainBuffer = getBusBuffer(buffer, true, 0);
+    auto sidechainBuffer = getBusBuffer(buffer, true, 1);
+
+    int totalNumInputChannels = mainBuffer.getNumChannels();
+    int totalNumOutputChannels = getMainBusNumOutputChannels();
     int numSamples = buffer.getNumSamples();
 
     // Clear any extra output channels
@@ -174,125 +214,50 @@ void BroadbandCompressorAudioProcessor::processBlock(juce::AudioBuffer<float>& b
     // Check bypass
     if (*bypassParam_ > 0.5f)
     {
-        currentGainReductionDb_.store(0.0f);
-        return;
-    }
-
-    // Update parameters (could be automated)
-    updateParameters();
-
-    // Report latency for lookahead
-    int lookaheadSamples = static_cast<int>(*lookaheadTimeParam_ * currentSampleRate_ / 1000.0f);
-    setLatencySamples(lookaheadSamples);
+        // Keep the meters running on the unprocessed signal
+        telemetry_.beginBlock(static_cast<size_t>(numSamples));
 
-    // Process compression
-    processCompression(buffer);
-}
-
-void BroadbandCompressorAudioProcessor::processCompression(juce::AudioBuffer<float>& buffer)
-{
-    int numChannels = buffer.getNumChannels();
-    int numSamples = buffer.getNumSamples();
-    bool linked = *linkedParam_ > 0.5f;
-
-    // Ensure we have enough channels
-    if (numChannels > static_cast<int>(delayLines_.size()))
-        return;
-
-    // Resize level buffer if needed
-    if (levelBuffer_.getNumSamples() < numSamples)
-        levelBuffer_.setSize(1, numSamples, false, false, true);
-
-    // Clear level buffer for linked mode
-    if (linked)
-        levelBuffer_.clear();
-
-    // Calculate input level for metering
-    float maxInputLevel = 0.0f;
-
-    // Phase 1: Apply input gain and estimate levels
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        float* channelData = buffer.getWritePointer(ch);
-
-        // Apply input gain
-        for (int i = 0; i < numSamples; ++i)
+        for (int ch = 0; ch < totalNumInputChannels; ++ch)
         {
-            float gain = inputGainSmoothed_.getNextValue();
-            channelData[i] *= gain;
-
-            // Track input level
-            float absLevel = std::fabs(channelData[i]);
-            if (absLevel > maxInputLevel)
-                maxInputLevel = absLevel;
+            telemetry_.addInput(buffer.getReadPointer(ch));
+            telemetry_.addOutput(buffer.getReadPointer(ch));
         }
 
-        // Estimate level for this channel
-        float* levelData = levelBuffer_.getWritePointer(0);
-
-        if (linked)
-        {
-            // Linked mode: accumulate max level across channels
-            levelEstimator_.estimateLevelLinked(channelData, levelData, numSamples,
-                                                 levelStates_[ch], ch > 0);
-        }
-        else
-        {
-            // Independent mode: estimate for this channel only
-            levelEstimator_.estimateLevel(channelData, levelData, numSamples, levelStates_[ch]);
-        }
+        telemetry_.endBlock(telemetryRing_);
+        return;
     }
 
-    // Update input level meter
-    currentInputLevelDb_.store(DSP::mag2Db(maxInputLevel));
-
-    // Phase 2: Apply compression
-    float maxGainReduction = 0.0f;
-    float maxOutputLevel = 0.0f;
-    float* levelData = levelBuffer_.getWritePointer(0);
+    // Update parameters only if one was changed since the last block. The
+    // version is read before the values, so a change that races with this
+    // block is picked up by the next one.
+    auto version = parameterVersion_.load(std::memory_order_acquire);
 
-    for (int ch = 0; ch < numChannels; ++ch)
+    if (version != appliedParameterVersion_)
     {
-        float* channelData = buffer.getWritePointer(ch);
-
-        // If not linked, we need to recalculate level for this channel
-        if (!linked && ch > 0)
-        {
-            levelEstimator_.estimateLevel(channelData, levelData, numSamples, levelStates_[ch]);
-        }
-
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // Get level estimate
-            float level = levelData[i];
-
-            // Calculate compression gain
-            float gainDb = compressionCurve_.calculateCompressionGainDb(DSP::mag2Db(level));
-            float gain = DSP::db2Mag(gainDb);
-
-            // Track max gain reduction
-            if (gainDb < maxGainReduction)
-                maxGainReduction = gainDb;
+        appliedParameterVersion_ = version;
+        updateParameters();
+    }
 
-            // Apply lookahead delay
-            float delayedSample = delayLines_[ch].processSample(channelData[i]);
+    // The detectors read the sidechain in place (none while the bus is disabled)
+    compressor_.setSidechainInputs(sidechainBuffer.getNumChannels() > 0 ? sidechainBuffer.getArrayOfReadPointers()
+                                                                         : nullptr,
+                                   static_cast<size_t>(sidechainBuffer.getNumChannels()));
 
-            // Apply compression gain and output gain
-            float outputGain = outputGainSmoothed_.getNextValue();
-            float outputSample = delayedSample * gain * outputGain;
+    // The engine was prepared for the main bus; another channel count still
+    // processes (see Compressor::process) but points at a layout mismatch
+    jassert(static_cast<size_t>(mainBuffer.getNumChannels()) == compressor_.getNumChannels());
 
-            channelData[i] = outputSample;
+    // Process compression
+    compressor_.process(mainBuffer.getArrayOfWritePointers(),
+                        static_cast<size_t>(mainBuffer.getNumChannels()),
+                        static_cast<size_t>(numSamples),
+                        &telemetry_, &telemetryRing_);
 
-            // Track output level
-            float absOutput = std::fabs(outputSample);
-            if (absOutput > maxOutputLevel)
-                maxOutputLevel = absOutput;
-        }
-    }
+    skippedBlocks_.store(compressor_.getNumSkippedBlocks(), std::memory_order_relaxed);
 
-    // Update meters
-    currentGainReductionDb_.store(maxGainReduction);
-    currentOutputLevelDb_.store(DSP::mag2Db(maxOutputLevel));
+    // Report latency for lookahead once it has settled
+    if (compressor_.advanceLatency(static_cast<size_t>(numSamples)))
+        setLatencySamples(static_cast<int>(compressor_.getReportedLatencySamples()));
 }
 
 //==============================================================================
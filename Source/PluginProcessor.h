@@ -2,9 +2,10 @@
 
 #include <JuceHeader.h>
 #include "Parameters.h"
-#include "DSP/LevelEstimator.h"
-#include "DSP/CompressionCurve.h"
-#include "DSP/DelayLine.h"
+#include "DSP/Compressor.h"
+#include "DSP/CompressorSettings.h"
+#include "DSP/SpscRing.h"
+#include "DSP/Telemetry.h"
 
 //==============================================================================
 /**
@@ -14,9 +15,18 @@
     - Soft-knee compression curve
     - Attack, release, and hold envelope detection
     - Lookahead for transient-aware compression
-    - Linked stereo mode for image preservation
+    - Threshold, ratio and knee changes ramped per sample or per sub-block
+    - Any discrete or ambisonic layout up to kMaxChannels channels, linked
+      across all channels, per speaker group / ambisonic order, or from W
+    - An optional sidechain input (mono, per channel or summed) keying the
+      detectors
+    - An optional split into up to five Linkwitz-Riley bands, each compressed
+      on its own with the same settings
+    - Optional 2x, 4x or 8x oversampling of the gain (and detection), with the
+      filters' latency reported to the host
 */
-class BroadbandCompressorAudioProcessor : public juce::AudioProcessor
+class BroadbandCompressorAudioProcessor : public juce::AudioProcessor,
+                                          private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
@@ -58,18 +68,22 @@ public:
     // Parameter access
     juce::AudioProcessorValueTreeState& getValueTreeState() { return parameters_; }
 
-    // Metering (thread-safe access for GUI)
-    float getGainReductionDb() const { return currentGainReductionDb_.load(); }
-    float getInputLevelDb() const { return currentInputLevelDb_.load(); }
-    float getOutputLevelDb() const { return currentOutputLevelDb_.load(); }
+    // Metering (wait-free; call from a single GUI thread only)
+    bool popTelemetryFrame(DSP::TelemetryFrame& frame) { return telemetryRing_.pop(frame); }
 
     // For transfer curve visualization
-    const DSP::CompressionCurve& getCompressionCurve() const { return compressionCurve_; }
+    const DSP::CompressionCurve& getCompressionCurve() const { return compressor_.getCompressionCurve(); }
+
+    // Coefficient recomputations so far (stays flat while no parameter moves)
+    size_t getNumCoefficientUpdates() const { return coefficientUpdates_.load(std::memory_order_relaxed); }
+
+    // Sub-blocks of silence that skipped the detector and gain computer so far
+    size_t getNumSkippedBlocks() const { return skippedBlocks_.load(std::memory_order_relaxed); }
 
 private:
     //==============================================================================
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
     void updateParameters();
-    void processCompression(juce::AudioBuffer<float>& buffer);
 
     //==============================================================================
     // Parameters
@@ -87,30 +101,39 @@ private:
     std::atomic<float>* releaseTimeParam_ = nullptr;
     std::atomic<float>* holdTimeParam_ = nullptr;
     std::atomic<float>* lookaheadTimeParam_ = nullptr;
-
-    // DSP components
-    DSP::LevelEstimator levelEstimator_;
-    DSP::CompressionCurve compressionCurve_;
-    std::vector<DSP::DelayLine> delayLines_;
-    std::vector<DSP::LevelEstimator::State> levelStates_;
-
-    // Processing buffers
-    juce::AudioBuffer<float> levelBuffer_;
-
-    // Gain smoothing
-    juce::SmoothedValue<float> inputGainSmoothed_;
-    juce::SmoothedValue<float> outputGainSmoothed_;
-
-    // Metering
-    std::atomic<float> currentGainReductionDb_{ 0.0f };
-    std::atomic<float> currentInputLevelDb_{ -100.0f };
-    std::atomic<float> currentOutputLevelDb_{ -100.0f };
-
-    // Sample rate
-    double currentSampleRate_ = 44100.0;
-
-    // Max lookahead delay samples (30ms at 192kHz)
-    static constexpr size_t kMaxLookaheadSamples = 5760;
+    std::atomic<float>* fixedLatencyParam_ = nullptr;
+    std::atomic<float>* peakLookaheadParam_ = nullptr;
+    std::atomic<float>* linkModeParam_ = nullptr;
+    std::atomic<float>* curveSmoothingParam_ = nullptr;
+    std::atomic<float>* gainRateParam_ = nullptr;
+    std::atomic<float>* detectorParam_ = nullptr;
+    std::atomic<float>* sidechainParam_ = nullptr;
+    std::atomic<float>* bandsParam_ = nullptr;
+    std::array<std::atomic<float>*, 4> crossoverParams_{};
+    std::atomic<float>* oversamplingParam_ = nullptr;
+    std::atomic<float>* oversampledDetectionParam_ = nullptr;
+
+    // Change detection: bumped by the listener, compared on the audio thread
+    std::atomic<uint32_t> parameterVersion_{ 0 };
+    uint32_t appliedParameterVersion_ = 0;
+    std::atomic<size_t> coefficientUpdates_{ 0 };
+    std::atomic<size_t> skippedBlocks_{ 0 };
+
+    // DSP engine (level detection, gain computer, lookahead, gain smoothing)
+    DSP::Compressor compressor_;
+
+    // Metering: decimated frames from the audio thread to the GUI
+    DSP::TelemetryCollector telemetry_;
+    DSP::SpscRing<DSP::TelemetryFrame> telemetryRing_{ kTelemetryRingSize };
+
+    // Widest supported bus (7th-order ambisonics)
+    static constexpr int kMaxChannels = 64;
+
+    // Telemetry frames buffered for the GUI (~2 s of 1 ms frames)
+    static constexpr size_t kTelemetryRingSize = 2048;
+
+    // How long a new lookahead must be stable before its latency is reported
+    static constexpr float kLatencySettleMs = 250.0f;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BroadbandCompressorAudioProcessor)
 };
@@ -0,0 +1,391 @@
+#include "FileRenderer.h"
+#include "BoundedQueue.h"
+#include "ChannelGroups.h"
+#include "ParameterRanges.h"
+#include "DSP/GainEnvelope.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace Render
+{
+
+namespace
+{
+
+// Input mapped at a time; pages of earlier windows are released on remapping
+constexpr juce::int64 kMapWindowBytes = 32 << 20;
+
+// Output stream buffer, so the encoder issues few large writes
+constexpr size_t kWriteBufferBytes = 1 << 20;
+
+/** One pipeline block; the buffers are reused for the whole file. */
+struct Block
+{
+    juce::AudioBuffer<float> audio;
+    juce::AudioBuffer<float> gains;  // One channel per compressor group, when analyzing
+    int numSamples = 0;
+};
+
+/** The bus layout the plugin would see for this file. */
+juce::AudioChannelSet getChannelLayout(juce::AudioFormatReader& reader, bool ambisonic)
+{
+    int numChannels = static_cast<int>(reader.numChannels);
+
+    if (ambisonic)
+    {
+        int order = 0;
+        while ((order + 1) * (order + 1) < numChannels)
+            ++order;
+
+        if ((order + 1) * (order + 1) == numChannels)
+            return juce::AudioChannelSet::ambisonic(order);
+    }
+
+    // Files without a channel mask fall back to discrete channels
+    auto layout = reader.getChannelLayout();
+    return layout.size() == numChannels ? layout : juce::AudioChannelSet::discreteChannels(numChannels);
+}
+
+/** The track (compressor group) whose gain each channel receives. */
+std::vector<uint16_t> getChannelTracks(const DSP::Compressor& compressor, int numChannels)
+{
+    const auto& routing = compressor.getRouting();
+    std::vector<uint16_t> tracks(static_cast<size_t>(numChannels), 0);
+
+    for (size_t g = 0; g < routing.groups.size(); ++g)
+        for (size_t m = 0; m < routing.groups[g].numMembers; ++m)
+            tracks[routing.members[routing.groups[g].firstMember + m]] = static_cast<uint16_t>(g);
+
+    return tracks;
+}
+
+} // namespace
+
+//==============================================================================
+std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager& formatManager, const juce::File& output,
+                                                      const juce::AudioFormatReader& source, int bitsPerSample,
+                                                      juce::String& error)
+{
+    auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+
+    if (format == nullptr)
+    {
+        error = "no audio format for " + output.getFileName();
+        return nullptr;
+    }
+
+    if (bitsPerSample <= 0)
+        bitsPerSample = static_cast<int>(source.bitsPerSample);
+
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(output.createOutputStream(kWriteBufferBytes));
+
+    if (stream == nullptr)
+    {
+        error = "cannot create " + output.getFullPathName();
+        return nullptr;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        format->createWriterFor(stream.get(), source.sampleRate, source.numChannels, bitsPerSample,
+                                source.metadataValues, 0));
+
+    if (writer == nullptr)
+    {
+        error = format->getFormatName() + " cannot write " + juce::String(source.numChannels)
+              + " channels at " + juce::String(bitsPerSample) + " bits";
+        output.deleteFile();
+        return nullptr;
+    }
+
+    // Now owned by the writer
+    stream.release();
+    return writer;
+}
+
+void prepareCompressor(DSP::Compressor& compressor, juce::AudioFormatReader& reader, const RenderOptions& options)
+{
+    compressor.prepare(reader.sampleRate, options.blockSize, static_cast<size_t>(reader.numChannels),
+                       Parameters::Range::lookaheadTime.end);
+    compressor.setChannelGroups(ChannelGroups::getChannelGroups(getChannelLayout(reader, options.ambisonic)));
+    options.settings.applyTo(compressor);
+    compressor.reset();
+}
+
+juce::File getEnvelopeFile(const juce::File& directory, const juce::File& input)
+{
+    return directory.getChildFile(input.getFileNameWithoutExtension() + kEnvelopeExtension);
+}
+
+RenderResult renderFile(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                        const Section& section)
+{
+    RenderResult result;
+    result.input = input;
+    result.output = output;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (output == input)
+    {
+        result.error = "output would overwrite " + input.getFullPathName();
+        return result;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr || reader->numChannels == 0)
+    {
+        result.error = "cannot read " + input.getFullPathName();
+        return result;
+    }
+
+    int numChannels = static_cast<int>(reader->numChannels);
+    double sampleRate = reader->sampleRate;
+    result.inputBytes = input.getSize();
+
+    // Mapped reads need the whole range inside the mapped window
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+
+    if (options.memoryMap)
+        if (auto* inputFormat = formatManager.findFormatForFileExtension(input.getFileExtension()))
+            mappedReader.reset(inputFormat->createMemoryMappedReader(input));
+
+    result.memoryMapped = mappedReader != nullptr;
+
+    // Playback applies a sidecar, which is already aligned with the input
+    const bool playback = options.envelopeDirectory != juce::File();
+    std::unique_ptr<juce::MemoryMappedFile> envelopeFile;
+    DSP::GainEnvelopePlayer player;
+
+    if (playback)
+    {
+        auto envelope = getEnvelopeFile(options.envelopeDirectory, input);
+        envelopeFile = std::make_unique<juce::MemoryMappedFile>(envelope, juce::MemoryMappedFile::readOnly);
+
+        if (envelopeFile->getData() == nullptr
+            || !player.open(static_cast<const uint8_t*>(envelopeFile->getData()), envelopeFile->getSize()))
+        {
+            result.error = "cannot open gain envelope " + envelope.getFullPathName();
+            return result;
+        }
+
+        if (player.getInfo().numChannels != static_cast<size_t>(numChannels))
+        {
+            result.error = envelope.getFileName() + " has " + juce::String(static_cast<int>(player.getInfo().numChannels))
+                         + " channels, " + input.getFileName() + " has " + juce::String(numChannels);
+            return result;
+        }
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    if (!options.analyze)
+    {
+        writer = createWriter(formatManager, output, *reader, options.bitsPerSample, result.error);
+
+        if (writer == nullptr)
+            return result;
+    }
+
+    //==============================================================================
+    DSP::Compressor compressor;
+    prepareCompressor(compressor, *reader, options);
+
+    const bool bypass = options.settings.bypass;
+    const juce::int64 length = reader->lengthInSamples;
+    const juce::int64 latency = bypass || playback || !options.compensateLatency
+                                  ? 0
+                                  : static_cast<juce::int64>(compressor.getReportedLatencySamples());
+    const int blockSize = static_cast<int>(options.blockSize);
+
+    // Gains are copied out of the engine into the blocks, and encoded in place of the audio
+    const auto channelTracks = getChannelTracks(compressor, numChannels);
+    const int numTracks = static_cast<int>(compressor.getRouting().groups.size());
+    DSP::GainEnvelopeWriter envelopeWriter;
+
+    if (options.analyze)
+        envelopeWriter.prepare(static_cast<uint32_t>(std::lround(sampleRate)), channelTracks,
+                               static_cast<size_t>(numTracks),
+                               bypass ? 1.0f : compressor.getInputGain() * compressor.getOutputGain());
+
+    // Input [first, end + latency) is processed; output [start, end) is written
+    const juce::int64 start = juce::jlimit<juce::int64>(0, length, section.start);
+    const juce::int64 end = section.length < 0 ? length : std::min(length, start + section.length);
+    const juce::int64 first = std::max<juce::int64>(0, start - section.preRoll);
+
+    //==============================================================================
+    // The free list bounds the blocks in flight; two or more let the writer overlap processing
+    std::vector<Block> blocks(std::max<size_t>(options.queueDepth, 2));
+    BoundedQueue<Block*> freeBlocks(blocks.size());
+    BoundedQueue<Block*> decoded(blocks.size());
+    BoundedQueue<Block*> processed(blocks.size());
+
+    for (auto& block : blocks)
+    {
+        block.audio.setSize(numChannels, blockSize);
+
+        if (options.analyze)
+            block.gains.setSize(numTracks, blockSize);
+
+        freeBlocks.push(&block);
+    }
+
+    juce::String readError;
+    juce::String writeError;
+
+    // Window of the input mapped at a time, in samples
+    const juce::int64 frameBytes = std::max<juce::int64>(1, numChannels * static_cast<int>(reader->bitsPerSample) / 8);
+    const juce::int64 windowLength = std::max<juce::int64>(blockSize, kMapWindowBytes / frameBytes);
+
+    // Decode. Past the end of the file the blocks are silent, which flushes the lookahead delay.
+    if (playback)
+        player.seek(static_cast<uint64_t>(first));
+
+    std::thread decoder([&] {
+        juce::Range<juce::int64> window;
+        Block* block = nullptr;
+
+        for (juce::int64 position = first; position < end + latency && freeBlocks.pop(block);
+             position += block->numSamples)
+        {
+            block->numSamples = static_cast<int>(std::min<juce::int64>(blockSize, end + latency - position));
+            int numRead = static_cast<int>(juce::jlimit<juce::int64>(0, block->numSamples, length - position));
+
+            if (numRead > 0)
+            {
+                bool ok;
+
+                if (mappedReader != nullptr)
+                {
+                    if (!window.contains(juce::Range<juce::int64>(position, position + numRead)))
+                    {
+                        window = { position, std::min(length, position + windowLength) };
+
+                        if (!mappedReader->mapSectionOfFile(window))
+                        {
+                            readError = "cannot map samples " + juce::String(position) + " of " + input.getFileName();
+                            break;
+                        }
+                    }
+
+                    ok = mappedReader->read(block->audio.getArrayOfWritePointers(), numChannels, position, numRead);
+                }
+                else
+                {
+                    ok = reader->read(block->audio.getArrayOfWritePointers(), numChannels, position, numRead);
+                }
+
+                if (!ok)
+                {
+                    readError = "read failed at sample " + juce::String(position);
+                    break;
+                }
+            }
+
+            if (numRead < block->numSamples)
+                block->audio.clear(numRead, block->numSamples - numRead);
+
+            decoded.push(block);
+        }
+
+        decoded.close();
+    });
+
+    // Encode, dropping the pre-roll and the first latency samples so the output lines up with the input
+    std::thread encoder([&] {
+        std::vector<const float*> channels(static_cast<size_t>(std::max(numChannels, numTracks)));
+        juce::int64 toSkip = start - first + latency;
+        Block* block = nullptr;
+
+        while (processed.pop(block))
+        {
+            int skip = static_cast<int>(std::min<juce::int64>(toSkip, block->numSamples));
+            toSkip -= skip;
+
+            if (options.analyze && skip < block->numSamples)
+            {
+                for (int t = 0; t < numTracks; ++t)
+                    channels[static_cast<size_t>(t)] = block->gains.getReadPointer(t, skip);
+
+                envelopeWriter.addGains(channels.data(), static_cast<size_t>(block->numSamples - skip));
+            }
+            else if (writeError.isEmpty() && skip < block->numSamples)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    channels[static_cast<size_t>(ch)] = block->audio.getReadPointer(ch, skip);
+
+                if (!writer->writeFromFloatArrays(channels.data(), numChannels, block->numSamples - skip))
+                {
+                    writeError = "write failed";
+
+                    // Stops the decoder; the blocks in flight still drain through here
+                    freeBlocks.close();
+                }
+            }
+
+            freeBlocks.push(block);
+        }
+    });
+
+    // Process on this thread, in the same floating-point mode as the plugin's processBlock()
+    {
+        juce::ScopedNoDenormals noDenormals;
+        Block* block = nullptr;
+
+        while (decoded.pop(block))
+        {
+            float* const* channels = block->audio.getArrayOfWritePointers();
+            auto numSamples = static_cast<size_t>(block->numSamples);
+
+            if (options.analyze)
+            {
+                if (bypass)
+                    for (int t = 0; t < numTracks; ++t)
+                        std::fill_n(block->gains.getWritePointer(t), numSamples, 1.0f);
+
+                compressor.setGainOutputs(block->gains.getArrayOfWritePointers());
+            }
+
+            if (playback)
+                player.process(channels, static_cast<size_t>(numChannels), numSamples);
+            else if (!bypass)
+                compressor.process(channels, static_cast<size_t>(numChannels), numSamples);
+
+            processed.push(block);
+        }
+
+        processed.close();
+    }
+
+    decoder.join();
+    encoder.join();
+
+    // Finishes the file header
+    writer.reset();
+
+    result.error = readError.isNotEmpty() ? readError : writeError;
+
+    if (options.analyze && result.succeeded())
+    {
+        auto envelope = envelopeWriter.finish();
+
+        if (!output.replaceWithData(envelope.data(), envelope.size()))
+            result.error = "cannot write " + output.getFullPathName();
+    }
+
+    if (!result.succeeded())
+        output.deleteFile();
+
+    result.audioSeconds = static_cast<double>(end - start) / sampleRate;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+} // namespace Render
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "DSP/CompressorSettings.h"
+
+namespace Render
+{
+
+/** How every file of a batch is rendered. */
+struct RenderOptions
+{
+    DSP::CompressorSettings settings;
+
+    size_t blockSize = 4096;        // Samples per pipeline block
+    size_t queueDepth = 4;          // Blocks in flight per file
+    int bitsPerSample = 0;          // Output bit depth, 0 = same as the input
+    bool ambisonic = false;         // Treat (n+1)^2 channels as an ACN bus (per-order linking)
+    bool compensateLatency = true;  // Remove the lookahead delay, as a DAW bounce would
+    bool memoryMap = true;          // Map the input where the format allows it (WAV, AIFF)
+    bool analyze = false;           // Write a gain envelope sidecar to the output instead of audio
+    juce::File envelopeDirectory;   // Apply the inputs' sidecars from here instead of running the engine
+};
+
+/** File extension of gain envelope sidecars (see DSP/GainEnvelope.h). */
+constexpr const char* kEnvelopeExtension = ".bbge";
+
+/** Part of a file to render on its own (see renderFile). */
+struct Section
+{
+    juce::int64 start = 0;
+    juce::int64 length = -1;  // -1 renders to the end of the file
+    juce::int64 preRoll = 0;  // Samples before start run through the engine and discarded
+};
+
+/** Outcome and timing of one file. */
+struct RenderResult
+{
+    juce::File input;
+    juce::File output;
+    juce::String error;  // Empty on success
+
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    juce::int64 inputBytes = 0;
+    bool memoryMapped = false;      // Read through a mapped window rather than a stream
+
+    bool succeeded() const { return error.isEmpty(); }
+
+    /** Seconds of audio rendered per second of wall time. */
+    double getRealtimeFactor() const { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+};
+
+/**
+    Render one file through the compressor engine.
+
+    The file runs as a three-stage pipeline: a decoder thread reads blocks,
+    the calling thread compresses them and an encoder thread writes them,
+    with at most queueDepth blocks in flight. While the compressor fills
+    one block the encoder writes the previous one, so output I/O overlaps
+    processing.
+
+    The decoder maps a window of the input at a time where the format
+    supports memory mapping, and streams it otherwise. Either way only a
+    window and the blocks in flight are resident, so memory use doesn't
+    grow with the length of the file. The engine is set up exactly
+    as the plugin sets itself up in prepareToPlay(), so the samples match
+    the plugin's output for the same parameters (bit for bit when written
+    as 32-bit float).
+
+    A section starts from a reset engine: its pre-roll is processed and
+    dropped, and the section itself is written. With a long enough pre-roll
+    (see DSP::Compressor::getSettleSamples) sections rendered separately
+    join up to the serial render.
+
+    With options.analyze the compressor's gain is encoded into a gain
+    envelope sidecar instead, with the input and output gain folded in, and
+    written to output. With options.envelopeDirectory set the engine is not
+    run: the input's sidecar from that directory is applied to the dry
+    audio, which is how a device would play the file back.
+
+    @param input   File to read (any format juce::AudioFormatManager reads)
+    @param output  File to write; the format follows its extension
+    @param options Engine settings and pipeline options
+    @param section Part of the input to render (the whole file by default)
+*/
+RenderResult renderFile(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                        const Section& section = {});
+
+/** Open a writer for output with the channel count, rate and metadata of source.
+    @param bitsPerSample Output bit depth, 0 = same as the source
+    @param error         Set when nullptr is returned
+*/
+std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager& formatManager, const juce::File& output,
+                                                      const juce::AudioFormatReader& source, int bitsPerSample,
+                                                      juce::String& error);
+
+/** The gain envelope sidecar of an input in a directory: <directory>/<input name>.bbge */
+juce::File getEnvelopeFile(const juce::File& directory, const juce::File& input);
+
+/** Set an engine up for a file exactly as the plugin's prepareToPlay() does. */
+void prepareCompressor(DSP::Compressor& compressor, juce::AudioFormatReader& reader, const RenderOptions& options);
+
+} // namespace Render
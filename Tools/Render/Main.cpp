@@ -0,0 +1,482 @@
+/*
+    bbc2-render - headless batch renderer for Broadband Compressor V2.
+
+    Runs audio files through the same DSP::Compressor engine as the plugin,
+    configured from a saved plugin state, without a host. Files are rendered
+    in parallel on a work-stealing pool (largest first); each file is a
+    decode -> compress -> encode pipeline with a bounded number of blocks in
+    flight, so memory stays flat however long the file is.
+
+    Per-file and aggregate realtime factors (seconds of audio per second of
+    wall time) are printed on stderr. With --measure the report also has
+    input throughput, peak resident memory and page faults, to check that
+    memory stays flat on inputs larger than RAM. The process exits
+    non-zero if any file failed.
+
+    With --chunks, each file is also split into sections rendered on
+    separate workers. Every section runs a pre-roll from before its start
+    until the envelopes match the serial render's to within --tolerance,
+    then the sections are joined. --verify renders the file serially as
+    well and reports the largest difference.
+
+    With --sweep, each file is instead decoded into memory once and rendered
+    with every combination of the swept values, several settings at a time
+    in SIMD lanes, with the lane groups spread over the pool. A summary CSV
+    (gain reduction, output peak, RMS, crest factor) and a gain envelope
+    CSV are written per file; the audio only with --sweep-audio.
+
+    With --analyze, each file's compressor gain is written as a gain
+    envelope sidecar (<name>.bbge, see DSP/GainEnvelope.h) instead of
+    audio. --playback renders by applying those sidecars to the dry inputs
+    with no engine, as a device would; with --measure the two runs compare
+    playback's CPU time and memory with live processing. --analyze and
+    --sweep only take broadband presets without oversampling.
+
+    Usage:
+        bbc2-render [options] <input>...
+
+        --preset <file>     Plugin state (.xml) to take the parameters from
+        --set <id>=<value>  Override one parameter, e.g. --set threshold=-24
+        --list <file>       Also render the files listed in <file>, one per line
+        --out <dir>         Output directory (default: next to each input)
+        --suffix <text>     Appended to output file names (default: _bbc2)
+        --ext <ext>         Output format by extension (default: the input's)
+        --bits <n>          Output bit depth (default: the input's; 32 = float)
+        --jobs <n>          Files rendered at once (default: hardware threads)
+        --block <n>         Samples per pipeline block (default: 4096)
+        --queue <n>         Blocks in flight per file (default: 4)
+        --ambisonic         Treat (n+1)^2-channel files as ACN ambisonics
+        --keep-latency      Keep the lookahead delay instead of removing it
+        --no-mmap           Stream inputs instead of memory-mapping them
+        --measure           Report throughput, peak RSS and page faults
+        --chunks <n>        Sections per file, rendered in parallel (default: 1)
+        --tolerance <dB>    Envelope error allowed at a section start (default: -120)
+        --verify            Compare sectioned renders with serial ones
+        --sweep <id>=<values>  Sweep a parameter: <first>:<last>:<step> or <v1>,<v2>,...
+        --envelope <ms>     Sweep gain envelope interval, 0 for none (default: 10)
+        --sweep-audio       Also write the audio of every swept setting
+        --analyze           Write gain envelope sidecars instead of audio
+        --playback <dir>    Apply the sidecars in <dir> instead of running the engine
+*/
+
+#include "FileRenderer.h"
+#include "Preset.h"
+#include "ResourceUsage.h"
+#include "Sections.h"
+#include "Sweep.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//==============================================================================
+struct Options
+{
+    Render::RenderOptions render;
+    juce::Array<juce::File> inputs;
+    juce::File outputDirectory;
+    juce::String suffix = "_bbc2";
+    juce::String extension;
+    size_t numJobs = std::max(1u, std::thread::hardware_concurrency());
+    bool measure = false;
+    size_t numSections = 1;
+    float toleranceDb = Render::kDefaultSectionToleranceDb;
+    bool verify = false;
+    Render::SweepOptions sweep;
+};
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [--preset <file>] [--set <id>=<value>]... [--list <file>] [--out <dir>]\n"
+                 "       [--suffix <text>] [--ext <ext>] [--bits <n>] [--jobs <n>] [--block <n>]\n"
+                 "       [--queue <n>] [--ambisonic] [--keep-latency] [--no-mmap] [--measure]\n"
+                 "       [--chunks <n>] [--tolerance <dB>] [--verify]\n"
+                 "       [--sweep <id>=<values>]... [--envelope <ms>] [--sweep-audio]\n"
+                 "       [--analyze] [--playback <dir>] <input>...\n",
+                 program);
+}
+
+juce::File getFile(const char* path)
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    // Overrides apply after the preset, wherever they appear
+    juce::StringArray overrides;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--preset" && hasValue)
+        {
+            auto error = Render::loadPreset(getFile(argv[++i]), options.render.settings);
+
+            if (error.isNotEmpty())
+            {
+                std::fprintf(stderr, "%s\n", error.toRawUTF8());
+                return false;
+            }
+        }
+        else if (arg == "--set" && hasValue)
+            overrides.add(argv[++i]);
+        else if (arg == "--list" && hasValue)
+        {
+            juce::StringArray lines;
+            lines.addLines(getFile(argv[++i]).loadFileAsString());
+            lines.trim();
+            lines.removeEmptyStrings();
+
+            for (const auto& line : lines)
+                options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(line));
+        }
+        else if (arg == "--out" && hasValue)
+            options.outputDirectory = getFile(argv[++i]);
+        else if (arg == "--suffix" && hasValue)
+            options.suffix = argv[++i];
+        else if (arg == "--ext" && hasValue)
+            options.extension = juce::String(argv[++i]).trimCharactersAtStart(".");
+        else if (arg == "--bits" && hasValue)
+            options.render.bitsPerSample = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--jobs" && hasValue)
+            options.numJobs = static_cast<size_t>(std::max(1, juce::String(argv[++i]).getIntValue()));
+        else if (arg == "--block" && hasValue)
+            options.render.blockSize = static_cast<size_t>(std::max(1, juce::String(argv[++i]).getIntValue()));
+        else if (arg == "--queue" && hasValue)
+            options.render.queueDepth = static_cast<size_t>(std::max(1, juce::String(argv[++i]).getIntValue()));
+        else if (arg == "--ambisonic")
+            options.render.ambisonic = true;
+        else if (arg == "--keep-latency")
+            options.render.compensateLatency = false;
+        else if (arg == "--no-mmap")
+            options.render.memoryMap = false;
+        else if (arg == "--measure")
+            options.measure = true;
+        else if (arg == "--chunks" && hasValue)
+            options.numSections = static_cast<size_t>(std::max(1, juce::String(argv[++i]).getIntValue()));
+        else if (arg == "--tolerance" && hasValue)
+            options.toleranceDb = std::min(-1.0f, juce::String(argv[++i]).getFloatValue());
+        else if (arg == "--verify")
+            options.verify = true;
+        else if (arg == "--sweep" && hasValue)
+        {
+            Render::SweepAxis axis;
+            auto error = Render::parseSweepAxis(argv[++i], axis);
+
+            if (error.isNotEmpty())
+            {
+                std::fprintf(stderr, "%s\n", error.toRawUTF8());
+                return false;
+            }
+
+            options.sweep.axes.push_back(axis);
+        }
+        else if (arg == "--envelope" && hasValue)
+            options.sweep.envelopeMs = std::max(0.0, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--sweep-audio")
+            options.sweep.writeAudio = true;
+        else if (arg == "--analyze")
+            options.render.analyze = true;
+        else if (arg == "--playback" && hasValue)
+            options.render.envelopeDirectory = getFile(argv[++i]);
+        else if (!arg.startsWith("--"))
+            options.inputs.add(getFile(argv[i]));
+        else
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    for (const auto& assignment : overrides)
+    {
+        auto id = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+        auto value = assignment.fromFirstOccurrenceOf("=", false, false).trim();
+
+        if (!assignment.contains("=") || !Render::setParameter(options.render.settings, id, value.getFloatValue()))
+        {
+            std::fprintf(stderr, "invalid parameter override '%s'\n", assignment.toRawUTF8());
+            return false;
+        }
+    }
+
+    if (options.inputs.isEmpty())
+    {
+        printUsage(argv[0]);
+        return false;
+    }
+
+    int numModes = (options.render.analyze ? 1 : 0) + (options.render.envelopeDirectory != juce::File() ? 1 : 0)
+                 + (options.sweep.axes.empty() ? 0 : 1);
+
+    if (numModes > 1 || (options.render.analyze && options.numSections > 1))
+    {
+        std::fprintf(stderr, "--analyze, --playback and --sweep exclude each other, and --analyze --chunks\n");
+        return false;
+    }
+
+    // Gain envelopes and swept lanes apply one gain per channel at the base
+    // rate, which neither bands nor oversampled gains can be reduced to
+    const auto& settings = options.render.settings;
+
+    if ((options.render.analyze || !options.sweep.axes.empty())
+        && (settings.getNumBands() > 1 || settings.getOversampling() > 1))
+    {
+        std::fprintf(stderr, "--analyze and --sweep need a broadband preset without oversampling "
+                             "(bands = 0, oversampling = 0)\n");
+        return false;
+    }
+
+    return true;
+}
+
+juce::File getOutputFile(const Options& options, const juce::File& input)
+{
+    auto directory = options.outputDirectory == juce::File() ? input.getParentDirectory() : options.outputDirectory;
+    auto extension = options.extension.isNotEmpty() ? "." + options.extension : input.getFileExtension();
+
+    if (options.render.analyze)
+        return Render::getEnvelopeFile(directory, input);
+
+    return directory.getChildFile(input.getFileNameWithoutExtension() + options.suffix + extension);
+}
+
+void printResult(const Render::RenderResult& result)
+{
+    if (result.succeeded())
+        std::fprintf(stderr, "%8.1fx  %9.2f s  %-6s  %s\n", result.getRealtimeFactor(), result.audioSeconds,
+                     result.memoryMapped ? "mmap" : "stream", result.output.getFullPathName().toRawUTF8());
+    else
+        std::fprintf(stderr, "  FAILED  %s: %s\n", result.input.getFullPathName().toRawUTF8(),
+                     result.error.toRawUTF8());
+}
+
+//==============================================================================
+/** One file rendered as sections. */
+struct SectionedFile
+{
+    Render::SectionPlan plan;
+    std::vector<Render::RenderResult> parts;
+    Render::RenderResult reference;
+    Render::Deviation deviation;
+    double joinSeconds = 0.0;
+};
+
+/** Render each file as sections: all sections (and serial references) of all
+    files in one pass on the pool, then verify and join each file. */
+void renderSections(const Options& options, const std::vector<juce::File>& inputs,
+                    std::vector<Render::RenderResult>& results, Render::WorkStealingPool& pool, std::mutex& printMutex)
+{
+    const auto partOptions = Render::getPartOptions(options.render);
+    std::vector<SectionedFile> files(inputs.size());
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto& file = files[i];
+        auto& result = results[i];
+        result.input = inputs[i];
+        result.output = getOutputFile(options, inputs[i]);
+        result.error = result.output == result.input
+                           ? "output would overwrite " + result.input.getFullPathName()
+                           : Render::planSections(result.input, result.output, options.render, options.numSections,
+                                                  options.toleranceDb, file.plan);
+
+        if (!result.succeeded())
+            continue;
+
+        file.parts.resize(file.plan.sections.size());
+
+        for (size_t k = 0; k < file.parts.size(); ++k)
+            pool.submit([&, k] {
+                file.parts[k] = Render::renderFile(file.plan.input, file.plan.parts[k], partOptions,
+                                                   file.plan.sections[k]);
+            });
+
+        if (options.verify)
+            pool.submit([&] { file.reference = Render::renderFile(file.plan.input, file.plan.reference, partOptions); });
+    }
+
+    pool.wait();
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (!results[i].succeeded())
+            continue;
+
+        pool.submit([&, i] {
+            auto& file = files[i];
+            auto& result = results[i];
+
+            for (const auto& part : file.parts)
+            {
+                result.audioSeconds += part.audioSeconds;
+                result.inputBytes = part.inputBytes;
+                result.memoryMapped = part.memoryMapped;
+
+                // Sections run concurrently, so the file took as long as its slowest one
+                result.wallSeconds = std::max(result.wallSeconds, part.wallSeconds);
+
+                if (!part.succeeded() && result.succeeded())
+                    result.error = part.error;
+            }
+
+            if (options.verify && result.succeeded())
+                result.error = file.reference.succeeded() ? Render::compareSections(file.plan, file.deviation)
+                                                          : file.reference.error;
+
+            auto joinStart = std::chrono::steady_clock::now();
+
+            if (result.succeeded())
+                result.error = Render::joinSections(file.plan, options.render);
+            else
+                for (const auto& part : file.plan.parts)
+                    part.deleteFile();
+
+            file.joinSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - joinStart).count();
+            result.wallSeconds += file.joinSeconds;
+            file.plan.reference.deleteFile();
+
+            std::lock_guard<std::mutex> lock(printMutex);
+            printResult(result);
+
+            if (result.succeeded())
+            {
+                std::fprintf(stderr, "          %zu sections, %.1f ms pre-roll, join %.2f s\n",
+                             file.plan.sections.size(),
+                             1000.0 * static_cast<double>(file.plan.preRoll) / file.plan.sampleRate,
+                             file.joinSeconds);
+
+                if (options.verify)
+                    std::fprintf(stderr, "          serial %.2f s (%.2fx speedup), max deviation %.1f dBFS\n",
+                                 file.reference.wallSeconds,
+                                 result.wallSeconds > 0.0 ? file.reference.wallSeconds / result.wallSeconds : 0.0,
+                                 file.deviation.getDecibels());
+            }
+        });
+    }
+
+    pool.wait();
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 2;
+
+    if (options.outputDirectory != juce::File() && !options.outputDirectory.createDirectory())
+    {
+        std::fprintf(stderr, "cannot create %s\n", options.outputDirectory.getFullPathName().toRawUTF8());
+        return 2;
+    }
+
+    // Longest files first, so the last files to finish are short ones
+    std::vector<juce::File> inputs(options.inputs.begin(), options.inputs.end());
+    std::stable_sort(inputs.begin(), inputs.end(),
+                     [](const juce::File& a, const juce::File& b) { return a.getSize() > b.getSize(); });
+
+    std::vector<Render::RenderResult> results(inputs.size());
+    std::mutex printMutex;
+
+    auto usageBefore = Render::ResourceUsage::now();
+    auto start = std::chrono::steady_clock::now();
+    size_t numSteals = 0;
+
+    // Sections of one file, and sweep groups, run on separate threads
+    const bool sweeping = !options.sweep.axes.empty();
+    size_t numThreads = sweeping ? options.numJobs : std::min(options.numJobs, inputs.size() * options.numSections);
+
+    {
+        Render::WorkStealingPool pool(numThreads);
+
+        if (sweeping)
+        {
+            auto settings = Render::getSweepSettings(options.render.settings, options.sweep.axes);
+            std::fprintf(stderr, "sweeping %zu settings, %zu per group\n", settings.size(),
+                         DSP::ParameterSweep::kLanesPerGroup);
+
+            // One file at a time; its groups fill the pool
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                results[i] = Render::runSweep(inputs[i], getOutputFile(options, inputs[i]), options.render, settings,
+                                              options.sweep, pool);
+                printResult(results[i]);
+            }
+        }
+        else if (options.numSections > 1)
+        {
+            renderSections(options, inputs, results, pool, printMutex);
+        }
+        else
+        {
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                pool.submit([&, i] {
+                    results[i] = Render::renderFile(inputs[i], getOutputFile(options, inputs[i]), options.render);
+
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    printResult(results[i]);
+                });
+            }
+
+            pool.wait();
+        }
+
+        numSteals = pool.getNumSteals();
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto usageAfter = Render::ResourceUsage::now();
+    double audioSeconds = 0.0;
+    double inputBytes = 0.0;
+    size_t numFailed = 0;
+
+    for (const auto& result : results)
+    {
+        if (result.succeeded())
+        {
+            audioSeconds += result.audioSeconds;
+            inputBytes += static_cast<double>(result.inputBytes);
+        }
+        else
+        {
+            ++numFailed;
+        }
+    }
+
+    std::fprintf(stderr, "\n%zu files (%zu failed), %.2f s of audio in %.2f s on %zu threads (%zu stolen)\n",
+                 results.size(), numFailed, audioSeconds, wallSeconds,
+                 numThreads, numSteals);
+    std::fprintf(stderr, "aggregate realtime factor: %.1fx\n", wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0);
+
+    if (options.measure)
+    {
+        constexpr double kMiB = 1024.0 * 1024.0;
+
+        std::fprintf(stderr, "throughput: %.1f MiB/s of input (%.1f MiB)\n",
+                     wallSeconds > 0.0 ? inputBytes / kMiB / wallSeconds : 0.0, inputBytes / kMiB);
+
+        if (usageAfter.available)
+            std::fprintf(stderr, "peak RSS: %.1f MiB, page faults: %llu minor, %llu major\n",
+                         static_cast<double>(usageAfter.peakResidentBytes) / kMiB,
+                         static_cast<unsigned long long>(usageAfter.minorPageFaults - usageBefore.minorPageFaults),
+                         static_cast<unsigned long long>(usageAfter.majorPageFaults - usageBefore.majorPageFaults));
+        else
+            std::fprintf(stderr, "peak RSS and page faults are not available on this platform\n");
+    }
+
+    return numFailed == 0 ? 0 : 1;
+}
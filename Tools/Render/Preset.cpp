@@ -0,0 +1,68 @@
+#include "Preset.h"
+#include "ParameterRanges.h"
+
+namespace Render
+{
+
+namespace
+{
+
+const juce::NormalisableRange<float>* getRange(const juce::String& id)
+{
+    if (id == "inputGain" || id == "outputGain") return &Parameters::Range::gain;
+    if (id == "threshold")                       return &Parameters::Range::threshold;
+    if (id == "ratio")                           return &Parameters::Range::ratio;
+    if (id == "kneeWidth")                       return &Parameters::Range::kneeWidth;
+    if (id == "attackTime")                      return &Parameters::Range::attackTime;
+    if (id == "releaseTime")                     return &Parameters::Range::releaseTime;
+    if (id == "holdTime")                        return &Parameters::Range::holdTime;
+    if (id == "lookaheadTime")                   return &Parameters::Range::lookaheadTime;
+    if (id.startsWith("crossover"))             return &Parameters::Range::crossover;
+    return nullptr;
+}
+
+/** The value a RangedAudioParameter holds after being set to value: the
+    state is normalised on load and denormalised again, snapping both ways. */
+float toParameterValue(const juce::NormalisableRange<float>& range, float value)
+{
+    float normalised = range.convertTo0to1(range.snapToLegalValue(value));
+    return range.snapToLegalValue(range.convertFrom0to1(juce::jlimit(0.0f, 1.0f, normalised)));
+}
+
+} // namespace
+
+//==============================================================================
+bool setParameter(DSP::CompressorSettings& settings, const juce::String& id, float value)
+{
+    if (auto* range = getRange(id))
+        value = toParameterValue(*range, value);
+
+    return settings.set(id.toStdString(), value);
+}
+
+juce::String loadPreset(const juce::File& file, DSP::CompressorSettings& settings)
+{
+    auto xml = juce::XmlDocument::parse(file);
+
+    if (xml == nullptr)
+        return "cannot parse " + file.getFullPathName();
+
+    int numLoaded = 0;
+
+    for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+    {
+        auto id = param->getStringAttribute("id");
+
+        if (!setParameter(settings, id, static_cast<float>(param->getDoubleAttribute("value"))))
+            return "unknown parameter '" + id + "' in " + file.getFileName();
+
+        ++numLoaded;
+    }
+
+    if (numLoaded == 0)
+        return "no parameters in " + file.getFileName();
+
+    return {};
+}
+
+} // namespace Render
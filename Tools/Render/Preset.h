@@ -0,0 +1,23 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "DSP/CompressorSettings.h"
+
+namespace Render
+{
+
+/** Set one parameter the way the plugin would receive it: float values are
+    snapped to the parameter's range and step first, so the engine sees the
+    exact value the plugin's parameter would hold.
+    @return False if the ID is unknown
+*/
+bool setParameter(DSP::CompressorSettings& settings, const juce::String& id, float value);
+
+/** Load parameters from a saved plugin state (the XML written by
+    getStateInformation, e.g. exported from a DAW). Parameters missing
+    from the file keep their current values.
+    @return An error message, or an empty string on success
+*/
+juce::String loadPreset(const juce::File& file, DSP::CompressorSettings& settings);
+
+} // namespace Render
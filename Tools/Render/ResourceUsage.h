@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#if !defined(_WIN32)
+    #include <sys/resource.h>
+#endif
+
+namespace Render
+{
+
+/** Process-wide memory and paging counters, for the --measure report. */
+struct ResourceUsage
+{
+    bool available = false;
+    uint64_t peakResidentBytes = 0;
+    uint64_t minorPageFaults = 0;  // Served without I/O (e.g. from the page cache)
+    uint64_t majorPageFaults = 0;  // Needed a read from disk
+
+    /** Counters of the whole process so far (unavailable on Windows). */
+    static ResourceUsage now()
+    {
+        ResourceUsage usage;
+
+#if !defined(_WIN32)
+        struct rusage counters {};
+
+        if (getrusage(RUSAGE_SELF, &counters) == 0)
+        {
+            usage.available = true;
+
+#if defined(__APPLE__)
+            usage.peakResidentBytes = static_cast<uint64_t>(counters.ru_maxrss);         // Bytes
+#else
+            usage.peakResidentBytes = static_cast<uint64_t>(counters.ru_maxrss) * 1024;  // Kilobytes
+#endif
+
+            usage.minorPageFaults = static_cast<uint64_t>(counters.ru_minflt);
+            usage.majorPageFaults = static_cast<uint64_t>(counters.ru_majflt);
+        }
+#endif
+
+        return usage;
+    }
+};
+
+} // namespace Render
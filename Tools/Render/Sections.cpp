@@ -0,0 +1,185 @@
+#include "Sections.h"
+
+namespace Render
+{
+
+namespace
+{
+
+// Samples per read while joining and comparing parts
+constexpr int kCopyBlockSize = 8192;
+
+std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormatManager& formatManager, const juce::File& file)
+{
+    return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+}
+
+} // namespace
+
+//==============================================================================
+juce::String planSections(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                          size_t numSections, float toleranceDb, SectionPlan& plan)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto reader = createReader(formatManager, input);
+
+    if (reader == nullptr || reader->numChannels == 0)
+        return "cannot read " + input.getFullPathName();
+
+    // The pre-roll depends on the settings and the sample rate of this file
+    DSP::Compressor compressor;
+    prepareCompressor(compressor, *reader, options);
+
+    plan = {};
+    plan.input = input;
+    plan.output = output;
+    plan.reference = output.getSiblingFile(output.getFileNameWithoutExtension() + ".serial.wav");
+    plan.sampleRate = reader->sampleRate;
+
+    if (!options.settings.bypass)
+        plan.preRoll = static_cast<juce::int64>(compressor.getSettleSamples(std::pow(10.0f, toleranceDb / 20.0f)));
+
+    juce::int64 length = reader->lengthInSamples;
+    juce::int64 count = juce::jlimit<juce::int64>(1, std::max<juce::int64>(1, length),
+                                                  static_cast<juce::int64>(numSections));
+
+    for (juce::int64 k = 0; k < count; ++k)
+    {
+        juce::int64 start = length * k / count;
+        juce::int64 end = length * (k + 1) / count;
+
+        plan.sections.push_back({ start, end - start, plan.preRoll });
+        plan.parts.push_back(output.getSiblingFile(output.getFileNameWithoutExtension() + ".part"
+                                                   + juce::String(k) + ".wav"));
+    }
+
+    return {};
+}
+
+RenderOptions getPartOptions(const RenderOptions& options)
+{
+    RenderOptions partOptions = options;
+    partOptions.bitsPerSample = 32;
+    return partOptions;
+}
+
+//==============================================================================
+juce::String joinSections(const SectionPlan& plan, const RenderOptions& options)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto source = createReader(formatManager, plan.input);
+
+    if (source == nullptr)
+        return "cannot read " + plan.input.getFullPathName();
+
+    juce::String error;
+    auto writer = createWriter(formatManager, plan.output, *source, options.bitsPerSample, error);
+
+    if (writer != nullptr)
+    {
+        int numChannels = static_cast<int>(source->numChannels);
+        juce::AudioBuffer<float> buffer(numChannels, kCopyBlockSize);
+
+        // The parts hold the exact float output, so the output is quantized as a serial render's would be
+        for (const auto& part : plan.parts)
+        {
+            auto reader = createReader(formatManager, part);
+
+            if (reader == nullptr)
+            {
+                error = "cannot read " + part.getFullPathName();
+                break;
+            }
+
+            for (juce::int64 position = 0; position < reader->lengthInSamples && error.isEmpty();
+                 position += kCopyBlockSize)
+            {
+                int numSamples = static_cast<int>(std::min<juce::int64>(kCopyBlockSize,
+                                                                        reader->lengthInSamples - position));
+
+                if (!reader->read(buffer.getArrayOfWritePointers(), numChannels, position, numSamples)
+                    || !writer->writeFromFloatArrays(buffer.getArrayOfReadPointers(), numChannels, numSamples))
+                    error = "cannot join " + part.getFileName();
+            }
+
+            if (error.isNotEmpty())
+                break;
+        }
+
+        writer.reset();
+    }
+
+    for (const auto& part : plan.parts)
+        part.deleteFile();
+
+    if (error.isNotEmpty())
+        plan.output.deleteFile();
+
+    return error;
+}
+
+juce::String compareSections(const SectionPlan& plan, Deviation& deviation)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto reference = createReader(formatManager, plan.reference);
+
+    if (reference == nullptr)
+        return "cannot read " + plan.reference.getFullPathName();
+
+    int numChannels = static_cast<int>(reference->numChannels);
+    juce::AudioBuffer<float> expected(numChannels, kCopyBlockSize);
+    juce::AudioBuffer<float> actual(numChannels, kCopyBlockSize);
+    juce::int64 offset = 0;
+
+    deviation = {};
+
+    for (const auto& part : plan.parts)
+    {
+        auto reader = createReader(formatManager, part);
+
+        if (reader == nullptr || static_cast<int>(reader->numChannels) != numChannels)
+            return "cannot read " + part.getFullPathName();
+
+        for (juce::int64 position = 0; position < reader->lengthInSamples; position += kCopyBlockSize)
+        {
+            int numSamples = static_cast<int>(std::min<juce::int64>(kCopyBlockSize, reader->lengthInSamples - position));
+
+            if (!reader->read(actual.getArrayOfWritePointers(), numChannels, position, numSamples)
+                || !reference->read(expected.getArrayOfWritePointers(), numChannels, offset + position, numSamples))
+                return "cannot compare " + part.getFileName();
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* a = actual.getReadPointer(ch);
+                const float* b = expected.getReadPointer(ch);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    float difference = std::abs(a[i] - b[i]);
+
+                    if (difference > deviation.maxAbsolute)
+                    {
+                        deviation.maxAbsolute = difference;
+                        deviation.position = offset + position + i;
+                        deviation.channel = ch;
+                    }
+                }
+            }
+        }
+
+        offset += reader->lengthInSamples;
+    }
+
+    if (offset != reference->lengthInSamples)
+        return "sections cover " + juce::String(offset) + " of " + juce::String(reference->lengthInSamples) + " samples";
+
+    return {};
+}
+
+} // namespace Render
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "FileRenderer.h"
+#include <cmath>
+#include <vector>
+
+namespace Render
+{
+
+/**
+    One file split into sections that render in parallel.
+
+    Each section starts from a reset engine and runs a pre-roll first, long
+    enough for its envelopes to settle to the serial render's. Sections are
+    rendered to 32-bit float parts next to the output, then joined.
+*/
+struct SectionPlan
+{
+    juce::File input;
+    juce::File output;
+    std::vector<Section> sections;
+    std::vector<juce::File> parts;  // One per section, in order
+    juce::File reference;           // Serial render, for verification
+    juce::int64 preRoll = 0;
+    double sampleRate = 0.0;
+};
+
+/** Default envelope tolerance: -120 dB renders were bit-identical to serial ones in testing. */
+constexpr float kDefaultSectionToleranceDb = -120.0f;
+
+/** Split a file into sections.
+    @param numSections  Number of sections (fewer for very short files)
+    @param toleranceDb  Largest envelope difference left at a section start,
+                        relative to full scale; sets the pre-roll length
+    @return An error message, or an empty string on success
+*/
+juce::String planSections(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                          size_t numSections, float toleranceDb, SectionPlan& plan);
+
+/** Options for rendering parts and references: lossless 32-bit float WAV. */
+RenderOptions getPartOptions(const RenderOptions& options);
+
+/** Write the parts to the output in its own format, then delete them.
+    @return An error message, or an empty string on success
+*/
+juce::String joinSections(const SectionPlan& plan, const RenderOptions& options);
+
+/** Largest difference between two renders. */
+struct Deviation
+{
+    float maxAbsolute = 0.0f;
+    juce::int64 position = -1;  // Sample of the largest difference
+    int channel = -1;
+
+    float getDecibels() const { return maxAbsolute > 0.0f ? 20.0f * std::log10(maxAbsolute) : -999.0f; }
+};
+
+/** Compare the joined parts with the serial reference, sample by sample.
+    @return An error message, or an empty string on success
+*/
+juce::String compareSections(const SectionPlan& plan, Deviation& deviation);
+
+} // namespace Render
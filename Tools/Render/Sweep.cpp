@@ -0,0 +1,287 @@
+#include "Sweep.h"
+#include "Preset.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace Render
+{
+
+namespace
+{
+
+// Parameters that differ between the lanes of a DSP::ParameterSweep
+const char* const kSweepableIds[] = { "threshold", "ratio", "kneeWidth", "attackTime", "releaseTime", "holdTime" };
+
+// Guards against a step that would expand a range into millions of values
+constexpr size_t kMaxAxisValues = 10000;
+
+// Samples decoded per read
+constexpr int kDecodeBlockSize = 1 << 16;
+
+juce::File getSibling(const juce::File& output, const juce::String& suffix)
+{
+    return output.getSiblingFile(output.getFileNameWithoutExtension() + suffix);
+}
+
+juce::String getSettingColumns(const DSP::CompressorSettings& setting)
+{
+    return juce::String(setting.thresholdDb) + "," + juce::String(setting.ratio) + ","
+         + juce::String(setting.kneeWidthDb) + "," + juce::String(setting.attackTimeMs) + ","
+         + juce::String(setting.releaseTimeMs) + "," + juce::String(setting.holdTimeMs);
+}
+
+juce::String writeSummary(const juce::File& file, const std::vector<DSP::CompressorSettings>& settings,
+                          const std::vector<DSP::ParameterSweep::Summary>& summaries)
+{
+    file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(file.createOutputStream());
+
+    if (stream == nullptr)
+        return "cannot create " + file.getFullPathName();
+
+    *stream << "set,threshold,ratio,kneeWidth,attackTime,releaseTime,holdTime,"
+               "maxGainReductionDb,outputPeakDb,outputRmsDb,crestFactorDb\n";
+
+    for (size_t k = 0; k < settings.size(); ++k)
+    {
+        const auto& summary = summaries[k];
+
+        *stream << juce::String(static_cast<int>(k)) << "," << getSettingColumns(settings[k]) << ","
+                << juce::String(summary.maxGainReductionDb, 2) << "," << juce::String(summary.getOutputPeakDb(), 2)
+                << "," << juce::String(summary.getOutputRmsDb(), 2) << ","
+                << juce::String(summary.getCrestFactorDb(), 2) << "\n";
+    }
+
+    return {};
+}
+
+/** One row per envelope interval, one column per setting. */
+juce::String writeEnvelopes(const juce::File& file, const std::vector<DSP::ParameterSweep::Summary>& summaries,
+                            double intervalSeconds)
+{
+    file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(file.createOutputStream());
+
+    if (stream == nullptr)
+        return "cannot create " + file.getFullPathName();
+
+    *stream << "time";
+
+    for (size_t k = 0; k < summaries.size(); ++k)
+        *stream << ",set" << juce::String(static_cast<int>(k));
+
+    *stream << "\n";
+
+    size_t numIntervals = summaries.empty() ? 0 : summaries[0].envelopeDb.size();
+
+    for (size_t i = 0; i < numIntervals; ++i)
+    {
+        juce::String row(static_cast<double>(i) * intervalSeconds, 3);
+
+        for (const auto& summary : summaries)
+            row << "," << juce::String(summary.envelopeDb[i], 2);
+
+        *stream << row << "\n";
+    }
+
+    return {};
+}
+
+} // namespace
+
+//==============================================================================
+juce::String parseSweepAxis(const juce::String& spec, SweepAxis& axis)
+{
+    axis.id = spec.upToFirstOccurrenceOf("=", false, false).trim();
+    auto values = spec.fromFirstOccurrenceOf("=", false, false).trim();
+    axis.values.clear();
+
+    if (!spec.contains("=") || values.isEmpty())
+        return "invalid sweep '" + spec + "'";
+
+    if (std::find(std::begin(kSweepableIds), std::end(kSweepableIds), axis.id) == std::end(kSweepableIds))
+        return "cannot sweep '" + axis.id + "' (only threshold, ratio, kneeWidth, attackTime, releaseTime, holdTime)";
+
+    juce::StringArray parts;
+
+    if (values.contains(":"))
+    {
+        parts.addTokens(values, ":", "");
+
+        if (parts.size() != 3)
+            return "invalid sweep range '" + values + "' (expected <first>:<last>:<step>)";
+
+        double first = parts[0].getDoubleValue();
+        double last = parts[1].getDoubleValue();
+        double step = parts[2].getDoubleValue();
+
+        if (step == 0.0 || (last - first) / step < 0.0 || (last - first) / step >= kMaxAxisValues)
+            return "invalid sweep range '" + values + "'";
+
+        // The tolerance keeps the last value when the steps don't add up exactly in floating point
+        auto count = static_cast<size_t>(std::floor((last - first) / step + 1.0e-6)) + 1;
+
+        for (size_t k = 0; k < count; ++k)
+            axis.values.push_back(static_cast<float>(first + static_cast<double>(k) * step));
+    }
+    else
+    {
+        parts.addTokens(values, ",", "");
+
+        for (const auto& part : parts)
+            axis.values.push_back(part.trim().getFloatValue());
+    }
+
+    return {};
+}
+
+std::vector<DSP::CompressorSettings> getSweepSettings(const DSP::CompressorSettings& base,
+                                                      const std::vector<SweepAxis>& axes)
+{
+    std::vector<DSP::CompressorSettings> settings{ base };
+
+    // The first axis varies slowest
+    for (const auto& axis : axes)
+    {
+        std::vector<DSP::CompressorSettings> expanded;
+        expanded.reserve(settings.size() * axis.values.size());
+
+        for (const auto& setting : settings)
+        {
+            for (float value : axis.values)
+            {
+                expanded.push_back(setting);
+                setParameter(expanded.back(), axis.id, value);
+            }
+        }
+
+        settings = std::move(expanded);
+    }
+
+    return settings;
+}
+
+//==============================================================================
+RenderResult runSweep(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                      const std::vector<DSP::CompressorSettings>& settings, const SweepOptions& sweep,
+                      WorkStealingPool& pool)
+{
+    RenderResult result;
+    result.input = input;
+    result.output = getSibling(output, ".sweep.csv");
+
+    auto start = std::chrono::steady_clock::now();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr || reader->numChannels == 0)
+    {
+        result.error = "cannot read " + input.getFullPathName();
+        return result;
+    }
+
+    if (reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        result.error = input.getFileName() + " is too long to sweep in memory";
+        return result;
+    }
+
+    // Decode once; every group reads the same buffer
+    int numChannels = static_cast<int>(reader->numChannels);
+    int length = static_cast<int>(reader->lengthInSamples);
+    juce::AudioBuffer<float> audio(numChannels, length);
+    std::vector<float*> channels(static_cast<size_t>(numChannels));
+
+    for (int position = 0; position < length; position += kDecodeBlockSize)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[static_cast<size_t>(ch)] = audio.getWritePointer(ch, position);
+
+        if (!reader->read(channels.data(), numChannels, position, std::min(kDecodeBlockSize, length - position)))
+        {
+            result.error = "read failed at sample " + juce::String(position);
+            return result;
+        }
+    }
+
+    result.inputBytes = input.getSize();
+
+    // The shared settings and routing come from an engine set up as for a render
+    DSP::Compressor compressor;
+    prepareCompressor(compressor, *reader, options);
+
+    const size_t lanesPerGroup = DSP::ParameterSweep::kLanesPerGroup;
+    const auto envelopeInterval = static_cast<size_t>(std::max(0.0, sweep.envelopeMs * reader->sampleRate / 1000.0));
+    std::vector<DSP::ParameterSweep::Summary> summaries(settings.size());
+    std::mutex errorMutex;
+
+    for (size_t first = 0; first < settings.size(); first += lanesPerGroup)
+    {
+        pool.submit([&, first] {
+            size_t numLanes = std::min(lanesPerGroup, settings.size() - first);
+
+            DSP::ParameterSweep parameterSweep;
+            parameterSweep.prepare(compressor, reader->sampleRate, envelopeInterval);
+
+            // Audio of every lane, only when it is written
+            std::vector<juce::AudioBuffer<float>> outputs;
+            std::vector<float* const*> outputChannels;
+
+            if (sweep.writeAudio)
+            {
+                outputs.resize(numLanes);
+
+                for (auto& buffer : outputs)
+                {
+                    buffer.setSize(numChannels, length);
+                    outputChannels.push_back(buffer.getArrayOfWritePointers());
+                }
+            }
+
+            parameterSweep.process(audio.getArrayOfReadPointers(), static_cast<size_t>(length), &settings[first],
+                                   numLanes, &summaries[first], sweep.writeAudio ? outputChannels.data() : nullptr);
+
+            juce::AudioFormatManager writerFormats;
+            writerFormats.registerBasicFormats();
+
+            for (size_t lane = 0; lane < outputs.size(); ++lane)
+            {
+                juce::String error;
+                auto file = getSibling(output, "_set" + juce::String(static_cast<int>(first + lane))
+                                                   + output.getFileExtension());
+                auto writer = createWriter(writerFormats, file, *reader, options.bitsPerSample, error);
+
+                if (writer != nullptr && !writer->writeFromFloatArrays(outputs[lane].getArrayOfReadPointers(),
+                                                                       numChannels, length))
+                    error = "cannot write " + file.getFullPathName();
+
+                if (error.isNotEmpty())
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    result.error = error;
+                }
+            }
+        });
+    }
+
+    pool.wait();
+
+    if (result.succeeded())
+        result.error = writeSummary(result.output, settings, summaries);
+
+    if (result.succeeded() && envelopeInterval > 0)
+        result.error = writeEnvelopes(getSibling(output, ".envelopes.csv"), summaries,
+                                      static_cast<double>(envelopeInterval) / reader->sampleRate);
+
+    result.audioSeconds = static_cast<double>(length) / reader->sampleRate * static_cast<double>(settings.size());
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace Render
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "FileRenderer.h"
+#include "WorkStealingPool.h"
+#include "DSP/ParameterSweep.h"
+#include <vector>
+
+namespace Render
+{
+
+/** The values of one swept parameter. */
+struct SweepAxis
+{
+    juce::String id;
+    std::vector<float> values;
+};
+
+/** What a sweep varies and what it writes. */
+struct SweepOptions
+{
+    std::vector<SweepAxis> axes;
+    double envelopeMs = 10.0;  // Gain envelope interval, 0 for none
+    bool writeAudio = false;   // Also write the output of every setting
+};
+
+/** Parse "<id>=<first>:<last>:<step>" or "<id>=<value>,<value>,...". Only
+    the parameters that DSP::ParameterSweep varies per lane can be swept:
+    threshold, ratio, kneeWidth, attackTime, releaseTime and holdTime.
+    @return An error message, or an empty string on success
+*/
+juce::String parseSweepAxis(const juce::String& spec, SweepAxis& axis);
+
+/** Every combination of the axes' values applied to base, with each value
+    snapped as the plugin's parameter would snap it. */
+std::vector<DSP::CompressorSettings> getSweepSettings(const DSP::CompressorSettings& base,
+                                                      const std::vector<SweepAxis>& axes);
+
+/**
+    Render one file with many settings.
+
+    The file is decoded into memory once, then every group of
+    DSP::ParameterSweep::kLanesPerGroup settings runs as one pool task.
+    Next to output this writes <name>.sweep.csv, a summary row per setting
+    (largest gain reduction, output peak, RMS and crest factor), and
+    <name>.envelopes.csv, the gain envelope of every setting. With
+    writeAudio each setting's audio goes to <name>_set<k> in output's format.
+
+    The output matches renderFile() with the same settings, with the
+    latency removed whatever options.compensateLatency says. Bypass is
+    ignored. Waits for the pool, so it must not run on one of its tasks.
+
+    @return The result; audioSeconds counts the file once per setting
+*/
+RenderResult runSweep(const juce::File& input, const juce::File& output, const RenderOptions& options,
+                      const std::vector<DSP::CompressorSettings>& settings, const SweepOptions& sweep,
+                      WorkStealingPool& pool);
+
+} // namespace Render
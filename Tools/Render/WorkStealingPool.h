@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Render
+{
+
+/**
+    Fixed-size thread pool with one task deque per worker.
+
+    Tasks are dealt round-robin to the workers' deques. A worker runs its
+    own tasks oldest first and, once its deque is empty, steals the newest
+    task from another worker. Submitting the longest tasks first therefore
+    keeps every worker busy until the end of a batch of uneven jobs.
+*/
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /** @param numThreads Number of workers (at least one) */
+    explicit WorkStealingPool(size_t numThreads)
+    {
+        numThreads = numThreads > 0 ? numThreads : 1;
+
+        for (size_t i = 0; i < numThreads; ++i)
+            queues_.push_back(std::make_unique<Queue>());
+
+        for (size_t i = 0; i < numThreads; ++i)
+            threads_.emplace_back([this, i] { runWorker(i); });
+    }
+
+    /** Finishes the queued tasks, then joins the workers. */
+    ~WorkStealingPool()
+    {
+        wait();
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            stopping_ = true;
+        }
+
+        workAvailable_.notify_all();
+
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    //==============================================================================
+    /** Queue a task on the next worker's deque. */
+    void submit(Task task)
+    {
+        size_t index = nextQueue_++ % queues_.size();
+
+        // Counted before it is visible, so a worker that takes and finishes
+        // it straight away can't take the counters below zero
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            ++queued_;
+            ++unfinished_;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+
+        workAvailable_.notify_one();
+    }
+
+    /** Block until every submitted task has finished. */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        allDone_.wait(lock, [this] { return unfinished_ == 0; });
+    }
+
+    size_t getNumThreads() const { return threads_.size(); }
+
+    /** Tasks run by a worker other than the one they were dealt to. */
+    size_t getNumSteals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void runWorker(size_t index)
+    {
+        for (;;)
+        {
+            Task task;
+
+            if (takeTask(index, task))
+            {
+                task();
+
+                std::lock_guard<std::mutex> lock(stateMutex_);
+
+                if (--unfinished_ == 0)
+                    allDone_.notify_all();
+
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            workAvailable_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+
+            if (stopping_ && queued_ == 0)
+                return;
+        }
+    }
+
+    bool takeTask(size_t index, Task& task)
+    {
+        // Own deque first, oldest task first
+        if (popFrom(index, task, false))
+            return true;
+
+        // Then the newest task of the other workers
+        for (size_t k = 1; k < queues_.size(); ++k)
+        {
+            if (popFrom((index + k) % queues_.size(), task, true))
+            {
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool popFrom(size_t index, Task& task, bool newest)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            auto& tasks = queues_[index]->tasks;
+
+            if (tasks.empty())
+                return false;
+
+            if (newest)
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        --queued_;
+        return true;
+    }
+
+    //==============================================================================
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    size_t queued_ = 0;      // Tasks waiting in a deque
+    size_t unfinished_ = 0;  // Tasks submitted but not yet finished
+    bool stopping_ = false;
+
+    std::atomic<size_t> nextQueue_{ 0 };
+    std::atomic<size_t> steals_{ 0 };
+};
+
+} // namespace Render